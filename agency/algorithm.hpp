@@ -0,0 +1,14 @@
+/// \file
+/// \brief Include this file to use Agency's parallel algorithms.
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/algorithm/reduce.hpp>
+#include <agency/algorithm/transform_reduce.hpp>
+#include <agency/algorithm/inclusive_scan.hpp>
+#include <agency/algorithm/exclusive_scan.hpp>
+#include <agency/algorithm/for_each.hpp>
+#include <agency/algorithm/sort.hpp>
+
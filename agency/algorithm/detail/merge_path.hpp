@@ -0,0 +1,42 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <cstddef>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// returns the number of elements of a which precede the given diagonal of the stable merge of a and b
+// the remaining diagonal - result elements which precede the diagonal come from b
+//
+// the merge is stable, so an element of a precedes an equivalent element of b
+template<class Iterator1, class Iterator2, class Compare>
+std::size_t merge_path(Iterator1 a, std::size_t a_size, Iterator2 b, std::size_t b_size, std::size_t diagonal, Compare& comp)
+{
+  std::size_t lo = diagonal > b_size ? diagonal - b_size : 0;
+  std::size_t hi = diagonal < a_size ? diagonal : a_size;
+
+  while(lo < hi)
+  {
+    std::size_t mid = lo + (hi - lo) / 2;
+
+    if(!comp(b[diagonal - 1 - mid], a[mid]))
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+
+} // end detail
+} // end agency
+
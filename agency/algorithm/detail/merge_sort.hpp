@@ -0,0 +1,336 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/memory/allocator/detail/bulk_construct_n.hpp>
+#include <agency/algorithm/detail/partition.hpp>
+#include <agency/algorithm/detail/merge_path.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace agency
+{
+namespace detail
+{
+
+
+template<class Iterator, class Compare>
+void sort_range(std::false_type /* stable */, Iterator first, Iterator last, Compare& comp)
+{
+  std::sort(first, last, comp);
+}
+
+template<class Iterator, class Compare>
+void sort_range(std::true_type /* stable */, Iterator first, Iterator last, Compare& comp)
+{
+  std::stable_sort(first, last, comp);
+}
+
+
+// stores x to the position of result by move assignment
+template<class OutputIterator, class T>
+void move_to(std::false_type /* construct */, OutputIterator result, T& x)
+{
+  *result = std::move(x);
+}
+
+// stores x to the uninitialized position of result by move construction
+template<class Pointer, class T>
+void move_to(std::true_type /* construct */, Pointer result, T& x)
+{
+  using value_type = typename std::iterator_traits<Pointer>::value_type;
+
+  ::new(static_cast<void*>(result)) value_type(std::move(x));
+}
+
+
+// the storage through which merge_sort() ping-pongs
+// the elements of the buffer are constructed by the first pass over it, after which the buffer destroys them
+template<class T, class Executor>
+class sort_buffer
+{
+  public:
+    sort_buffer(Executor& exec, std::size_t n)
+      : exec_(exec),
+        alloc_(),
+        data_(alloc_.allocate(n)),
+        size_(n),
+        is_constructed_(false)
+    {}
+
+    ~sort_buffer()
+    {
+      // if an exception escaped the pass which constructs the elements, we don't know which of them to destroy,
+      // so they are abandoned
+      if(is_constructed_)
+      {
+        detail::bulk_destroy_n(exec_, alloc_, data_, size_);
+      }
+
+      alloc_.deallocate(data_, size_);
+    }
+
+    T* data() const
+    {
+      return data_;
+    }
+
+    bool is_constructed() const
+    {
+      return is_constructed_;
+    }
+
+    void set_constructed()
+    {
+      is_constructed_ = true;
+    }
+
+  private:
+    Executor& exec_;
+    std::allocator<T> alloc_;
+    T* data_;
+    std::size_t size_;
+    bool is_constructed_;
+};
+
+
+// sorts each of num_partitions partitions of a range
+// when Construct is true, each agent first moves its partition into the uninitialized buffer and sorts it there
+template<class Stable, class Construct, class Iterator, class Pointer, class Compare>
+struct sort_partition
+{
+  Iterator first;
+  Pointer buffer;
+  std::size_t n;
+  std::size_t num_partitions;
+  mutable Compare comp;
+
+  void sort(std::false_type /* construct */, std::size_t begin, std::size_t end) const
+  {
+    detail::sort_range(Stable(), first + begin, first + end, comp);
+  }
+
+  void sort(std::true_type /* construct */, std::size_t begin, std::size_t end) const
+  {
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      detail::move_to(Construct(), buffer + i, first[i]);
+    }
+
+    detail::sort_range(Stable(), buffer + begin, buffer + end, comp);
+  }
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    sort(Construct(), detail::partition_begin(i, n, num_partitions), detail::partition_begin(i + 1, n, num_partitions));
+  }
+};
+
+
+// when each run spans run_width partitions, the runs beginning at partitions 2 * k * run_width and (2 * k + 1) * run_width are merged together
+// a merge_pair describes the two runs which partition i's agent helps merge:
+// the runs are [begin, mid) & [mid, end), and partition i of the result lies within [begin, end)
+struct merge_pair
+{
+  std::size_t begin;
+  std::size_t mid;
+  std::size_t end;
+
+  merge_pair(std::size_t i, std::size_t n, std::size_t num_partitions, std::size_t run_width)
+  {
+    std::size_t first_partition = i / (2 * run_width) * (2 * run_width);
+
+    begin = detail::partition_begin(first_partition, n, num_partitions);
+    mid   = detail::partition_begin(std::min(first_partition + run_width, num_partitions), n, num_partitions);
+    end   = detail::partition_begin(std::min(first_partition + 2 * run_width, num_partitions), n, num_partitions);
+  }
+};
+
+
+// finds where partition i of the merged result begins in the first of the two runs merged into it
+template<class Iterator, class Compare>
+struct merge_path_partition
+{
+  Iterator source;
+  std::size_t n;
+  std::size_t num_partitions;
+  std::size_t run_width;
+  mutable Compare comp;
+
+  template<class Agent>
+  std::size_t operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    merge_pair pair(i, n, num_partitions, run_width);
+
+    std::size_t diagonal = detail::partition_begin(i, n, num_partitions) - pair.begin;
+
+    return detail::merge_path(source + pair.begin, pair.mid - pair.begin, source + pair.mid, pair.end - pair.mid, diagonal, comp);
+  }
+};
+
+
+// merges partition i of the result of merging pairs of runs of source into destination
+// splits[i] is the result of merge_path_partition for partition i
+//
+// the merge path of each partition is found by a separate launch before any agent moves from source
+// so that no agent reads an element which another agent has moved from
+template<class Construct, class Iterator1, class Iterator2, class Compare>
+struct merge_partition
+{
+  Iterator1 source;
+  Iterator2 destination;
+  std::size_t n;
+  std::size_t num_partitions;
+  std::size_t run_width;
+  const std::size_t* splits;
+  mutable Compare comp;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    merge_pair pair(i, n, num_partitions, run_width);
+
+    std::size_t begin = detail::partition_begin(i, n, num_partitions);
+    std::size_t end   = detail::partition_begin(i + 1, n, num_partitions);
+
+    // the range of the first run merged into this partition
+    std::size_t a_begin = pair.begin + splits[i];
+    std::size_t a_end   = end == pair.end ? pair.mid : pair.begin + splits[i + 1];
+
+    // the range of the second run merged into this partition
+    std::size_t b_begin = pair.mid + (begin - pair.begin) - splits[i];
+    std::size_t b_end   = b_begin + (end - begin) - (a_end - a_begin);
+
+    merge(source + a_begin, source + a_end, source + b_begin, source + b_end, destination + begin);
+  }
+
+  template<class OutputIterator>
+  void merge(Iterator1 a_first, Iterator1 a_last, Iterator1 b_first, Iterator1 b_last, OutputIterator result) const
+  {
+    while(a_first != a_last && b_first != b_last)
+    {
+      // prefer the element of the first run when the two are equivalent
+      if(comp(*b_first, *a_first))
+      {
+        detail::move_to(Construct(), result, *b_first);
+        ++b_first;
+      }
+      else
+      {
+        detail::move_to(Construct(), result, *a_first);
+        ++a_first;
+      }
+
+      ++result;
+    }
+
+    for(; a_first != a_last; ++a_first, ++result)
+    {
+      detail::move_to(Construct(), result, *a_first);
+    }
+
+    for(; b_first != b_last; ++b_first, ++result)
+    {
+      detail::move_to(Construct(), result, *b_first);
+    }
+  }
+};
+
+
+// merges each pair of adjacent runs of source into destination
+// every level of the merge employs every agent: each agent produces one partition of the result, wherever it falls among the pairs of runs
+template<class Construct, class ExecutionPolicy, class Iterator1, class Iterator2, class Compare>
+void merge_runs(ExecutionPolicy& policy, Iterator1 source, Iterator2 destination, std::size_t n, std::size_t num_partitions, std::size_t run_width, std::vector<std::size_t>& splits, Compare& comp)
+{
+  merge_path_partition<Iterator1,Compare> merge_path_partition_f{source, n, num_partitions, run_width, comp};
+  agency::bulk_invoke(agency::into(splits), policy(num_partitions), merge_path_partition_f);
+
+  merge_partition<Construct,Iterator1,Iterator2,Compare> merge_partition_f{source, destination, n, num_partitions, run_width, splits.data(), comp};
+  agency::bulk_invoke(policy(num_partitions), merge_partition_f);
+}
+
+
+// sorts n elements with a parallel merge sort:
+//   1. each agent sorts one partition of the range
+//   2. pairs of sorted runs are merged until a single run remains, ping-ponging between the range and a buffer
+//
+// the merges are partitioned along their merge paths, so each level of the merge is as parallel as the first
+// and no agent waits on a serial merge of the largest runs
+// the number of levels is known in advance, so the partitions are sorted wherever causes the final level to land in the range
+template<class Stable, class ExecutionPolicy, class Iterator, class Compare>
+void merge_sort(ExecutionPolicy& policy, Iterator first, std::size_t n, Compare comp)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+  using executor_type = typename std::decay<decltype(policy.executor())>::type;
+
+  std::size_t num_partitions = detail::num_partitions(policy, n);
+
+  if(num_partitions < 2)
+  {
+    // a single partition is sorted by the calling thread rather than by a launch
+    detail::sort_range(Stable(), first, first + n, comp);
+    return;
+  }
+
+  std::size_t num_levels = 0;
+  for(std::size_t run_width = 1; run_width < num_partitions; run_width *= 2)
+  {
+    ++num_levels;
+  }
+
+  sort_buffer<value_type,executor_type> buffer(policy.executor(), n);
+  std::vector<std::size_t> splits(num_partitions);
+
+  // when the number of levels is odd, the runs are sorted into the buffer so that the final level merges into the range
+  bool in_buffer = num_levels % 2 == 1;
+
+  if(in_buffer)
+  {
+    sort_partition<Stable,std::true_type,Iterator,value_type*,Compare> sort_partition_f{first, buffer.data(), n, num_partitions, comp};
+    agency::bulk_invoke(policy(num_partitions), sort_partition_f);
+    buffer.set_constructed();
+  }
+  else
+  {
+    sort_partition<Stable,std::false_type,Iterator,value_type*,Compare> sort_partition_f{first, buffer.data(), n, num_partitions, comp};
+    agency::bulk_invoke(policy(num_partitions), sort_partition_f);
+  }
+
+  for(std::size_t run_width = 1; run_width < num_partitions; run_width *= 2)
+  {
+    if(in_buffer)
+    {
+      detail::merge_runs<std::false_type>(policy, buffer.data(), first, n, num_partitions, run_width, splits, comp);
+    }
+    else if(buffer.is_constructed())
+    {
+      detail::merge_runs<std::false_type>(policy, first, buffer.data(), n, num_partitions, run_width, splits, comp);
+    }
+    else
+    {
+      // the first merge into the buffer constructs its elements
+      detail::merge_runs<std::true_type>(policy, first, buffer.data(), n, num_partitions, run_width, splits, comp);
+      buffer.set_constructed();
+    }
+
+    in_buffer = !in_buffer;
+  }
+}
+
+
+} // end detail
+} // end agency
+
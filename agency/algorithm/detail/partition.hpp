@@ -0,0 +1,46 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/shape.hpp>
+#include <agency/execution/executor/customization_points/unit_shape.hpp>
+#include <algorithm>
+#include <cstddef>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// partitions smaller than this are not worth the cost of an additional agent
+constexpr std::size_t min_partition_size = 4096;
+
+
+// returns the number of partitions into which an algorithm divides n elements when executed with policy
+// each point of the policy's executor's unit shape receives a partition, so long as no partition is smaller than min_partition_size
+template<class ExecutionPolicy>
+std::size_t num_partitions(const ExecutionPolicy& policy, std::size_t n)
+{
+  std::size_t num_units = detail::index_space_size(agency::unit_shape(policy.executor()));
+
+  std::size_t max_num_partitions = std::max<std::size_t>(1, n / min_partition_size);
+
+  return std::max<std::size_t>(1, std::min(num_units, max_num_partitions));
+}
+
+
+// returns the offset of the first element of partition i when n elements are divided into num_partitions nearly equal partitions
+// partition i spans [partition_begin(i, n, num_partitions), partition_begin(i + 1, n, num_partitions))
+__AGENCY_ANNOTATION
+inline std::size_t partition_begin(std::size_t i, std::size_t n, std::size_t num_partitions)
+{
+  // the first n % num_partitions partitions receive an extra element
+  std::size_t remainder = n % num_partitions;
+
+  return i * (n / num_partitions) + (i < remainder ? i : remainder);
+}
+
+
+} // end detail
+} // end agency
+
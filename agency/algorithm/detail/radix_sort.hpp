@@ -0,0 +1,251 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/algorithm/detail/partition.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// ranges smaller than this are sorted faster by comparison
+constexpr std::size_t min_radix_sort_size = std::size_t(1) << 16;
+
+
+// radix_key_type<T> is the unsigned integer type whose order, as computed by radix_key(), matches std::less<T>'s
+template<class T, class Enable = void>
+struct radix_key_type_impl {};
+
+template<class T>
+struct radix_key_type_impl<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T,bool>::value>::type>
+{
+  using type = typename std::make_unsigned<T>::type;
+};
+
+template<>
+struct radix_key_type_impl<float>
+{
+  using type = std::uint32_t;
+};
+
+template<>
+struct radix_key_type_impl<double>
+{
+  using type = std::uint64_t;
+};
+
+template<class T>
+using radix_key_type = typename radix_key_type_impl<T>::type;
+
+
+// a range is radix sorted when its elements are radix keys and it is sorted by std::less
+template<class T, class Compare, class Enable = void>
+struct is_radix_sortable : std::false_type {};
+
+template<class T>
+struct is_radix_sortable<T, std::less<T>, typename std::enable_if<(sizeof(radix_key_type<T>) > 0)>::type> : std::true_type {};
+
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, radix_key_type<T>>::type
+  radix_key(T x)
+{
+  return x;
+}
+
+// flipping the sign bit of a signed integer orders negative numbers before positive ones
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, radix_key_type<T>>::type
+  radix_key(T x)
+{
+  using key_type = radix_key_type<T>;
+
+  return static_cast<key_type>(x) ^ (key_type(1) << (8 * sizeof(key_type) - 1));
+}
+
+// negative floating point numbers have all of their bits flipped, so that larger magnitudes come first,
+// and positive numbers have their sign bit set, so that they follow the negative numbers
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value, radix_key_type<T>>::type
+  radix_key(T x)
+{
+  using key_type = radix_key_type<T>;
+
+  // -0 and +0 are equivalent, so they receive the same key
+  if(x == T(0)) x = T(0);
+
+  key_type bits;
+  std::memcpy(&bits, &x, sizeof(key_type));
+
+  key_type sign_bit = key_type(1) << (8 * sizeof(key_type) - 1);
+
+  return (bits & sign_bit) ? ~bits : (bits | sign_bit);
+}
+
+
+constexpr std::size_t radix_bits = 8;
+constexpr std::size_t radix = std::size_t(1) << radix_bits;
+
+
+template<class T>
+std::size_t radix_digit(const T& x, std::size_t shift)
+{
+  return static_cast<std::size_t>(detail::radix_key(x) >> shift) & (radix - 1);
+}
+
+
+// counts the occurrences of each digit in partition i of a range
+// counts[i * radix + d] receives the number of elements of the partition whose digit is d
+template<class Iterator>
+struct radix_histogram
+{
+  Iterator source;
+  std::size_t n;
+  std::size_t num_partitions;
+  std::size_t shift;
+  std::size_t* counts;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    std::size_t* partition_counts = counts + i * radix;
+    std::fill(partition_counts, partition_counts + radix, std::size_t(0));
+
+    std::size_t end = detail::partition_begin(i + 1, n, num_partitions);
+    for(std::size_t j = detail::partition_begin(i, n, num_partitions); j < end; ++j)
+    {
+      ++partition_counts[detail::radix_digit(source[j], shift)];
+    }
+  }
+};
+
+
+// moves each element of partition i of source to its position in destination
+// offsets[i * radix + d] is the position of the partition's first element whose digit is d
+// because each partition's elements are visited in order, the scatter is stable
+template<class Iterator1, class Iterator2>
+struct radix_scatter
+{
+  Iterator1 source;
+  Iterator2 destination;
+  std::size_t n;
+  std::size_t num_partitions;
+  std::size_t shift;
+  std::size_t* offsets;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    std::size_t* partition_offsets = offsets + i * radix;
+
+    std::size_t end = detail::partition_begin(i + 1, n, num_partitions);
+    for(std::size_t j = detail::partition_begin(i, n, num_partitions); j < end; ++j)
+    {
+      destination[partition_offsets[detail::radix_digit(source[j], shift)]++] = source[j];
+    }
+  }
+};
+
+
+template<class Iterator1, class Iterator2>
+struct copy_partition
+{
+  Iterator1 source;
+  Iterator2 destination;
+  std::size_t n;
+  std::size_t num_partitions;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    std::size_t begin = detail::partition_begin(i, n, num_partitions);
+    std::size_t end   = detail::partition_begin(i + 1, n, num_partitions);
+
+    std::copy(source + begin, source + end, destination + begin);
+  }
+};
+
+
+// sorts the digit of each element selected by shift from source into destination
+// returns false without touching destination when every element has the same digit, because the pass would not reorder them
+template<class ExecutionPolicy, class Iterator1, class Iterator2>
+bool radix_sort_pass(ExecutionPolicy& policy, Iterator1 source, Iterator2 destination, std::size_t n, std::size_t num_partitions, std::size_t shift, std::vector<std::size_t>& counts)
+{
+  radix_histogram<Iterator1> radix_histogram_f{source, n, num_partitions, shift, counts.data()};
+  agency::bulk_invoke(policy(num_partitions), radix_histogram_f);
+
+  // turn the counts into offsets, ordered first by digit and then by partition
+  std::size_t offset = 0;
+  for(std::size_t d = 0; d < radix; ++d)
+  {
+    std::size_t digit_begin = offset;
+
+    for(std::size_t i = 0; i < num_partitions; ++i)
+    {
+      std::size_t count = counts[i * radix + d];
+      counts[i * radix + d] = offset;
+      offset += count;
+    }
+
+    if(offset - digit_begin == n) return false;
+  }
+
+  radix_scatter<Iterator1,Iterator2> radix_scatter_f{source, destination, n, num_partitions, shift, counts.data()};
+  agency::bulk_invoke(policy(num_partitions), radix_scatter_f);
+
+  return true;
+}
+
+
+// sorts n arithmetic elements with a parallel least significant digit radix sort
+// each pass reorders the elements by one digit of their keys, ping-ponging between the range and a buffer,
+// and the passes whose digits are all equal are skipped, so narrow keys in wide types are sorted in few passes
+template<class ExecutionPolicy, class Iterator>
+void radix_sort(ExecutionPolicy& policy, Iterator first, std::size_t n)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  std::size_t num_partitions = detail::num_partitions(policy, n);
+
+  std::unique_ptr<value_type[]> buffer(new value_type[n]);
+  std::vector<std::size_t> counts(num_partitions * radix);
+
+  bool in_buffer = false;
+
+  for(std::size_t shift = 0; shift < 8 * sizeof(radix_key_type<value_type>); shift += radix_bits)
+  {
+    bool moved = in_buffer ?
+      detail::radix_sort_pass(policy, buffer.get(), first, n, num_partitions, shift, counts) :
+      detail::radix_sort_pass(policy, first, buffer.get(), n, num_partitions, shift, counts);
+
+    if(moved) in_buffer = !in_buffer;
+  }
+
+  if(in_buffer)
+  {
+    copy_partition<value_type*,Iterator> copy_partition_f{buffer.get(), first, n, num_partitions};
+    agency::bulk_invoke(policy(num_partitions), copy_partition_f);
+  }
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/algorithm/detail/partition.hpp>
+#include <agency/algorithm/transform_reduce.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// scans the elements [first + begin, first + end) into result, beginning with carry
+// an exclusive scan writes each element's prefix excluding the element itself, so it reads each element before writing its result,
+// which allows result to alias first
+template<class Iterator, class OutputIterator, class T, class BinaryOperation>
+void scan_range(std::true_type, Iterator first, std::size_t begin, std::size_t end, OutputIterator result, T carry, BinaryOperation& binary_op)
+{
+  for(std::size_t j = begin; j < end; ++j)
+  {
+    T element = first[j];
+    result[j] = carry;
+    carry = binary_op(carry, element);
+  }
+}
+
+template<class Iterator, class OutputIterator, class T, class BinaryOperation>
+void scan_range(std::false_type, Iterator first, std::size_t begin, std::size_t end, OutputIterator result, T carry, BinaryOperation& binary_op)
+{
+  for(std::size_t j = begin; j < end; ++j)
+  {
+    carry = binary_op(carry, first[j]);
+    result[j] = carry;
+  }
+}
+
+
+// scans one partition of a range, beginning with the carry into the partition
+template<class Exclusive, class Iterator, class OutputIterator, class T, class BinaryOperation, class Carries>
+struct scan_partition
+{
+  Iterator first;
+  OutputIterator result;
+  std::size_t n;
+  std::size_t num_partitions;
+  experimental::optional<T> init;
+  mutable BinaryOperation binary_op;
+
+  // (*carries)[i] is the carry into partition i + 1
+  Carries* carries;
+
+  void scan(std::size_t i) const
+  {
+    std::size_t begin = detail::partition_begin(i, n, num_partitions);
+    std::size_t end   = detail::partition_begin(i + 1, n, num_partitions);
+
+    if(i > 0)
+    {
+      detail::scan_range(Exclusive(), first, begin, end, result, static_cast<T>((*carries)[i - 1]), binary_op);
+    }
+    else if(init)
+    {
+      detail::scan_range(Exclusive(), first, begin, end, result, *init, binary_op);
+    }
+    else
+    {
+      // an inclusive scan without an initial value begins with its first element
+      T carry = first[begin];
+      result[begin] = carry;
+
+      detail::scan_range(Exclusive(), first, begin + 1, end, result, carry, binary_op);
+    }
+  }
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    scan(static_cast<std::size_t>(self.index()));
+  }
+};
+
+
+// scans n elements with a two-pass tiled scheme:
+//   1. each agent but the last reduces its partition of the input
+//   2. the calling thread scans the partitions' sums in order, yielding the carry into each partition
+//   3. each agent scans its partition, beginning with its carry
+//
+// the number of partitions is small, so the serial scan of the partitions' sums is insignificant
+// unlike a single-pass scheme with decoupled look-back, no agent waits on another, so this works with any execution policy
+template<class Exclusive, class ExecutionPolicy, class Iterator, class OutputIterator, class T, class BinaryOperation>
+OutputIterator tiled_scan(ExecutionPolicy& policy, Iterator first, std::size_t n, OutputIterator result, experimental::optional<T> init, BinaryOperation binary_op)
+{
+  if(n == 0) return result;
+
+  std::size_t num_partitions = detail::num_partitions(policy, n);
+
+  if(num_partitions == 1)
+  {
+    // a single partition is scanned by the calling thread rather than by a launch
+    scan_partition<Exclusive,Iterator,OutputIterator,T,BinaryOperation,T*> scan_partition_f{first, result, n, 1, init, binary_op, nullptr};
+    scan_partition_f.scan(0);
+
+    return result + n;
+  }
+
+  // reduce each partition but the last
+  reduce_partition<T,BinaryOperation,element_at<Iterator>> reduce_partition_f{n, num_partitions, binary_op, element_at<Iterator>{first}};
+  auto carries = agency::bulk_invoke(policy(num_partitions - 1), reduce_partition_f);
+
+  // scan the partitions' sums in place
+  if(init)
+  {
+    carries[0] = binary_op(*init, carries[0]);
+  }
+
+  for(std::size_t i = 1; i < num_partitions - 1; ++i)
+  {
+    carries[i] = binary_op(carries[i - 1], carries[i]);
+  }
+
+  // scan each partition
+  scan_partition<Exclusive,Iterator,OutputIterator,T,BinaryOperation,decltype(carries)> scan_partition_f{first, result, n, num_partitions, init, binary_op, &carries};
+  agency::bulk_invoke(policy(num_partitions), scan_partition_f);
+
+  return result + n;
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,55 @@
+/// \file
+/// \brief Include this file to use exclusive_scan().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/algorithm/detail/tiled_scan.hpp>
+#include <functional>
+#include <type_traits>
+
+namespace agency
+{
+
+
+/// \brief Computes the exclusive prefix sums of a range in parallel.
+///
+/// `exclusive_scan` writes to `*(result + i)` the generalized sum of `init` and the elements of `[first, first + i)` for each `i` in `[0, last - first)`.
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor. The scan makes two passes over the input:
+/// the first reduces each partition, and the second scans each partition beginning with the sum of the partitions preceding it.
+///
+/// \param policy The execution policy which creates the agents performing the scan. Its agents must have a one-dimensional index.
+/// \param first The beginning of the input range. `Iterator` must be a random access iterator.
+/// \param last The end of the input range.
+/// \param result The beginning of the output range. `OutputIterator` must be a random access iterator. `result` may be equal to `first`.
+/// \param init The initial value of the scan.
+/// \param binary_op The associative binary operation used to sum.
+/// \return The end of the output range.
+template<class ExecutionPolicy, class Iterator, class OutputIterator, class T, class BinaryOperation,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+OutputIterator exclusive_scan(ExecutionPolicy&& policy, Iterator first, Iterator last, OutputIterator result, T init, BinaryOperation binary_op)
+{
+  return detail::tiled_scan<std::true_type>(policy, first, last - first, result, experimental::optional<T>(init), binary_op);
+}
+
+
+/// \brief Computes the exclusive prefix sums of a range in parallel.
+///
+/// This overload of `exclusive_scan` is equivalent to `exclusive_scan(policy, first, last, result, init, std::plus<T>())`.
+template<class ExecutionPolicy, class Iterator, class OutputIterator, class T,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+OutputIterator exclusive_scan(ExecutionPolicy&& policy, Iterator first, Iterator last, OutputIterator result, T init)
+{
+  return agency::exclusive_scan(policy, first, last, result, init, std::plus<T>());
+}
+
+
+} // end agency
+
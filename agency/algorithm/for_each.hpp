@@ -0,0 +1,175 @@
+/// \file
+/// \brief Include this file to use for_each().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/algorithm/detail/partition.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace agency
+{
+namespace detail
+{
+
+
+template<class Iterator>
+using segment_index_member_t = decltype(std::declval<Iterator>().segment_index());
+
+// a segmented iterator, such as flatten_view's, knows the segment & position within the segment of the element it points to
+// through its segment_index() & segment_position() members, and its view() member provides the segments themselves
+template<class Iterator>
+using is_segmented_iterator = is_detected<segment_index_member_t, Iterator>;
+
+
+// applies f to each element of partition i of a range
+template<class Iterator, class Function>
+struct for_each_partition
+{
+  Iterator first;
+  std::size_t n;
+  std::size_t num_partitions;
+  mutable Function f;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    std::size_t begin = detail::partition_begin(i, n, num_partitions);
+    std::size_t end   = detail::partition_begin(i + 1, n, num_partitions);
+
+    Iterator iter = first + begin;
+    for(std::size_t j = begin; j < end; ++j, ++iter)
+    {
+      f(*iter);
+    }
+  }
+};
+
+
+// applies f to each element of the segments of partition i of the segments spanned by [first, last)
+// each agent receives whole segments, and traverses each segment directly rather than through the segmented iterator
+template<class SegmentedIterator, class Function>
+struct for_each_segment_partition
+{
+  SegmentedIterator first;
+  SegmentedIterator last;
+  std::size_t num_segments;
+  std::size_t num_partitions;
+  mutable Function f;
+
+  void for_each_segment(std::size_t segment_idx) const
+  {
+    auto segment = first.view().segment(segment_idx);
+
+    // the first & last segments may be partially covered by [first, last)
+    std::size_t begin = segment_idx == first.segment_index() ? first.segment_position() : 0;
+    std::size_t end   = segment_idx == last.segment_index()  ? last.segment_position()  : segment.size();
+
+    for(std::size_t j = begin; j < end; ++j)
+    {
+      f(segment[j]);
+    }
+  }
+
+  void for_each_segment(std::size_t begin, std::size_t end) const
+  {
+    for(std::size_t segment_idx = first.segment_index() + begin; segment_idx < first.segment_index() + end; ++segment_idx)
+    {
+      for_each_segment(segment_idx);
+    }
+  }
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    for_each_segment(detail::partition_begin(i, num_segments, num_partitions), detail::partition_begin(i + 1, num_segments, num_partitions));
+  }
+};
+
+
+template<class ExecutionPolicy, class Iterator, class Function>
+void for_each(std::false_type /* segmented */, ExecutionPolicy& policy, Iterator first, Iterator last, Function f)
+{
+  std::size_t n = last - first;
+  if(n == 0) return;
+
+  std::size_t num_partitions = detail::num_partitions(policy, n);
+
+  if(num_partitions == 1)
+  {
+    // a single partition is traversed by the calling thread rather than by a launch
+    for(; first != last; ++first)
+    {
+      f(*first);
+    }
+
+    return;
+  }
+
+  for_each_partition<Iterator,Function> for_each_partition_f{first, n, num_partitions, f};
+  agency::bulk_invoke(policy(num_partitions), for_each_partition_f);
+}
+
+
+template<class ExecutionPolicy, class SegmentedIterator, class Function>
+void for_each(std::true_type /* segmented */, ExecutionPolicy& policy, SegmentedIterator first, SegmentedIterator last, Function f)
+{
+  std::size_t n = last - first;
+  if(n == 0) return;
+
+  // last's segment is spanned only when last points into the middle of it
+  std::size_t num_segments = last.segment_index() - first.segment_index() + (last.segment_position() > 0 ? 1 : 0);
+
+  std::size_t num_partitions = std::min(detail::num_partitions(policy, n), num_segments);
+
+  for_each_segment_partition<SegmentedIterator,Function> for_each_segment_partition_f{first, last, num_segments, num_partitions, f};
+
+  if(num_partitions == 1)
+  {
+    // a single partition is traversed by the calling thread rather than by a launch
+    for_each_segment_partition_f.for_each_segment(0, num_segments);
+    return;
+  }
+
+  agency::bulk_invoke(policy(num_partitions), for_each_segment_partition_f);
+}
+
+
+} // end detail
+
+
+/// \brief Applies a function to each element of a range in parallel.
+///
+/// `for_each` applies `f` to each element of `[first, last)`. The order in which the elements are visited is unspecified.
+///
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor, and each partition is traversed by a separate execution agent.
+/// When `Iterator` is a segmented iterator, such as an iterator of `experimental::flatten_view` or `experimental::segmented_array`,
+/// each agent instead receives whole contiguous segments, which it traverses directly.
+///
+/// \param policy The execution policy which creates the agents performing the traversal. Its agents must have a one-dimensional index.
+/// \param first The beginning of the range. `Iterator` must be a random access iterator.
+/// \param last The end of the range.
+/// \param f The function to apply to each element.
+template<class ExecutionPolicy, class Iterator, class Function,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+void for_each(ExecutionPolicy&& policy, Iterator first, Iterator last, Function f)
+{
+  detail::for_each(detail::is_segmented_iterator<Iterator>(), policy, first, last, f);
+}
+
+
+} // end agency
+
@@ -0,0 +1,72 @@
+/// \file
+/// \brief Include this file to use inclusive_scan().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/algorithm/detail/tiled_scan.hpp>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+namespace agency
+{
+
+
+/// \brief Computes the inclusive prefix sums of a range in parallel.
+///
+/// `inclusive_scan` writes to `*(result + i)` the generalized sum of `init` and the elements of `[first, first + i]` for each `i` in `[0, last - first)`.
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor. The scan makes two passes over the input:
+/// the first reduces each partition, and the second scans each partition beginning with the sum of the partitions preceding it.
+///
+/// \param policy The execution policy which creates the agents performing the scan. Its agents must have a one-dimensional index.
+/// \param first The beginning of the input range. `Iterator` must be a random access iterator.
+/// \param last The end of the input range.
+/// \param result The beginning of the output range. `OutputIterator` must be a random access iterator. `result` may be equal to `first`.
+/// \param binary_op The associative binary operation used to sum.
+/// \param init The initial value of the scan.
+/// \return The end of the output range.
+template<class ExecutionPolicy, class Iterator, class OutputIterator, class BinaryOperation, class T,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+OutputIterator inclusive_scan(ExecutionPolicy&& policy, Iterator first, Iterator last, OutputIterator result, BinaryOperation binary_op, T init)
+{
+  return detail::tiled_scan<std::false_type>(policy, first, last - first, result, experimental::optional<T>(init), binary_op);
+}
+
+
+/// \brief Computes the inclusive prefix sums of a range in parallel.
+///
+/// This overload of `inclusive_scan` sums without an initial value, so `*result` is `*first`.
+template<class ExecutionPolicy, class Iterator, class OutputIterator, class BinaryOperation,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+OutputIterator inclusive_scan(ExecutionPolicy&& policy, Iterator first, Iterator last, OutputIterator result, BinaryOperation binary_op)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  return detail::tiled_scan<std::false_type>(policy, first, last - first, result, experimental::optional<value_type>(), binary_op);
+}
+
+
+/// \brief Computes the inclusive prefix sums of a range in parallel.
+///
+/// This overload of `inclusive_scan` is equivalent to `inclusive_scan(policy, first, last, result, std::plus<T>())`, where `T` is the value type of `Iterator`.
+template<class ExecutionPolicy, class Iterator, class OutputIterator,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+OutputIterator inclusive_scan(ExecutionPolicy&& policy, Iterator first, Iterator last, OutputIterator result)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  return agency::inclusive_scan(policy, first, last, result, std::plus<value_type>());
+}
+
+
+} // end agency
+
@@ -0,0 +1,68 @@
+/// \file
+/// \brief Include this file to use reduce().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/algorithm/transform_reduce.hpp>
+#include <functional>
+#include <iterator>
+
+namespace agency
+{
+
+
+/// \brief Reduces the elements of a range in parallel.
+///
+/// `reduce` reduces the elements of `[first, last)`, along with `init`, using `binary_op`.
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor, and each partition is reduced by a separate execution agent.
+/// Partitions are combined in order, so `binary_op` must be associative but need not be commutative.
+///
+/// \param policy The execution policy which creates the agents performing the reduction. Its agents must have a one-dimensional index.
+/// \param first The beginning of the input range. `Iterator` must be a random access iterator.
+/// \param last The end of the input range.
+/// \param init The initial value of the reduction.
+/// \param binary_op The associative binary operation used to reduce.
+/// \return The generalized sum of `init` and the elements of `[first, last)`.
+template<class ExecutionPolicy, class Iterator, class T, class BinaryOperation,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+T reduce(ExecutionPolicy&& policy, Iterator first, Iterator last, T init, BinaryOperation binary_op)
+{
+  return detail::reduce_n(policy, last - first, init, binary_op, detail::element_at<Iterator>{first});
+}
+
+
+/// \brief Sums the elements of a range in parallel.
+///
+/// This overload of `reduce` is equivalent to `reduce(policy, first, last, init, std::plus<T>())`.
+template<class ExecutionPolicy, class Iterator, class T,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+T reduce(ExecutionPolicy&& policy, Iterator first, Iterator last, T init)
+{
+  return agency::reduce(policy, first, last, init, std::plus<T>());
+}
+
+
+/// \brief Sums the elements of a range in parallel.
+///
+/// This overload of `reduce` is equivalent to `reduce(policy, first, last, T())`, where `T` is the value type of `Iterator`.
+template<class ExecutionPolicy, class Iterator,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+typename std::iterator_traits<Iterator>::value_type
+  reduce(ExecutionPolicy&& policy, Iterator first, Iterator last)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  return agency::reduce(policy, first, last, value_type());
+}
+
+
+} // end agency
+
@@ -0,0 +1,126 @@
+/// \file
+/// \brief Include this file to use sort() and stable_sort().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/algorithm/detail/merge_sort.hpp>
+#include <agency/algorithm/detail/radix_sort.hpp>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+namespace agency
+{
+namespace detail
+{
+
+
+template<class Stable, class ExecutionPolicy, class Iterator, class Compare>
+void sort(std::false_type /* radix sortable */, ExecutionPolicy& policy, Iterator first, std::size_t n, Compare comp)
+{
+  detail::merge_sort<Stable>(policy, first, n, comp);
+}
+
+
+// the radix sort is stable, so it serves both sort() & stable_sort()
+template<class Stable, class ExecutionPolicy, class Iterator, class Compare>
+void sort(std::true_type /* radix sortable */, ExecutionPolicy& policy, Iterator first, std::size_t n, Compare comp)
+{
+  if(n < min_radix_sort_size)
+  {
+    detail::merge_sort<Stable>(policy, first, n, comp);
+  }
+  else
+  {
+    detail::radix_sort(policy, first, n);
+  }
+}
+
+
+template<class Stable, class ExecutionPolicy, class Iterator, class Compare>
+void sort(ExecutionPolicy& policy, Iterator first, Iterator last, Compare comp)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  detail::sort<Stable>(is_radix_sortable<value_type,Compare>(), policy, first, last - first, comp);
+}
+
+
+} // end detail
+
+
+/// \brief Sorts a range in parallel.
+///
+/// `sort` sorts the elements of `[first, last)` into the order given by `comp`. The order of equivalent elements is unspecified.
+///
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor, and each partition is sorted by a separate execution agent.
+/// The sorted partitions are then merged in pairs until one remains. Each merge is divided among all of the agents along its merge path,
+/// so the final merges are as parallel as the first. The merges alternate between the range and a temporary buffer of `last - first` elements.
+///
+/// Ranges of integers, `float`s, or `double`s sorted by `std::less` are sorted with a radix sort instead.
+///
+/// \param policy The execution policy which creates the agents performing the sort. Its agents must have a one-dimensional index.
+/// \param first The beginning of the range to sort. `Iterator` must be a random access iterator.
+/// \param last The end of the range to sort.
+/// \param comp The strict weak ordering by which to sort.
+template<class ExecutionPolicy, class Iterator, class Compare,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+void sort(ExecutionPolicy&& policy, Iterator first, Iterator last, Compare comp)
+{
+  detail::sort<std::false_type>(policy, first, last, comp);
+}
+
+
+/// \brief Sorts a range in parallel.
+///
+/// This overload of `sort` is equivalent to `sort(policy, first, last, std::less<T>())`, where `T` is the value type of `Iterator`.
+template<class ExecutionPolicy, class Iterator,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+void sort(ExecutionPolicy&& policy, Iterator first, Iterator last)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  agency::sort(policy, first, last, std::less<value_type>());
+}
+
+
+/// \brief Sorts a range in parallel, preserving the order of equivalent elements.
+///
+/// `stable_sort` is like `sort`, but equivalent elements retain their relative order.
+///
+/// \param policy The execution policy which creates the agents performing the sort. Its agents must have a one-dimensional index.
+/// \param first The beginning of the range to sort. `Iterator` must be a random access iterator.
+/// \param last The end of the range to sort.
+/// \param comp The strict weak ordering by which to sort.
+template<class ExecutionPolicy, class Iterator, class Compare,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+void stable_sort(ExecutionPolicy&& policy, Iterator first, Iterator last, Compare comp)
+{
+  detail::sort<std::true_type>(policy, first, last, comp);
+}
+
+
+/// \brief Sorts a range in parallel, preserving the order of equivalent elements.
+///
+/// This overload of `stable_sort` is equivalent to `stable_sort(policy, first, last, std::less<T>())`, where `T` is the value type of `Iterator`.
+template<class ExecutionPolicy, class Iterator,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+void stable_sort(ExecutionPolicy&& policy, Iterator first, Iterator last)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  agency::stable_sort(policy, first, last, std::less<value_type>());
+}
+
+
+} // end agency
+
@@ -0,0 +1,177 @@
+/// \file
+/// \brief Include this file to use transform_reduce().
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/execution/execution_policy.hpp>
+#include <agency/algorithm/detail/partition.hpp>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// returns the element at a given offset of a range
+template<class Iterator>
+struct element_at
+{
+  Iterator first;
+
+  typename std::iterator_traits<Iterator>::reference operator()(std::size_t i) const
+  {
+    return first[i];
+  }
+};
+
+
+// returns the result of a unary operation applied to the element at a given offset of a range
+template<class Iterator, class UnaryOperation>
+struct unary_transform_at
+{
+  Iterator first;
+  mutable UnaryOperation transform_op;
+
+  result_of_t<UnaryOperation&(typename std::iterator_traits<Iterator>::reference)>
+    operator()(std::size_t i) const
+  {
+    return transform_op(first[i]);
+  }
+};
+
+
+// returns the result of a binary operation applied to the elements at a given offset of two ranges
+template<class Iterator1, class Iterator2, class BinaryOperation>
+struct binary_transform_at
+{
+  Iterator1 first1;
+  Iterator2 first2;
+  mutable BinaryOperation transform_op;
+
+  result_of_t<BinaryOperation&(typename std::iterator_traits<Iterator1>::reference, typename std::iterator_traits<Iterator2>::reference)>
+    operator()(std::size_t i) const
+  {
+    return transform_op(first1[i], first2[i]);
+  }
+};
+
+
+// reduces one partition of n elements, each of which is given by element(i)
+template<class T, class BinaryOperation, class ElementFunction>
+struct reduce_partition
+{
+  std::size_t n;
+  std::size_t num_partitions;
+  mutable BinaryOperation reduce_op;
+  ElementFunction element;
+
+  T reduce(std::size_t first, std::size_t last) const
+  {
+    T result = element(first);
+
+    for(++first; first < last; ++first)
+    {
+      result = reduce_op(result, element(first));
+    }
+
+    return result;
+  }
+
+  template<class Agent>
+  T operator()(Agent& self) const
+  {
+    std::size_t i = static_cast<std::size_t>(self.index());
+
+    return reduce(detail::partition_begin(i, n, num_partitions), detail::partition_begin(i + 1, n, num_partitions));
+  }
+};
+
+
+// reduces the n elements given by element(i) into init
+// each of the policy's partitions is reduced by a separate agent, and the partitions' sums are combined in order,
+// so reduce_op need not be commutative
+template<class ExecutionPolicy, class T, class BinaryOperation, class ElementFunction>
+T reduce_n(ExecutionPolicy& policy, std::size_t n, T init, BinaryOperation reduce_op, ElementFunction element)
+{
+  if(n == 0) return init;
+
+  std::size_t num_partitions = detail::num_partitions(policy, n);
+
+  reduce_partition<T,BinaryOperation,ElementFunction> reduce_partition_f{n, num_partitions, reduce_op, element};
+
+  if(num_partitions == 1)
+  {
+    // a single partition is reduced by the calling thread rather than by a launch
+    return reduce_op(init, reduce_partition_f.reduce(0, n));
+  }
+
+  auto partial_sums = agency::bulk_invoke(policy(num_partitions), reduce_partition_f);
+
+  for(std::size_t i = 0; i < num_partitions; ++i)
+  {
+    init = reduce_op(init, partial_sums[i]);
+  }
+
+  return init;
+}
+
+
+} // end detail
+
+
+/// \brief Reduces the transformed elements of a range in parallel.
+///
+/// `transform_reduce` applies `transform_op` to each element of `[first, last)` and reduces the results, along with `init`, using `reduce_op`.
+/// The range is divided into one partition for each point of the unit shape of `policy`'s executor, and each partition is reduced by a separate execution agent.
+/// Partitions are combined in order, so `reduce_op` must be associative but need not be commutative.
+///
+/// \param policy The execution policy which creates the agents performing the reduction. Its agents must have a one-dimensional index.
+/// \param first The beginning of the input range. `Iterator` must be a random access iterator.
+/// \param last The end of the input range.
+/// \param init The initial value of the reduction.
+/// \param reduce_op The associative binary operation used to reduce.
+/// \param transform_op The unary operation applied to each element of the input.
+/// \return The generalized sum of `init` and `transform_op(*i)` for each `i` in `[first, last)`.
+template<class ExecutionPolicy, class Iterator, class T, class BinaryOperation, class UnaryOperation,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+T transform_reduce(ExecutionPolicy&& policy, Iterator first, Iterator last, T init, BinaryOperation reduce_op, UnaryOperation transform_op)
+{
+  return detail::reduce_n(policy, last - first, init, reduce_op, detail::unary_transform_at<Iterator,UnaryOperation>{first, transform_op});
+}
+
+
+/// \brief Reduces the results of a binary operation applied to the corresponding elements of two ranges in parallel.
+///
+/// This overload of `transform_reduce` reduces `transform_op(*(first1 + i), *(first2 + i))` for each `i` in `[0, last1 - first1)`.
+template<class ExecutionPolicy, class Iterator1, class Iterator2, class T, class BinaryOperation1, class BinaryOperation2,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+T transform_reduce(ExecutionPolicy&& policy, Iterator1 first1, Iterator1 last1, Iterator2 first2, T init, BinaryOperation1 reduce_op, BinaryOperation2 transform_op)
+{
+  return detail::reduce_n(policy, last1 - first1, init, reduce_op, detail::binary_transform_at<Iterator1,Iterator2,BinaryOperation2>{first1, first2, transform_op});
+}
+
+
+/// \brief Computes the inner product of two ranges in parallel.
+///
+/// This overload of `transform_reduce` is equivalent to `transform_reduce(policy, first1, last1, first2, init, std::plus<>(), std::multiplies<>())`.
+template<class ExecutionPolicy, class Iterator1, class Iterator2, class T,
+         __AGENCY_REQUIRES(is_execution_policy<detail::decay_t<ExecutionPolicy>>::value)
+        >
+T transform_reduce(ExecutionPolicy&& policy, Iterator1 first1, Iterator1 last1, Iterator2 first2, T init)
+{
+  return agency::transform_reduce(policy, first1, last1, first2, init, std::plus<T>(), std::multiplies<T>());
+}
+
+
+} // end agency
+
@@ -6,6 +6,7 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/control_structures/bulk_invoke_execution_policy.hpp>
+#include <agency/detail/control_structures/result_destination.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <agency/detail/integer_sequence.hpp>
 #include <agency/detail/control_structures/is_bulk_call_possible_via_execution_policy.hpp>
@@ -38,6 +39,32 @@ struct enable_if_bulk_invoke_execution_policy
 {};
 
 
+template<bool enable, class Container, class ExecutionPolicy, class Function, class... Args>
+struct enable_if_bulk_invoke_into_execution_policy_impl {};
+
+// bulk_invoke() into a result_destination requires f to return a result which is not a scope_result
+template<class Container, class ExecutionPolicy, class Function, class... Args>
+struct enable_if_bulk_invoke_into_execution_policy_impl<true, Container, ExecutionPolicy, Function, Args...>
+  : std::enable_if<
+      !std::is_void<typename bulk_invoke_execution_policy_result<ExecutionPolicy,Function,Args...>::user_function_result>::value &&
+      !is_scope_result<typename bulk_invoke_execution_policy_result<ExecutionPolicy,Function,Args...>::user_function_result>::value,
+      Container&
+    >
+{};
+
+
+template<class Container, class ExecutionPolicy, class Function, class... Args>
+struct enable_if_bulk_invoke_into_execution_policy
+  : enable_if_bulk_invoke_into_execution_policy_impl<
+      is_bulk_call_possible_via_execution_policy<decay_t<ExecutionPolicy>,Function,Args...>::value,
+      Container,
+      decay_t<ExecutionPolicy>,
+      Function,
+      Args...
+    >
+{};
+
+
 } // end detail
 
 ///
@@ -143,7 +170,51 @@ see_below
   using agent_traits = execution_agent_traits<typename std::decay<ExecutionPolicy>::type::execution_agent_type>;
   const size_t num_shared_params = detail::execution_depth<typename agent_traits::execution_category>::value;
 
-  return detail::bulk_invoke_execution_policy(detail::index_sequence_for<Args...>(), detail::make_index_sequence<num_shared_params>(), policy, f, std::forward<Args>(args)...);
+  return detail::bulk_invoke_execution_policy(detail::index_sequence_for<Args...>(), detail::make_index_sequence<num_shared_params>(), detail::return_results(), policy, f, std::forward<Args>(args)...);
+}
+
+
+/// \brief Creates a bulk synchronous invocation whose results are written into an existing container.
+/// \ingroup control_structures
+///
+///
+/// This overload of `bulk_invoke` behaves like the one above, except that rather than collecting the results of `f`
+/// into a new container, the result of invocation i is assigned to `results[idx_i]`.
+/// No container of results is allocated or constructed, so this overload is useful when `bulk_invoke` is called repeatedly
+/// with the same shape and the results of each call replace those of the previous call.
+///
+/// The following example assigns the squares of each agent's index to the elements of an existing `std::vector`:
+///
+/// ~~~~{.cpp}
+/// std::vector<int> results(n);
+///
+/// agency::bulk_invoke(agency::into(results), agency::par(n), [](agency::parallel_agent& self)
+/// {
+///   return self.index() * self.index();
+/// });
+/// ~~~~
+///
+/// \param results The object returned by `agency::into(c)`, which indicates the container `c` into which results are written.
+/// \param policy An execution policy describing the requirements of the execution agents created by this call to `bulk_invoke`.
+/// \param f      A function defining the work to be performed by execution agents. `f` may not return `void` or a `scope_result`.
+/// \param args   Additional arguments to pass to `f` when it is invoked.
+/// \return A reference to the container `c` of `f`'s results.
+///
+/// \see into
+template<class Container, class ExecutionPolicy, class Function, class... Args>
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+typename detail::enable_if_bulk_invoke_into_execution_policy<
+  Container, ExecutionPolicy, Function, Args...
+>::type
+#else
+see_below
+#endif
+  bulk_invoke(detail::result_destination<Container> results, ExecutionPolicy&& policy, Function f, Args&&... args)
+{
+  using agent_traits = execution_agent_traits<typename std::decay<ExecutionPolicy>::type::execution_agent_type>;
+  const size_t num_shared_params = detail::execution_depth<typename agent_traits::execution_category>::value;
+
+  return detail::bulk_invoke_execution_policy(detail::index_sequence_for<Args...>(), detail::make_index_sequence<num_shared_params>(), results, policy, f, std::forward<Args>(args)...);
 }
 
 
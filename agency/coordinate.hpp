@@ -240,7 +240,7 @@ struct index_size<T, typename std::enable_if<std::is_integral<T>::value>::type>
 };
 
 
-template<class T> class grid_iterator;
+template<class T> class lattice_iterator;
 
 
 template<typename Array, typename T>
@@ -275,7 +275,7 @@ class lattice
     using value_type             = T;
     using reference              = value_type;
     using const_reference        = reference;
-    using const_iterator         = detail::grid_iterator<T>;
+    using const_iterator         = detail::lattice_iterator<T>;
     using iterator               = const_iterator;
 
     // returns the value of the smallest lattice point
@@ -419,13 +419,13 @@ class lattice
     __AGENCY_ANNOTATION
     const_iterator begin() const
     {
-      return detail::grid_iterator<value_type>(*this);
+      return detail::lattice_iterator<value_type>(*this);
     }
 
     __AGENCY_ANNOTATION
     const_iterator end() const
     {
-      return detail::grid_iterator<value_type>(*this, detail::grid_iterator<value_type>::past_the_end(*this));
+      return detail::lattice_iterator<value_type>(*this, detail::lattice_iterator<value_type>::past_the_end(*this));
     }
 
   private:
@@ -503,6 +503,12 @@ class lattice_iterator
       return current_;
     }
 
+    __AGENCY_ANNOTATION
+    reference operator[](difference_type n) const
+    {
+      return *(*this + n);
+    }
+
     __AGENCY_ANNOTATION
     lattice_iterator& operator++()
     {
@@ -672,17 +678,33 @@ class lattice_iterator
     }
 
     // point-like case
+    // n is added to the lowest dimension and carried into the higher dimensions like the digits of a sum,
+    // so an advance which stays within the lowest dimension, the common case, performs no division
     __AGENCY_ANNOTATION
     lattice_iterator& advance(difference_type n, std::false_type)
     {
-      difference_type idx = linearize() + n;
-
-      auto s = stride();
+      T min = domain_.min();
+      auto shape = domain_.shape();
 
-      for(size_t i = 0; i < rank; ++i)
+      for(int i = rank; i-- > 0 && n != 0;)
       {
-        current_[i] = domain_.min()[i] + idx / s[i];
-        idx %= s[i];
+        difference_type offset = static_cast<difference_type>(current_[i] - min[i]) + n;
+        difference_type extent = static_cast<difference_type>(shape[i]);
+
+        if(i == 0 || (0 <= offset && offset < extent))
+        {
+          // the highest dimension doesn't roll over, so that advancing to the end yields past_the_end()
+          current_[i] = min[i] + offset;
+          n = 0;
+        }
+        else
+        {
+          // carry the quotient, rounded toward negative infinity, into the next higher dimension
+          difference_type carry = offset >= 0 ? offset / extent : -((extent - 1 - offset) / extent);
+
+          current_[i] = min[i] + (offset - carry * extent);
+          n = carry;
+        }
       }
 
       return *this;
@@ -696,21 +718,6 @@ class lattice_iterator
       return *this;
     }
 
-    __AGENCY_ANNOTATION
-    point<difference_type,rank> stride() const
-    {
-      point<difference_type,rank> result;
-      result[rank - 1] = 1;
-
-      for(int i = rank - 1; i-- > 0;)
-      {
-        // accumulate the stride of the lower dimension
-        result[i] = result[i+1] * domain_.shape()[i];
-      }
-
-      return result;
-    }
-
     __AGENCY_ANNOTATION
     difference_type linearize() const
     {
@@ -7,6 +7,10 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <cstdint>
 
 namespace agency
 {
@@ -120,6 +124,171 @@ protected:
 };
 
 
+// dissemination_barrier synchronizes participants in ceil(log2(num_threads)) rounds
+//
+// in round k, participant i signals participant (i + 2^k) % num_threads and waits for a signal
+// from participant (i - 2^k) % num_threads, so no location is written by more than one participant per round
+// each participant's flags occupy their own cache lines
+//
+// a participant waiting for a signal first spins, then yields, and finally parks on its own condition variable
+//
+// unlike the other barriers, arrive_and_wait() requires the caller's rank in [0, num_threads)
+// each rank must be used by exactly one participant
+class dissemination_barrier
+{
+  private:
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t max_num_rounds = 32;
+    static constexpr size_t num_spins = 64;
+    static constexpr size_t num_yields = 64;
+
+    struct participant
+    {
+      // flags[k] holds the last phase in which this participant was signaled during round k
+      std::atomic<size_t>     flags[max_num_rounds];
+
+      // the number of phases this participant has completed
+      // only accessed by the participant itself
+      size_t                  phase;
+
+      std::atomic<bool>       is_parked;
+      std::mutex              mutex;
+      std::condition_variable wake_up;
+
+      participant()
+        : phase(0),
+          is_parked(false)
+      {
+        for(auto& flag : flags)
+        {
+          flag.store(0, std::memory_order_relaxed);
+        }
+      }
+    };
+
+    // pad participants to a whole number of cache lines
+    static constexpr size_t participant_stride = (sizeof(participant) + cache_line_size - 1) / cache_line_size * cache_line_size;
+
+  public:
+    inline explicit dissemination_barrier(size_t num_threads)
+      : num_threads_(num_threads),
+        num_rounds_(0),
+        storage_(new char[num_threads * participant_stride + cache_line_size])
+    {
+      if(num_threads == 0) throw std::invalid_argument("barrier: num_threads may not be 0.");
+
+      while((size_t(1) << num_rounds_) < num_threads_)
+      {
+        ++num_rounds_;
+      }
+
+      // align the first participant to a cache line
+      std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage_.get());
+      participants_ = reinterpret_cast<char*>((address + cache_line_size - 1) / cache_line_size * cache_line_size);
+
+      for(size_t i = 0; i < num_threads_; ++i)
+      {
+        ::new(participant_ptr(i)) participant();
+      }
+    }
+
+    dissemination_barrier(const dissemination_barrier&) = delete;
+    dissemination_barrier& operator=(const dissemination_barrier&) = delete;
+
+    inline ~dissemination_barrier()
+    {
+      for(size_t i = 0; i < num_threads_; ++i)
+      {
+        participant_ptr(i)->~participant();
+      }
+    }
+
+    inline size_t num_threads() const
+    {
+      return num_threads_;
+    }
+
+    inline void arrive_and_wait(size_t rank)
+    {
+      participant& self = *participant_ptr(rank);
+
+      size_t phase = ++self.phase;
+
+      for(size_t round = 0; round < num_rounds_; ++round)
+      {
+        size_t distance = size_t(1) << round;
+
+        signal(*participant_ptr((rank + distance) % num_threads_), round, phase);
+        wait_for_signal(self, round, phase);
+      }
+    }
+
+  private:
+    inline participant* participant_ptr(size_t rank) const
+    {
+      return reinterpret_cast<participant*>(participants_ + rank * participant_stride);
+    }
+
+    inline static void signal(participant& partner, size_t round, size_t phase)
+    {
+      // this store and the load of is_parked below must be sequentially consistent
+      // so that either the partner observes the flag or we observe that the partner is parked
+      partner.flags[round].store(phase, std::memory_order_seq_cst);
+
+      if(partner.is_parked.load(std::memory_order_seq_cst))
+      {
+        // acquire the partner's mutex so that our notification cannot slip between
+        // the partner's final check of its flag and its wait
+        {
+          std::unique_lock<std::mutex> lock(partner.mutex);
+        }
+
+        partner.wake_up.notify_one();
+      }
+    }
+
+    inline static bool is_signaled(const participant& self, size_t round, size_t phase)
+    {
+      // phases only increase, so a flag from a later phase also satisfies the wait
+      return self.flags[round].load(std::memory_order_acquire) >= phase;
+    }
+
+    inline static void wait_for_signal(participant& self, size_t round, size_t phase)
+    {
+      for(size_t i = 0; i < num_spins; ++i)
+      {
+        if(is_signaled(self, round, phase)) return;
+      }
+
+      for(size_t i = 0; i < num_yields; ++i)
+      {
+        if(is_signaled(self, round, phase)) return;
+
+        std::this_thread::yield();
+      }
+
+      // park
+      self.is_parked.store(true, std::memory_order_seq_cst);
+
+      {
+        std::unique_lock<std::mutex> lock(self.mutex);
+
+        self.wake_up.wait(lock, [&]
+        {
+          return self.flags[round].load(std::memory_order_seq_cst) >= phase;
+        });
+      }
+
+      self.is_parked.store(false, std::memory_order_relaxed);
+    }
+
+    size_t                  num_threads_;
+    size_t                  num_rounds_;
+    std::unique_ptr<char[]> storage_;
+    char*                   participants_;
+};
+
+
 using barrier = blocking_barrier;
 
 
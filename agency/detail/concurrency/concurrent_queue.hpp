@@ -113,6 +113,24 @@ class synchronic_concurrent_queue
       return emplace(item);
     }
 
+    // returns false without waiting if the queue is empty or closed
+    bool try_pop(T& item)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if(status_ == closed || items_.empty())
+      {
+        return false;
+      }
+
+      item = std::move(items_.front());
+      items_.pop();
+
+      notifier_.notify_one(status_, (int)(items_.empty() ? open_and_empty : open_and_ready));
+
+      return true;
+    }
+
     // XXX this should return queue_status
     bool wait_and_pop(T& item)
     {
@@ -229,6 +247,22 @@ class condition_variable_concurrent_queue
       return emplace(item);
     }
 
+    // returns false without waiting if the queue is empty or closed
+    bool try_pop(T& item)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if(is_closed_ || items_.empty())
+      {
+        return false;
+      }
+
+      item = std::move(items_.front());
+      items_.pop();
+
+      return true;
+    }
+
     // XXX this should return queue_status
     bool wait_and_pop(T& item)
     {
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// binds the calling thread to the given cpu
+// returns false if the thread could not be bound, or if binding is unsupported on this platform
+inline bool bind_this_thread_to_cpu(size_t cpu)
+{
+#if defined(__linux__)
+  if(cpu >= CPU_SETSIZE) return false;
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+
+// parses a cpu list such as "0-3,8,10-11" as found in /sys/devices/system/node/node0/cpulist
+inline std::vector<size_t> parse_cpu_list(const std::string& list)
+{
+  std::vector<size_t> result;
+
+  std::istringstream ranges(list);
+  std::string range;
+  while(std::getline(ranges, range, ','))
+  {
+    if(range.find_first_of("0123456789") == std::string::npos) continue;
+
+    size_t dash = range.find('-');
+
+    size_t first = std::strtoul(range.c_str(), nullptr, 10);
+    size_t last = dash == std::string::npos ? first : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+
+    for(size_t cpu = first; cpu <= last; ++cpu)
+    {
+      result.push_back(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+// returns the cpus of each of the system's NUMA nodes
+// when the topology cannot be discovered, the system is described as a single node containing every cpu
+inline std::vector<std::vector<size_t>> numa_node_cpus()
+{
+  std::vector<std::vector<size_t>> result;
+
+#if defined(__linux__)
+  // the online node ids are listed in the same format as a node's cpus
+  std::ifstream online_file("/sys/devices/system/node/online");
+
+  std::string online;
+  if(online_file && std::getline(online_file, online))
+  {
+    for(size_t node : parse_cpu_list(online))
+    {
+      std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+
+      std::string list;
+      if(!file || !std::getline(file, list)) continue;
+
+      std::vector<size_t> cpus = parse_cpu_list(list);
+
+      // memory-only nodes have no cpus
+      if(!cpus.empty())
+      {
+        result.push_back(std::move(cpus));
+      }
+    }
+  }
+#endif
+
+  if(result.empty())
+  {
+    std::vector<size_t> all_cpus(std::max(1u, std::thread::hardware_concurrency()));
+    for(size_t cpu = 0; cpu < all_cpus.size(); ++cpu)
+    {
+      all_cpus[cpu] = cpu;
+    }
+
+    result.push_back(std::move(all_cpus));
+  }
+
+  return result;
+}
+
+
+} // end detail
+} // end agency
+
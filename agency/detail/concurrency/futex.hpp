@@ -0,0 +1,129 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+#ifdef __linux__
+
+
+// blocks the calling thread while word holds expected
+// like the underlying system call, this function may return spuriously, so callers should wait in a loop
+inline void futex_wait(const std::atomic<int>& word, int expected)
+{
+  syscall(SYS_futex, reinterpret_cast<const int*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+
+// like futex_wait(), but returns once timeout has elapsed
+inline void futex_wait_for(const std::atomic<int>& word, int expected, std::chrono::nanoseconds timeout)
+{
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+  ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+
+  syscall(SYS_futex, reinterpret_cast<const int*>(&word), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+}
+
+
+// wakes every thread blocked in futex_wait() on word
+inline void futex_wake_all(const std::atomic<int>& word)
+{
+  syscall(SYS_futex, reinterpret_cast<const int*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+#else
+
+
+namespace futex_detail
+{
+
+
+// elsewhere, waiters park on one of a fixed number of condition variables selected by the address of the word
+struct parking_slot
+{
+  std::mutex              mutex;
+  std::condition_variable wake_up;
+};
+
+
+inline parking_slot& parking_slot_for(const void* address)
+{
+  constexpr std::size_t num_slots = 64;
+  static parking_slot slots[num_slots];
+
+  return slots[(reinterpret_cast<std::uintptr_t>(address) >> 4) % num_slots];
+}
+
+
+} // end futex_detail
+
+
+inline void futex_wait(const std::atomic<int>& word, int expected)
+{
+  futex_detail::parking_slot& slot = futex_detail::parking_slot_for(&word);
+
+  std::unique_lock<std::mutex> lock(slot.mutex);
+
+  if(word.load() == expected)
+  {
+    slot.wake_up.wait(lock);
+  }
+}
+
+
+inline void futex_wait_for(const std::atomic<int>& word, int expected, std::chrono::nanoseconds timeout)
+{
+  futex_detail::parking_slot& slot = futex_detail::parking_slot_for(&word);
+
+  std::unique_lock<std::mutex> lock(slot.mutex);
+
+  if(word.load() == expected)
+  {
+    slot.wake_up.wait_for(lock, timeout);
+  }
+}
+
+
+inline void futex_wake_all(const std::atomic<int>& word)
+{
+  futex_detail::parking_slot& slot = futex_detail::parking_slot_for(&word);
+
+  // acquire the slot's mutex so that our notification cannot slip between
+  // a waiter's check of the word and its wait
+  {
+    std::unique_lock<std::mutex> lock(slot.mutex);
+  }
+
+  slot.wake_up.notify_all();
+}
+
+
+#endif
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/unique_function.hpp>
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// gang_thread_pool launches groups of tasks which are guaranteed to execute concurrently
+//
+// each task of a gang is assigned its own thread, so the tasks of a gang may
+// synchronize with each other (e.g., with a barrier) without risk of deadlock
+//
+// threads are parked when their task completes and are reused by subsequent gangs
+// the pool only creates new threads when there are not enough parked threads
+// to accomodate a gang
+class gang_thread_pool
+{
+  private:
+    struct worker
+    {
+      std::mutex              mutex;
+      std::condition_variable wake_up;
+      unique_function<void()> task;
+      bool                    is_stopping = false;
+      std::thread             thread;
+    };
+
+  public:
+    gang_thread_pool() = default;
+
+    gang_thread_pool(const gang_thread_pool&) = delete;
+    gang_thread_pool& operator=(const gang_thread_pool&) = delete;
+
+    ~gang_thread_pool()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      for(auto& w : workers_)
+      {
+        std::unique_lock<std::mutex> worker_lock(w->mutex);
+        w->is_stopping = true;
+        w->wake_up.notify_one();
+      }
+
+      // move the workers out of the pool so they may return themselves to idle_workers_ while we join them
+      auto workers = std::move(workers_);
+      lock.unlock();
+
+      for(auto& w : workers)
+      {
+        w->thread.join();
+      }
+    }
+
+    // calls f(idx) for each idx in [0, n) such that all n invocations execute concurrently
+    // f is copied into each of the n tasks
+    // submit_gang() returns immediately, the caller is responsible for synchronizing with the gang's completion
+    // f must not throw: an exception escaping a task terminates the program, so callers capture exceptions within f
+    template<class Function>
+    void submit_gang(size_t n, Function f)
+    {
+      std::vector<worker*> gang = reserve(n);
+
+      for(size_t idx = 0; idx < n; ++idx)
+      {
+        worker* w = gang[idx];
+
+        {
+          std::unique_lock<std::mutex> lock(w->mutex);
+          w->task = [=]() mutable
+          {
+            f(idx);
+          };
+        }
+
+        w->wake_up.notify_one();
+      }
+    }
+
+    // returns the number of threads the pool has created
+    size_t size() const
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return workers_.size();
+    }
+
+    // returns the number of parked threads
+    size_t num_idle_threads() const
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return idle_workers_.size();
+    }
+
+  private:
+    // removes n workers from the idle list, creating new workers as necessary
+    std::vector<worker*> reserve(size_t n)
+    {
+      std::vector<worker*> result;
+      result.reserve(n);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      while(result.size() < n && !idle_workers_.empty())
+      {
+        result.push_back(idle_workers_.back());
+        idle_workers_.pop_back();
+      }
+
+      // grow the pool
+      while(result.size() < n)
+      {
+        workers_.emplace_back(new worker);
+        worker* w = workers_.back().get();
+
+        w->thread = std::thread([=]
+        {
+          work(w);
+        });
+
+        result.push_back(w);
+      }
+
+      return result;
+    }
+
+    void work(worker* self)
+    {
+      std::unique_lock<std::mutex> lock(self->mutex);
+
+      while(true)
+      {
+        self->wake_up.wait(lock, [=]
+        {
+          return self->is_stopping || self->task;
+        });
+
+        if(!self->task) break;
+
+        // run the task without holding our lock
+        unique_function<void()> task = std::move(self->task);
+        self->task = nullptr;
+        lock.unlock();
+
+        task();
+
+        // destroy the task before becoming idle so its resources are released promptly
+        task = nullptr;
+
+        {
+          std::unique_lock<std::mutex> pool_lock(mutex_);
+          idle_workers_.push_back(self);
+        }
+
+        lock.lock();
+      }
+    }
+
+    mutable std::mutex                   mutex_;
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<worker*>                 idle_workers_;
+};
+
+
+inline gang_thread_pool& system_gang_thread_pool()
+{
+  static gang_thread_pool resource;
+  return resource;
+}
+
+
+} // end detail
+} // end agency
+
@@ -4,6 +4,7 @@
 #include <agency/detail/concurrency/synchronic>
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 
@@ -96,6 +97,18 @@ class condition_variable_latch
       }
     }
 
+    // like wait(), but returns once timeout has elapsed
+    template<class Rep, class Period>
+    inline void wait_for(const std::chrono::duration<Rep,Period>& timeout)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if(!unsafe_is_ready())
+      {
+        cv_.wait_for(lock, timeout, [=]{ return this->unsafe_is_ready(); });
+      }
+    }
+
     inline bool is_ready() const
     {
       std::unique_lock<std::mutex> lock(mutex_);
@@ -8,8 +8,16 @@
 #include <agency/execution/executor/flattened_executor.hpp>
 #include <agency/detail/concurrency/latch.hpp>
 #include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <agency/detail/concurrency/work_stealing_deque.hpp>
+#include <agency/detail/concurrency/gang_thread_pool.hpp>
+#include <agency/detail/concurrency/cpu_topology.hpp>
+#include <agency/detail/concurrency/worker_identity.hpp>
 #include <agency/detail/unique_function.hpp>
+#include <agency/memory/allocator/detail/allocator_adaptor.hpp>
+#include <agency/memory/detail/resource/thread_caching_resource.hpp>
+#include <agency/experimental/optional.hpp>
 #include <agency/future.hpp>
+#include <agency/future/detail/continuation_future.hpp>
 #include <agency/detail/type_traits.hpp>
 
 #include <thread>
@@ -17,6 +25,11 @@
 #include <algorithm>
 #include <memory>
 #include <future>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 
 namespace agency
@@ -25,6 +38,18 @@ namespace detail
 {
 
 
+enum class thread_pool_mode
+{
+  // every task is pushed into a single queue shared by all worker threads
+  shared_queue,
+
+  // each worker thread owns a work_stealing_deque which receives the tasks submitted by that worker,
+  // tasks submitted from outside the pool go into a shared injection queue,
+  // and idle workers steal from the deques of other workers
+  work_stealing
+};
+
+
 class thread_pool
 {
   private:
@@ -40,53 +65,114 @@ class thread_pool
       }
     };
 
+    using task_type = unique_function<void()>;
+
   public:
-    explicit thread_pool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
+    // when cpus is non-empty, worker thread i is bound to cpus[i % cpus.size()]
+    explicit thread_pool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()),
+                         thread_pool_mode mode = thread_pool_mode::shared_queue,
+                         const std::vector<size_t>& cpus = std::vector<size_t>())
+      : mode_(mode),
+        is_stopping_(false),
+        num_sleeping_(0),
+        cpus_(cpus)
     {
+      if(mode_ == thread_pool_mode::work_stealing)
+      {
+        for(size_t i = 0; i < num_threads; ++i)
+        {
+          deques_.emplace_back(new work_stealing_deque<task_type*>());
+        }
+      }
+
       for(size_t i = 0; i < num_threads; ++i)
       {
-        threads_.emplace_back([this]
+        threads_.emplace_back([=]
         {
-          work();
+          work(i);
         });
       }
     }
     
     ~thread_pool()
     {
-      tasks_.close();
-      threads_.clear();
+      if(mode_ == thread_pool_mode::work_stealing)
+      {
+        {
+          std::unique_lock<std::mutex> lock(sleep_mutex_);
+          is_stopping_ = true;
+        }
+
+        wake_up_.notify_all();
+        threads_.clear();
+
+        // discard tasks which were never executed
+        task_type* task = nullptr;
+        for(auto& deque : deques_)
+        {
+          while(deque->try_pop(task))
+          {
+            delete task;
+          }
+        }
+
+        while(!injection_queue_.empty())
+        {
+          delete injection_queue_.front();
+          injection_queue_.pop();
+        }
+      }
+      else
+      {
+        tasks_.close();
+        threads_.clear();
+      }
     }
 
+    // f is always enqueued, even when the caller is one of this pool's threads
+    // a worker which waits for the tasks it submits should do so through help_until() or help_while_waiting(),
+    // which execute the pool's pending tasks in the meantime
     template<class Function,
              class = result_of_t<Function()>>
     inline void submit(Function&& f)
     {
-      auto is_this_thread = [=](const joining_thread& t)
+      if(mode_ == thread_pool_mode::work_stealing)
       {
-        return t.get_id() == std::this_thread::get_id();
-      };
-
-      // guard against self-submission which may result in deadlock
-      // XXX it might be faster to compare this to a thread_local variable
-      if(std::find_if(threads_.begin(), threads_.end(), is_this_thread) == threads_.end())
-      {
-        tasks_.emplace(std::forward<Function>(f));
+        submit_work_stealing(std::forward<Function>(f));
       }
       else
       {
-        // the submitting thread is part of this pool so execute immediately 
-        std::forward<Function>(f)();
+        // in shared_queue mode, the shared queue is every worker's local queue
+        tasks_.emplace(std::forward<Function>(f));
       }
     }
 
+    // returns true if the calling thread is one of this pool's threads
+    inline bool is_worker_thread() const
+    {
+      return this_thread_worker_identity().pool == this;
+    }
+
     inline size_t size() const
     {
       return threads_.size();
     }
 
+    inline thread_pool_mode mode() const
+    {
+      return mode_;
+    }
+
+    // the cpus this pool's threads are bound to, or empty if they are unbound
+    inline const std::vector<size_t>& cpus() const
+    {
+      return cpus_;
+    }
+
+    // the result is a continuation future, so a worker of this pool which waits for it
+    // executes the pool's pending tasks in the meantime rather than blocking
     template<class Function, class... Args>
-    std::future<result_of_t<Function(Args...)>>
+    continuation_future<result_of_t<Function(Args...)>>
       async(Function&& f, Args&&... args)
     {
       // bind f & args together
@@ -94,22 +180,216 @@ class thread_pool
 
       using result_type = result_of_t<Function(Args...)>;
 
-      // create a packaged task
-      std::packaged_task<result_type()> task(std::move(g));
+      // create a promise to receive g's result
+      auto promise = std::make_shared<continuation_promise<result_type>>();
 
-      // get the packaged task's future so we can return it at the end
-      auto result_future = task.get_future();
+      // get the promise's future so we can return it at the end
+      auto result_future = promise->get_future();
 
-      // move the packaged task into the thread pool
-      submit(std::move(task));
+      // move g into the thread pool
+      submit([=]() mutable
+      {
+        try
+        {
+          fulfill(*promise, g, std::is_void<result_type>());
+        }
+        catch(...)
+        {
+          promise->set_exception(std::current_exception());
+        }
+      });
 
-      return std::move(result_future);
+      return result_future;
     }
 
 
   private:
-    inline void work()
+    // fulfills promise with the result of g()
+    template<class Result, class Function>
+    inline static void fulfill(continuation_promise<Result>& promise, Function& g, std::false_type)
+    {
+      promise.set_value(g());
+    }
+
+    template<class Result, class Function>
+    inline static void fulfill(continuation_promise<Result>& promise, Function& g, std::true_type)
+    {
+      g();
+      promise.set_value();
+    }
+
+    template<class Function>
+    inline void submit_work_stealing(Function&& f)
+    {
+      task_type* task = new task_type(std::forward<Function>(f));
+
+      worker_identity& self = this_thread_worker_identity();
+
+      if(self.pool == this)
+      {
+        // the submitting thread is part of this pool so push onto its own deque
+        deques_[self.index]->push(task);
+      }
+      else
+      {
+        std::unique_lock<std::mutex> lock(injection_mutex_);
+        injection_queue_.push(task);
+      }
+
+      // order the push above before the load of num_sleeping_ below
+      // pairs with the fence in wait_for_work()
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if(num_sleeping_.load(std::memory_order_relaxed) > 0)
+      {
+        // take the lock so that the notification cannot slip in between
+        // a sleeping worker's final check for work and its wait
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_up_.notify_one();
+      }
+    }
+
+    inline bool try_pop_injected_task(task_type*& task)
+    {
+      std::unique_lock<std::mutex> lock(injection_mutex_);
+
+      if(injection_queue_.empty()) return false;
+
+      task = injection_queue_.front();
+      injection_queue_.pop();
+      return true;
+    }
+
+    inline bool try_steal_task(size_t thief_index, task_type*& task)
+    {
+      // begin the search at a different victim for each thief to spread out contention
+      size_t n = deques_.size();
+      for(size_t i = 1; i < n; ++i)
+      {
+        size_t victim = (thief_index + i) % n;
+        if(deques_[victim]->try_steal(task))
+        {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    inline bool try_find_task(size_t worker_index, task_type*& task)
+    {
+      return deques_[worker_index]->try_pop(task) ||
+             try_pop_injected_task(task) ||
+             try_steal_task(worker_index, task);
+    }
+
+    inline bool has_visible_work()
+    {
+      {
+        std::unique_lock<std::mutex> lock(injection_mutex_);
+        if(!injection_queue_.empty()) return true;
+      }
+
+      for(auto& deque : deques_)
+      {
+        if(!deque->empty()) return true;
+      }
+
+      return false;
+    }
+
+    // returns false when the pool is stopping
+    inline bool wait_for_work()
     {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+
+      num_sleeping_.fetch_add(1, std::memory_order_relaxed);
+
+      // order the increment of num_sleeping_ above before the final check for work below
+      // pairs with the fence in submit_work_stealing()
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      while(!is_stopping_ && !has_visible_work())
+      {
+        wake_up_.wait(lock);
+      }
+
+      num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+
+      return !is_stopping_;
+    }
+
+    // executes one pending task on behalf of a worker which is waiting
+    inline static bool try_execute_one(const void* self, size_t worker_index)
+    {
+      thread_pool& pool = *const_cast<thread_pool*>(static_cast<const thread_pool*>(self));
+
+      if(pool.mode_ == thread_pool_mode::work_stealing)
+      {
+        task_type* task = nullptr;
+        if(!pool.try_find_task(worker_index, task)) return false;
+
+        (*task)();
+        delete task;
+        return true;
+      }
+
+      task_type task;
+      if(!pool.tasks_.try_pop(task)) return false;
+
+      task();
+      return true;
+    }
+
+    inline void work_stealing_work(size_t worker_index)
+    {
+      task_type* task = nullptr;
+
+      while(true)
+      {
+        if(try_find_task(worker_index, task))
+        {
+          (*task)();
+          delete task;
+          continue;
+        }
+
+        // spin briefly before going to sleep
+        bool found_task = false;
+        for(int i = 0; i < 64 && !found_task; ++i)
+        {
+          std::this_thread::yield();
+          found_task = try_find_task(worker_index, task);
+        }
+
+        if(found_task)
+        {
+          (*task)();
+          delete task;
+        }
+        else if(!wait_for_work())
+        {
+          break;
+        }
+      }
+    }
+
+    inline void work(size_t worker_index)
+    {
+      if(!cpus_.empty())
+      {
+        // failure to bind is not an error: the cpu may be outside of this process's allowed set
+        bind_this_thread_to_cpu(cpus_[worker_index % cpus_.size()]);
+      }
+
+      this_thread_worker_identity() = worker_identity{this, worker_index, &thread_pool::try_execute_one};
+
+      if(mode_ == thread_pool_mode::work_stealing)
+      {
+        work_stealing_work(worker_index);
+        return;
+      }
+
       unique_function<void()> task;
 
       while(tasks_.wait_and_pop(task))
@@ -118,7 +398,22 @@ class thread_pool
       }
     }
 
-    agency::detail::concurrent_queue<unique_function<void()>> tasks_;
+    thread_pool_mode mode_;
+
+    // used in shared_queue mode
+    agency::detail::concurrent_queue<task_type> tasks_;
+
+    // used in work_stealing mode
+    std::vector<std::unique_ptr<work_stealing_deque<task_type*>>> deques_;
+    std::mutex injection_mutex_;
+    std::queue<task_type*> injection_queue_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+    bool is_stopping_;
+    std::atomic<size_t> num_sleeping_;
+
+    std::vector<size_t> cpus_;
+
     std::vector<joining_thread> threads_;
 };
 
@@ -131,11 +426,387 @@ inline thread_pool& system_thread_pool()
 }
 
 
+// returns one thread_pool per NUMA node
+// each pool has one thread per cpu of its node, and each thread is bound to its cpu
+inline const std::vector<std::unique_ptr<thread_pool>>& numa_thread_pools()
+{
+  struct pools : std::vector<std::unique_ptr<thread_pool>>
+  {
+    pools()
+    {
+      for(const auto& cpus : numa_node_cpus())
+      {
+        emplace_back(new thread_pool(cpus.size(), thread_pool_mode::shared_queue, cpus));
+      }
+    }
+  };
+
+  static pools resource;
+  return resource;
+}
+
+
+enum class thread_pool_schedule_kind
+{
+  // each index of a bulk launch is submitted to the pool as its own task
+  static_schedule,
+
+  // one task per pool thread is submitted and each task repeatedly claims
+  // the next grain-sized chunk of indices until the launch is exhausted
+  dynamic_schedule,
+
+  // like dynamic_schedule, but chunks begin large and shrink as the launch is exhausted
+  // a claimed chunk is never smaller than the grain
+  guided_schedule
+};
+
+
+// describes how thread_pool_executor divides the indices of a bulk launch among the threads of its pool
+//
+// the grain counts indices of thread_pool_executor's launches
+// parallel_thread_pool_executor (agency::parallel_executor) launches its agents directly on thread_pool_executor
+// under a load-balancing schedule, so there the grain counts agents:
+// par(n).on(parallel_executor(dynamic_schedule(4))) hands out agents 4 at a time
+struct thread_pool_schedule
+{
+  thread_pool_schedule_kind kind;
+  size_t grain;
+
+  explicit thread_pool_schedule(thread_pool_schedule_kind k = thread_pool_schedule_kind::static_schedule, size_t g = 1)
+    : kind(k),
+      grain(std::max<size_t>(1, g))
+  {}
+};
+
+
+inline thread_pool_schedule static_schedule()
+{
+  return thread_pool_schedule(thread_pool_schedule_kind::static_schedule);
+}
+
+inline thread_pool_schedule dynamic_schedule(size_t grain = 1)
+{
+  return thread_pool_schedule(thread_pool_schedule_kind::dynamic_schedule, grain);
+}
+
+inline thread_pool_schedule guided_schedule(size_t grain = 1)
+{
+  return thread_pool_schedule(thread_pool_schedule_kind::guided_schedule, grain);
+}
+
+
+// chunk_dispenser hands out contiguous chunks of [0, n) to the workers
+// of a bulk launch with a dynamic or guided schedule
+class chunk_dispenser
+{
+  public:
+    inline chunk_dispenser(const thread_pool_schedule& schedule, size_t n, size_t num_workers)
+      : schedule_(schedule),
+        n_(n),
+        num_workers_(std::max<size_t>(1, num_workers)),
+        next_(0)
+    {}
+
+    // returns false when no indices remain
+    inline bool claim(size_t& begin, size_t& end)
+    {
+      if(schedule_.kind == thread_pool_schedule_kind::guided_schedule)
+      {
+        begin = next_.load(std::memory_order_relaxed);
+
+        do
+        {
+          if(begin >= n_) return false;
+
+          // claim a fraction of the remaining indices
+          size_t remaining = n_ - begin;
+          size_t chunk_size = std::max(schedule_.grain, remaining / (2 * num_workers_));
+          end = std::min(n_, begin + chunk_size);
+        }
+        while(!next_.compare_exchange_weak(begin, end, std::memory_order_relaxed));
+
+        return true;
+      }
+
+      begin = next_.fetch_add(schedule_.grain, std::memory_order_relaxed);
+      if(begin >= n_) return false;
+
+      end = std::min(n_, begin + schedule_.grain);
+      return true;
+    }
+
+    // the number of workers a launch of n indices should use
+    inline static size_t num_workers(const thread_pool_schedule& schedule, size_t n, size_t pool_size)
+    {
+      size_t num_chunks = (n + schedule.grain - 1) / schedule.grain;
+      return std::max<size_t>(1, std::min(num_chunks, pool_size));
+    }
+
+  private:
+    thread_pool_schedule schedule_;
+    size_t n_;
+    size_t num_workers_;
+    std::atomic<size_t> next_;
+};
+
+
+// bulk_then_state is the single control block of a thread_pool_executor::bulk_then_execute() launch
+//
+// it holds everything the launch's tasks share: the user's function, the predecessor, the result,
+// the shared parameter, and a count of unfinished tasks
+// each task refers to the control block through a plain pointer rather than through shared_ptrs,
+// and the last task to finish fulfills the launch's promise and destroys the control block
+// control blocks are allocated from thread_caching_resource, so successive launches recycle them
+template<class Function, class SharedFuture, class ResultFactory, class SharedFactory>
+class bulk_then_state
+{
+  public:
+    using result_type = result_of_t<ResultFactory()>;
+    using shared_arg_type = result_of_t<SharedFactory()>;
+    using predecessor_type = future_value_t<SharedFuture>;
+
+  private:
+    using allocator_type = allocator_adaptor<bulk_then_state, thread_caching_resource>;
+
+  public:
+    static bulk_then_state* make(thread_pool& pool, const Function& f, size_t n, SharedFuture&& predecessor, const ResultFactory& result_factory, const SharedFactory& shared_factory, const thread_pool_schedule& schedule)
+    {
+      allocator_type alloc;
+      bulk_then_state* result = alloc.allocate(1);
+
+      try
+      {
+        ::new(result) bulk_then_state(pool, f, n, std::move(predecessor), result_factory, shared_factory, schedule);
+      }
+      catch(...)
+      {
+        alloc.deallocate(result, 1);
+        throw;
+      }
+
+      return result;
+    }
+
+    continuation_future<result_type> get_future()
+    {
+      return promise_.get_future();
+    }
+
+    // calls launch() once the predecessor is ready, or fail() if the predecessor is exceptional
+    void launch_when_ready()
+    {
+      launch_when_ready(predecessor_);
+    }
+
+  private:
+    bulk_then_state(thread_pool& pool, const Function& f, size_t n, SharedFuture&& predecessor, const ResultFactory& result_factory, const SharedFactory& shared_factory, const thread_pool_schedule& schedule)
+      : pool_(pool),
+        f_(f),
+        predecessor_(std::move(predecessor)),
+        result_factory_(result_factory),
+        shared_factory_(shared_factory),
+        num_tasks_(num_tasks(schedule, n, pool.size())),
+        chunks_(schedule, n, num_tasks_),
+        uses_chunks_(schedule.kind != thread_pool_schedule_kind::static_schedule),
+        num_remaining_tasks_(num_tasks_)
+    {}
+
+    static size_t num_tasks(const thread_pool_schedule& schedule, size_t n, size_t pool_size)
+    {
+      if(schedule.kind == thread_pool_schedule_kind::static_schedule)
+      {
+        // with the static schedule, each task is assigned a single index
+        return n;
+      }
+
+      return n == 0 ? 0 : chunk_dispenser::num_workers(schedule, n, pool_size);
+    }
+
+    void destroy()
+    {
+      allocator_type alloc;
+      this->~bulk_then_state();
+      alloc.deallocate(this, 1);
+    }
+
+    // a continuation future's continuations run on the thread which fulfills it
+    template<class T>
+    void launch_when_ready(shared_continuation_future<T>&)
+    {
+      predecessor_.on_ready([this]
+      {
+        launch_or_fail();
+      });
+    }
+
+    // a std::shared_future cannot accept continuations, so a thread outside of
+    // the pool waits for a pending std::shared_future on the launch's behalf
+    template<class T>
+    void launch_when_ready(std::shared_future<T>&)
+    {
+      if(predecessor_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+        launch_or_fail();
+      }
+      else
+      {
+        system_gang_thread_pool().submit_gang(1, [this](size_t)
+        {
+          launch_or_fail();
+        });
+      }
+    }
+
+    // other kinds of futures launch immediately and their tasks wait on the predecessor
+    template<class OtherFuture>
+    void launch_when_ready(OtherFuture&)
+    {
+      launch();
+    }
+
+    // the predecessor is ready
+    void launch_or_fail()
+    {
+      try
+      {
+        predecessor_.get();
+      }
+      catch(...)
+      {
+        // deliver the predecessor's exception without launching any tasks
+        promise_.set_exception(std::current_exception());
+        destroy();
+        return;
+      }
+
+      launch();
+    }
+
+    void launch()
+    {
+      try
+      {
+        result_.emplace(result_factory_());
+        shared_arg_.emplace(shared_factory_());
+      }
+      catch(...)
+      {
+        // deliver the factory's exception without launching any tasks
+        promise_.set_exception(std::current_exception());
+        destroy();
+        return;
+      }
+
+      if(num_tasks_ == 0)
+      {
+        complete();
+        return;
+      }
+
+      // copy num_tasks_ because the final task may destroy this control block before the loop ends
+      size_t num_tasks = num_tasks_;
+      bulk_then_state* self = this;
+
+      for(size_t task_idx = 0; task_idx < num_tasks; ++task_idx)
+      {
+        pool_.submit([self, task_idx]
+        {
+          self->execute(task_idx);
+        });
+      }
+    }
+
+    void execute(size_t task_idx)
+    {
+      if(!uses_chunks_)
+      {
+        invoke(task_idx, std::is_void<predecessor_type>());
+      }
+      else
+      {
+        size_t begin = 0, end = 0;
+        while(chunks_.claim(begin, end))
+        {
+          for(size_t idx = begin; idx < end; ++idx)
+          {
+            invoke(idx, std::is_void<predecessor_type>());
+          }
+        }
+      }
+
+      // the last task to finish completes the launch
+      if(num_remaining_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        complete();
+      }
+    }
+
+    // non-void predecessor
+    void invoke(size_t idx, std::false_type)
+    {
+      predecessor_type& predecessor_arg = const_cast<predecessor_type&>(predecessor_.get());
+
+      f_(idx, predecessor_arg, *result_, *shared_arg_);
+    }
+
+    // void predecessor
+    void invoke(size_t idx, std::true_type)
+    {
+      // this never blocks when the predecessor is a continuation future or std::shared_future
+      predecessor_.wait();
+
+      f_(idx, *result_, *shared_arg_);
+    }
+
+    void complete()
+    {
+      promise_.set_value(std::move(*result_));
+      destroy();
+    }
+
+    thread_pool&                            pool_;
+    Function                                f_;
+    SharedFuture                            predecessor_;
+    ResultFactory                           result_factory_;
+    SharedFactory                           shared_factory_;
+    experimental::optional<result_type>     result_;
+    experimental::optional<shared_arg_type> shared_arg_;
+    continuation_promise<result_type>       promise_;
+    size_t                                  num_tasks_;
+    chunk_dispenser                         chunks_;
+    bool                                    uses_chunks_;
+    std::atomic<size_t>                     num_remaining_tasks_;
+};
+
+
 class thread_pool_executor
 {
   public:
     using execution_category = parallel_execution_tag;
 
+    // creates a thread_pool_executor which executes on system_thread_pool()
+    explicit thread_pool_executor(const thread_pool_schedule& schedule = thread_pool_schedule())
+      : pool_(nullptr),
+        schedule_(schedule)
+    {}
+
+    // creates a thread_pool_executor which executes on the given pool
+    // the pool must outlive the executor and all of the work created through it
+    explicit thread_pool_executor(thread_pool& pool, const thread_pool_schedule& schedule = thread_pool_schedule())
+      : pool_(&pool),
+        schedule_(schedule)
+    {}
+
+    thread_pool& pool() const
+    {
+      return pool_ ? *pool_ : system_thread_pool();
+    }
+
+    const thread_pool_schedule& schedule() const
+    {
+      return schedule_;
+    }
+
     template<class Function, class ResultFactory, class SharedFactory>
     result_of_t<ResultFactory()>
       bulk_sync_execute(Function f, size_t n, ResultFactory result_factory, SharedFactory shared_factory)
@@ -148,13 +819,13 @@ class thread_pool_executor
       {
         if(n == 1) f(0, result, shared_arg);
       }
-      else
+      else if(schedule_.kind == thread_pool_schedule_kind::static_schedule)
       {
         agency::detail::latch work_remaining(n);
 
         for(size_t idx = 0; idx < n; ++idx)
         {
-          system_thread_pool().submit([=,&result,&shared_arg,&work_remaining] () mutable
+          pool().submit([=,&result,&shared_arg,&work_remaining] () mutable
           {
             f(idx, result, shared_arg);
 
@@ -163,168 +834,151 @@ class thread_pool_executor
         }
 
         // wait for all the work to complete
-        work_remaining.wait();
+        // when this thread is one of the pool's, it executes the pool's tasks in the meantime
+        help_while_waiting(work_remaining);
       }
-
-      return std::move(result);
-    }
-
-  private:
-    // this deleter fulfills a promise just before
-    // it deletes its argument
-    template<class ResultType>
-    struct fulfill_promise_and_delete
-    {
-      std::shared_ptr<std::promise<ResultType>> shared_promise_ptr;
-
-      void operator()(ResultType* ptr_to_result)
+      else
       {
-        // move the result object into the promise
-        shared_promise_ptr->set_value(std::move(*ptr_to_result));
-
-        // delete the pointer
-        delete ptr_to_result;
-      }
-    };
-    
+        size_t num_workers = chunk_dispenser::num_workers(schedule_, n, pool().size());
+        chunk_dispenser chunks(schedule_, n, num_workers);
 
-  public:
-    // this is the overload of bulk_then_execute for non-void Future
-    template<class Function, class Future, class ResultFactory, class SharedFactory,
-             __AGENCY_REQUIRES(!std::is_void<future_value_t<Future>>::value)
-            >
-    std::future<
-      result_of_t<ResultFactory()>
-    >
-      bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
-    {
-      using result_type = result_of_t<ResultFactory()>;
-
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
-
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
-
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
+        auto worker = [&]
+        {
+          size_t begin = 0, end = 0;
+          while(chunks.claim(begin, end))
+          {
+            for(size_t idx = begin; idx < end; ++idx)
+            {
+              f(idx, result, shared_arg);
+            }
+          }
+        };
+
+        // the calling thread participates as one of the workers,
+        // so only num_workers - 1 tasks are submitted to the pool
+        if(num_workers > 1)
+        {
+          agency::detail::latch work_remaining(num_workers - 1);
 
-      // create the shared state for the result
-      // note that we use our special deleter with this state
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+          for(size_t i = 1; i < num_workers; ++i)
+          {
+            pool().submit([&]
+            {
+              worker();
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+              work_remaining.count_down(1);
+            });
+          }
 
-      // share the incoming future
-      auto shared_predecessor = future_traits<Future>::share(predecessor);
+          worker();
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
-      {
-        system_thread_pool().submit([=]() mutable
+          help_while_waiting(work_remaining);
+        }
+        else
         {
-// nvcc makes this lambda's constructors __host__ __device__ when
-// any of its captures' constructors are __host__ __device__. This causes nvcc
-// to emit warnings about a __host__ __device__ function calling __host__ functions 
-// this #ifndef works around this problem
-#ifndef __CUDA_ARCH__
-          // get the predecessor future's value
-          using predecessor_type = future_value_t<Future>;
-          predecessor_type& predecessor_arg = const_cast<predecessor_type&>(shared_predecessor.get());
-
-          // call the user's function
-          f(idx, predecessor_arg, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
-#endif
-        });
+          worker();
+        }
       }
 
-      // return the result future
-      return std::move(result_future);
+      return result;
     }
 
+    template<class T>
+    using future = agency::future<T>;
 
-    // this is the overload of bulk_then_execute for void Future
-    template<class Function, class Future, class ResultFactory, class SharedFactory,
-             __AGENCY_REQUIRES(std::is_void<future_value_t<Future>>::value)
-            >
-    std::future<
+    template<class Function, class Future, class ResultFactory, class SharedFactory>
+    future<
       result_of_t<ResultFactory()>
     >
       bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
     {
-      using result_type = result_of_t<ResultFactory()>;
-
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
-
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
-
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
+      // share the incoming future
+      auto shared_predecessor = future_traits<Future>::share(predecessor);
 
-      // create the shared state for the result
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+      using state_type = bulk_then_state<Function, decltype(shared_predecessor), ResultFactory, SharedFactory>;
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+      // create the launch's control block
+      state_type* state = state_type::make(pool(), f, n, std::move(shared_predecessor), result_factory, shared_factory, schedule_);
 
-      // share the incoming future
-      auto shared_predecessor = future_traits<Future>::share(predecessor);
+      auto result_future = state->get_future();
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
-      {
-        system_thread_pool().submit([=]() mutable
-        {
-// nvcc makes this lambda's constructors __host__ __device__ when
-// any of its captures' constructors are __host__ __device__. This causes nvcc
-// to emit warnings about a __host__ __device__ function calling __host__ functions 
-// this #ifndef works around this problem
-#ifndef __CUDA_ARCH__
-          // wait on the predecessor future
-          shared_predecessor.wait();
-
-          // call the user's function
-          f(idx, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
-#endif
-        });
-      }
+      // the tasks are submitted to the pool only once the predecessor is ready
+      // so that no task ever blocks a thread of the pool waiting for its input
+      // note that state may be destroyed by the time launch_when_ready() returns
+      state->launch_when_ready();
 
-      // return the result future
-      return std::move(result_future);
+      return result_future;
     }
 
     size_t unit_shape() const
     {
-      return system_thread_pool().size();
+      // with a load-balancing schedule, ask for more indices than there are threads
+      // so that a flattened_executor composed with this executor partitions its launches
+      // into enough blocks for the pool's threads to balance among themselves
+      size_t oversubscription = schedule_.kind == thread_pool_schedule_kind::static_schedule ? 1 : 8;
+
+      return oversubscription * pool().size();
     }
+
+  private:
+    // a null pool_ refers to system_thread_pool(), which is created on first use
+    thread_pool* pool_;
+    thread_pool_schedule schedule_;
 };
 
 
 // compose thread_pool_executor with other fancy executors
 // to yield a parallel_thread_pool_executor
-using parallel_thread_pool_executor = agency::flattened_executor<
+class parallel_thread_pool_executor : public agency::flattened_executor<
   agency::scoped_executor<
     thread_pool_executor,
     agency::this_thread::parallel_executor
   >
->;
+>
+{
+  private:
+    using super_t = agency::flattened_executor<
+      agency::scoped_executor<
+        thread_pool_executor,
+        agency::this_thread::parallel_executor
+      >
+    >;
+
+  public:
+    parallel_thread_pool_executor() = default;
+
+    // creates a parallel_thread_pool_executor whose launches are balanced among the pool's threads according to schedule
+    // for example, parallel_thread_pool_executor(dynamic_schedule(4))
+    explicit parallel_thread_pool_executor(const thread_pool_schedule& schedule)
+      : super_t(base_executor_type(thread_pool_executor(schedule), agency::this_thread::parallel_executor()))
+    {}
+
+    // creates a parallel_thread_pool_executor which executes on the given pool
+    explicit parallel_thread_pool_executor(thread_pool& pool, const thread_pool_schedule& schedule = thread_pool_schedule())
+      : super_t(base_executor_type(thread_pool_executor(pool, schedule), agency::this_thread::parallel_executor()))
+    {}
+
+    const thread_pool_schedule& schedule() const
+    {
+      return base_executor().outer_executor().schedule();
+    }
+
+    // the static schedule executes each of the blocks of agents produced by flattening as a task of the pool
+    // a load-balancing schedule instead launches the agents directly on thread_pool_executor,
+    // so that its grain counts agents, rather than blocks of agents
+    template<class Function, class Future, class ResultFactory, class SharedFactory>
+    future<result_of_t<ResultFactory()>>
+      bulk_then_execute(Function f, shape_type shape, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
+    {
+      if(schedule().kind == thread_pool_schedule_kind::static_schedule)
+      {
+        return super_t::bulk_then_execute(f, shape, predecessor, result_factory, shared_factory);
+      }
+
+      // thread_pool_executor passes its arguments to f in the same order as the flattened executor
+      return base_executor().outer_executor().bulk_then_execute(f, shape, predecessor, result_factory, shared_factory);
+    }
+};
 
 
 // compose thread_pool_executor with other fancy executors
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// work_stealing_deque is a Chase-Lev deque
+//
+// a single owning thread pushes and pops items at the bottom of the deque,
+// while any number of thieves steal items from the top of the deque
+//
+// the implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models",
+// Le, Pop, Cohen & Zappa Nardelli, PPoPP 2013
+//
+// T must be trivially copyable because items are stored in std::atomic<T>
+// typically, T is a pointer to a heap-allocated task
+template<class T>
+class work_stealing_deque
+{
+  static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque: T must be trivially copyable.");
+
+  private:
+    // a circular array whose capacity is a power of two
+    class ring
+    {
+      public:
+        inline explicit ring(std::ptrdiff_t capacity)
+          : capacity_(capacity),
+            mask_(capacity - 1),
+            items_(new std::atomic<T>[capacity])
+        {}
+
+        inline std::ptrdiff_t capacity() const
+        {
+          return capacity_;
+        }
+
+        inline void store(std::ptrdiff_t i, T item)
+        {
+          items_[i & mask_].store(item, std::memory_order_relaxed);
+        }
+
+        inline T load(std::ptrdiff_t i) const
+        {
+          return items_[i & mask_].load(std::memory_order_relaxed);
+        }
+
+        // returns a copy of this ring with twice the capacity
+        // containing the items in [top, bottom)
+        inline ring* grow(std::ptrdiff_t top, std::ptrdiff_t bottom) const
+        {
+          ring* result = new ring(2 * capacity_);
+
+          for(std::ptrdiff_t i = top; i < bottom; ++i)
+          {
+            result->store(i, load(i));
+          }
+
+          return result;
+        }
+
+      private:
+        std::ptrdiff_t capacity_;
+        std::ptrdiff_t mask_;
+        std::unique_ptr<std::atomic<T>[]> items_;
+    };
+
+  public:
+    inline explicit work_stealing_deque(std::ptrdiff_t initial_capacity = 256)
+      : top_(0),
+        bottom_(0),
+        ring_(new ring(round_up_to_power_of_two(initial_capacity)))
+    {
+      retired_rings_.emplace_back(ring_.load(std::memory_order_relaxed));
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    // push may only be called by the owning thread
+    inline void push(T item)
+    {
+      std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed);
+      std::ptrdiff_t t = top_.load(std::memory_order_acquire);
+      ring* r = ring_.load(std::memory_order_relaxed);
+
+      if(b - t > r->capacity() - 1)
+      {
+        // the ring is full, so grow it
+        // thieves may still be reading from the old ring, so we keep it alive until we are destroyed
+        r = r->grow(t, b);
+        retired_rings_.emplace_back(r);
+        ring_.store(r, std::memory_order_release);
+      }
+
+      r->store(b, item);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // try_pop may only be called by the owning thread
+    // returns false if the deque is empty
+    inline bool try_pop(T& item)
+    {
+      std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed) - 1;
+      ring* r = ring_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::ptrdiff_t t = top_.load(std::memory_order_relaxed);
+
+      bool result = true;
+
+      if(t <= b)
+      {
+        // the deque is non-empty
+        item = r->load(b);
+
+        if(t == b)
+        {
+          // this is the last item, so race against thieves for it
+          if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          {
+            // a thief won the race
+            result = false;
+          }
+
+          bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+      }
+      else
+      {
+        // the deque is empty
+        result = false;
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+
+      return result;
+    }
+
+    // try_steal may be called by any thread
+    // returns false if the deque is empty or if the steal lost a race with another thread
+    inline bool try_steal(T& item)
+    {
+      std::ptrdiff_t t = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::ptrdiff_t b = bottom_.load(std::memory_order_acquire);
+
+      if(t < b)
+      {
+        // the deque is non-empty
+        ring* r = ring_.load(std::memory_order_acquire);
+        T result = r->load(t);
+
+        if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+          // another thread won the race
+          return false;
+        }
+
+        item = result;
+        return true;
+      }
+
+      return false;
+    }
+
+    // the result of empty() is only a hint when the deque is shared with other threads
+    inline bool empty() const
+    {
+      std::ptrdiff_t b = bottom_.load(std::memory_order_seq_cst);
+      std::ptrdiff_t t = top_.load(std::memory_order_seq_cst);
+      return b <= t;
+    }
+
+  private:
+    inline static std::ptrdiff_t round_up_to_power_of_two(std::ptrdiff_t n)
+    {
+      std::ptrdiff_t result = 1;
+      while(result < n)
+      {
+        result *= 2;
+      }
+
+      return result;
+    }
+
+    // top_ is touched by thieves while bottom_ is touched by the owner,
+    // so keep them on separate cache lines
+    std::atomic<std::ptrdiff_t> top_;
+    char padding0_[64 - sizeof(std::atomic<std::ptrdiff_t>)];
+    std::atomic<std::ptrdiff_t> bottom_;
+    char padding1_[64 - sizeof(std::atomic<std::ptrdiff_t>)];
+
+    std::atomic<ring*> ring_;
+
+    // the current ring along with every ring we have grown out of
+    std::vector<std::unique_ptr<ring>> retired_rings_;
+};
+
+
+} // end detail
+} // end agency
+
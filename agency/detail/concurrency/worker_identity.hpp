@@ -0,0 +1,115 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// worker_identity identifies the thread pool & worker which the current thread belongs to, if any
+//
+// a worker which must wait for work it has submitted to its own pool executes the pool's pending
+// tasks through try_execute_one() in the meantime, rather than blocking one of the pool's threads
+struct worker_identity
+{
+  const void* pool;
+  std::size_t index;
+
+  // executes one of pool's pending tasks on behalf of worker index
+  // returns false if no task was found
+  bool (*try_execute_one)(const void* pool, std::size_t index);
+};
+
+
+inline worker_identity& this_thread_worker_identity()
+{
+  // thread_local objects of trivial type are zero-initialized
+  static thread_local worker_identity identity;
+  return identity;
+}
+
+
+// if the current thread is a worker of a thread pool, executes the pool's pending tasks until ready() returns true
+// returns false without waiting if the current thread is not a worker, in which case the caller should block
+//
+// when the pool has had no pending tasks for a while, the worker calls park(timeout), which should block until
+// ready() may have become true, or until timeout elapses
+// the timeout bounds how long a task submitted to the pool while the worker is parked may go unnoticed,
+// and it grows while the worker finds nothing to do
+template<class Predicate, class Park>
+inline bool help_until(Predicate ready, Park park)
+{
+  worker_identity self = this_thread_worker_identity();
+
+  if(self.pool == nullptr) return false;
+
+  constexpr int max_num_spins = 64;
+  constexpr std::chrono::microseconds min_park_timeout(16);
+  constexpr std::chrono::microseconds max_park_timeout(1024);
+
+  int num_spins = 0;
+  std::chrono::microseconds park_timeout = min_park_timeout;
+
+  while(!ready())
+  {
+    if(self.try_execute_one(self.pool, self.index))
+    {
+      num_spins = 0;
+      park_timeout = min_park_timeout;
+    }
+    else if(num_spins < max_num_spins)
+    {
+      ++num_spins;
+      std::this_thread::yield();
+    }
+    else
+    {
+      park(park_timeout);
+      park_timeout = std::min(2 * park_timeout, max_park_timeout);
+    }
+  }
+
+  return true;
+}
+
+
+// parks by sleeping, for predicates which cannot notify a parked worker
+template<class Predicate>
+inline bool help_until(Predicate ready)
+{
+  return help_until(ready, [](std::chrono::microseconds timeout)
+  {
+    std::this_thread::sleep_for(timeout);
+  });
+}
+
+
+// waits for a latch-like object with is_ready(), wait() & wait_for() members,
+// executing pending tasks if the current thread is a worker of a thread pool
+template<class Waitable>
+inline void help_while_waiting(Waitable& w)
+{
+  auto ready = [&]{ return w.is_ready(); };
+
+  auto park = [&](std::chrono::microseconds timeout)
+  {
+    w.wait_for(timeout);
+  };
+
+  if(!help_until(ready, park))
+  {
+    w.wait();
+  }
+}
+
+
+} // end detail
+} // end agency
+
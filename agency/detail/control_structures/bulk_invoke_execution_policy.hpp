@@ -6,6 +6,7 @@
 #include <agency/detail/control_structures/decay_parameter.hpp>
 #include <agency/detail/control_structures/execute_agent_functor.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
+#include <agency/detail/control_structures/result_destination.hpp>
 #include <agency/detail/control_structures/single_result.hpp>
 #include <agency/detail/control_structures/shared_parameter.hpp>
 #include <agency/detail/control_structures/agent_shared_parameter_factory_tuple.hpp>
@@ -43,12 +44,15 @@ template<class ExecutionPolicy, class Function, class... Args>
 using bulk_invoke_execution_policy_result_t = typename bulk_invoke_execution_policy_result<ExecutionPolicy,Function,Args...>::type;
 
 
-template<size_t... UserArgIndices, size_t... SharedArgIndices, class ExecutionPolicy, class Function, class... Args>
-bulk_invoke_execution_policy_result_t<
-  ExecutionPolicy, Function, Args...
+// results is return_results or a result_destination, as with bulk_invoke_executor()
+template<size_t... UserArgIndices, size_t... SharedArgIndices, class ResultDestination, class ExecutionPolicy, class Function, class... Args>
+result_destination_result_t<
+  ResultDestination,
+  bulk_invoke_execution_policy_result_t<ExecutionPolicy, Function, Args...>
 >
   bulk_invoke_execution_policy(index_sequence<UserArgIndices...>,
                                index_sequence<SharedArgIndices...>,
+                               ResultDestination results,
                                ExecutionPolicy& policy, Function f, Args&&... args)
 {
   using agent_type = typename ExecutionPolicy::execution_agent_type;
@@ -72,6 +76,7 @@ bulk_invoke_execution_policy_result_t<
   auto lambda = execute_agent_functor<executor_type,agent_traits,Function,UserArgIndices...>{param, agent_shape, executor_shape, f};
 
   return detail::bulk_invoke_executor(
+    results,
     policy.executor(),
     executor_shape,
     lambda,
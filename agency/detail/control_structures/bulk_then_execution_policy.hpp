@@ -9,6 +9,7 @@
 #include <agency/detail/control_structures/shared_parameter.hpp>
 #include <agency/detail/control_structures/bulk_invoke_execution_policy.hpp>
 #include <agency/detail/is_call_possible.hpp>
+#include <agency/detail/fast_divisor.hpp>
 #include <agency/execution/execution_agent.hpp>
 #include <agency/execution/executor/executor_traits/executor_shape.hpp>
 #include <agency/execution/detail/execution_policy_traits.hpp>
@@ -32,10 +33,22 @@ struct then_execute_agent_functor
 
   using executor_shape_type = executor_shape_t<Executor>;
 
-  agent_param_type    agent_param_;
-  agent_shape_type    agent_shape_;
-  executor_shape_type executor_shape_;
-  Function            f_;
+  // the agent's shape is stored with fast_divisors in place of its elements,
+  // so that index_cast() divides each agent's index by multiplication
+  using fast_agent_shape_type = fast_shape_t<agent_shape_type>;
+
+  agent_param_type      agent_param_;
+  fast_agent_shape_type agent_shape_;
+  executor_shape_type   executor_shape_;
+  Function              f_;
+
+  __AGENCY_ANNOTATION
+  then_execute_agent_functor(const agent_param_type& agent_param, const agent_shape_type& agent_shape, const executor_shape_type& executor_shape, const Function& f)
+    : agent_param_(agent_param),
+      agent_shape_(detail::make_fast_shape(agent_shape)),
+      executor_shape_(executor_shape),
+      f_(f)
+  {}
 
   using agent_index_type    = typename AgentTraits::index_type;
   using executor_index_type = executor_index_t<Executor>;
@@ -4,6 +4,7 @@
 #include <agency/detail/tuple.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <agency/detail/index_cast.hpp>
+#include <agency/detail/fast_divisor.hpp>
 #include <agency/detail/invoke.hpp>
 #include <agency/execution/executor/executor_traits/executor_shape.hpp>
 #include <agency/execution/executor/executor_traits/executor_index.hpp>
@@ -26,10 +27,22 @@ struct execute_agent_functor
 
   using executor_shape_type = executor_shape_t<Executor>;
 
-  agent_param_type    agent_param_;
-  agent_shape_type    agent_shape_;
-  executor_shape_type executor_shape_;
-  Function            f_;
+  // the agent's shape is stored with fast_divisors in place of its elements,
+  // so that index_cast() divides each agent's index by multiplication
+  using fast_agent_shape_type = fast_shape_t<agent_shape_type>;
+
+  agent_param_type      agent_param_;
+  fast_agent_shape_type agent_shape_;
+  executor_shape_type   executor_shape_;
+  Function              f_;
+
+  __AGENCY_ANNOTATION
+  execute_agent_functor(const agent_param_type& agent_param, const agent_shape_type& agent_shape, const executor_shape_type& executor_shape, const Function& f)
+    : agent_param_(agent_param),
+      agent_shape_(detail::make_fast_shape(agent_shape)),
+      executor_shape_(executor_shape),
+      f_(f)
+  {}
 
   using agent_index_type    = typename AgentTraits::index_type;
   using executor_index_type = executor_index_t<Executor>;
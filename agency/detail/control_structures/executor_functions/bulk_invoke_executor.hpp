@@ -10,6 +10,7 @@
 #include <agency/detail/control_structures/executor_functions/bind_agent_local_parameters.hpp>
 #include <agency/detail/control_structures/executor_functions/unpack_shared_parameters_from_executor_and_invoke.hpp>
 #include <agency/detail/control_structures/executor_functions/result_factory.hpp>
+#include <agency/detail/control_structures/result_destination.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
 #include <agency/detail/control_structures/decay_parameter.hpp>
 #include <agency/detail/type_traits.hpp>
@@ -69,9 +70,14 @@ template<class Executor, class Function, class... Args>
 using bulk_invoke_executor_result_t = typename bulk_invoke_executor_result<Executor,Function,Args...>::type;
 
 
-template<class Executor, class Function, class... Args>
-bulk_invoke_executor_result_t<Executor, Function, Args...>
-  bulk_invoke_executor(Executor& exec, executor_shape_t<Executor> shape, Function f, Args&&... args)
+// results is either return_results, in which case f's results are collected into a new container which is returned,
+// or a result_destination into which f's results are written
+template<class ResultDestination, class Executor, class Function, class... Args>
+result_destination_result_t<
+  ResultDestination,
+  bulk_invoke_executor_result_t<Executor, Function, Args...>
+>
+  bulk_invoke_executor(ResultDestination results, Executor& exec, executor_shape_t<Executor> shape, Function f, Args&&... args)
 {
   // the _1 is for the executor idx parameter, which is the first parameter passed to f
   auto g = detail::bind_agent_local_parameters_workaround_nvbug1754712(std::integral_constant<size_t,1>(), f, detail::placeholders::_1, std::forward<Args>(args)...);
@@ -91,8 +97,9 @@ bulk_invoke_executor_result_t<Executor, Function, Args...>
   // compute the type of f's result
   using result_of_f = result_of_t<Function(executor_index_t<Executor>,decay_parameter_t<Args>...)>;
 
-  // based on the type of f's result, make a factory that will create the appropriate type of container to store f's results
-  auto result_factory = detail::make_result_factory<result_of_f>(exec, shape);
+  // based on the type of f's result, make a factory that will create the appropriate type of container to store f's results,
+  // unless the results have somewhere else to go
+  auto result_factory = results.template make_result_factory<result_of_f>(exec, shape);
 
   return detail::bulk_invoke_executor_impl(exec, h, result_factory, shape, factory_tuple, detail::make_index_sequence<execution_depth>());
 }
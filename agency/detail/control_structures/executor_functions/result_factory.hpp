@@ -1,7 +1,12 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
 #include <agency/execution/executor/executor_traits/executor_shape.hpp>
+#include <agency/execution/executor/executor_traits/executor_allocator.hpp>
+#include <agency/execution/executor/executor_traits/executor_execution_category.hpp>
+#include <agency/execution/execution_categories.hpp>
+#include <agency/memory/allocator/detail/bulk_construct_n.hpp>
 #include <agency/execution/executor/detail/utility/executor_container_or_void.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
 #include <type_traits>
@@ -43,9 +48,27 @@ template<class Executor, class ResultOfFunction>
 using result_container_t = typename result_container<Executor, ResultOfFunction>::type;
 
 
+// a result container in host memory is constructed in parallel by the parallel executor which will fill it
+template<class Executor, class ResultOfFunction>
+struct has_bulk_constructible_result_container
+  : std::integral_constant<
+      bool,
+      std::is_same<executor_execution_category_t<Executor>, parallel_execution_tag>::value &&
+      std::is_same<executor_shape_t<Executor>, std::size_t>::value &&
+      std::is_same<executor_allocator_t<Executor,ResultOfFunction>, std::allocator<ResultOfFunction>>::value &&
+      std::is_constructible<result_container_t<Executor,ResultOfFunction>, const Executor&, executor_shape_t<Executor>>::value
+    >
+{};
+
+// void results have no container
+template<class Executor>
+struct has_bulk_constructible_result_container<Executor,void> : std::false_type {};
+
+
 template<class ResultOfFunction, class Executor,
          class = typename std::enable_if<
-           !std::is_void<ResultOfFunction>::value
+           !std::is_void<ResultOfFunction>::value &&
+           !has_bulk_constructible_result_container<Executor,ResultOfFunction>::value
          >::type>
 __AGENCY_ANNOTATION
 construct<result_container_t<Executor,ResultOfFunction>, executor_shape_t<Executor>>
@@ -59,6 +82,22 @@ construct<result_container_t<Executor,ResultOfFunction>, executor_shape_t<Execut
 }
 
 
+template<class ResultOfFunction, class Executor,
+         __AGENCY_REQUIRES(
+           !std::is_void<ResultOfFunction>::value &&
+           has_bulk_constructible_result_container<Executor,ResultOfFunction>::value
+         )>
+construct<result_container_t<Executor,ResultOfFunction>, Executor, executor_shape_t<Executor>>
+  make_result_factory(const Executor& exec, const executor_shape_t<Executor>& shape)
+{
+  // compute the type of container to use to store results
+  using container_type = result_container_t<Executor,ResultOfFunction>;
+
+  // create a factory for the result container that calls the container's constructor with the given executor and shape
+  return make_construct<container_type>(exec, shape);
+}
+
+
 } // end detail
 } // end agency
 
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/factory.hpp>
+#include <agency/execution/executor/executor_traits/executor_shape.hpp>
+#include <agency/detail/control_structures/executor_functions/result_factory.hpp>
+#include <utility>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// return_results indicates that bulk_invoke() collects the results of its agents into a new container which it returns
+struct return_results
+{
+  __agency_exec_check_disable__
+  template<class ResultOfFunction, class Executor>
+  __AGENCY_ANNOTATION
+  auto make_result_factory(const Executor& exec, const executor_shape_t<Executor>& shape) const ->
+    decltype(detail::make_result_factory<ResultOfFunction>(exec, shape))
+  {
+    return detail::make_result_factory<ResultOfFunction>(exec, shape);
+  }
+};
+
+
+// result_destination refers to a caller-provided container into which bulk_invoke() writes the results of its agents
+// each agent's result is written to results[idx], where idx is the index of the agent's invocation by its executor
+//
+// an executor creates its result container with a factory and returns it by value,
+// so the executor receives and returns a result_destination rather than a container
+template<class Container>
+class result_destination
+{
+  public:
+    __AGENCY_ANNOTATION
+    explicit result_destination(Container& results)
+      : results_(&results)
+    {}
+
+    template<class Index>
+    __AGENCY_ANNOTATION
+    auto operator[](const Index& idx) const ->
+      decltype(std::declval<Container&>()[idx])
+    {
+      return (*results_)[idx];
+    }
+
+    __AGENCY_ANNOTATION
+    operator Container& () const
+    {
+      return *results_;
+    }
+
+    // no container is created, so this factory just copies this result_destination
+    template<class ResultOfFunction, class Executor>
+    __AGENCY_ANNOTATION
+    construct<result_destination,result_destination> make_result_factory(const Executor&, const executor_shape_t<Executor>&) const
+    {
+      return detail::make_copy_construct(*this);
+    }
+
+  private:
+    Container* results_;
+};
+
+
+// computes the type returned by bulk_invoke() when its agents produce results of type Result
+template<class ResultDestination, class Result>
+struct result_destination_result
+{
+  using type = Result;
+};
+
+// when the results are written into a caller-provided container, bulk_invoke() returns a reference to that container
+template<class Container, class Result>
+struct result_destination_result<result_destination<Container>, Result>
+{
+  using type = Container&;
+};
+
+template<class ResultDestination, class Result>
+using result_destination_result_t = typename result_destination_result<ResultDestination,Result>::type;
+
+
+} // end detail
+
+
+/// \brief Directs `bulk_invoke()` to write results into an existing container.
+/// \ingroup control_structures
+///
+/// `into(results)` returns an object which, when passed as `bulk_invoke()`'s first parameter, causes the
+/// result of each agent to be assigned to `results[idx]`, where `idx` is the index of the agent's invocation by its executor.
+/// Because `bulk_invoke()` neither allocates nor constructs a new container of results, this is useful when
+/// `bulk_invoke()` is called repeatedly with the same shape.
+///
+/// \param results A container whose elements will receive the results of `bulk_invoke()`'s agents.
+///        Its `operator[]` must accept the indices of the invocations created by the executor of `bulk_invoke()`'s execution policy,
+///        and `results` must outlive the call to `bulk_invoke()`.
+template<class Container>
+__AGENCY_ANNOTATION
+detail::result_destination<Container> into(Container& results)
+{
+  return detail::result_destination<Container>(results);
+}
+
+
+} // end agency
+
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/tuple.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace agency
+{
+namespace detail
+{
+namespace fast_divisor_detail
+{
+
+
+// the unsigned word in which a fast_divisor of Integer computes
+template<class Integer>
+using word_t = typename std::conditional<
+  sizeof(Integer) <= sizeof(std::uint32_t),
+  std::uint32_t,
+  std::uint64_t
+>::type;
+
+
+// returns the high word of the double-word product of x and y
+__AGENCY_ANNOTATION
+inline std::uint32_t mulhi(std::uint32_t x, std::uint32_t y)
+{
+  return static_cast<std::uint32_t>((static_cast<std::uint64_t>(x) * y) >> 32);
+}
+
+__AGENCY_ANNOTATION
+inline std::uint64_t mulhi(std::uint64_t x, std::uint64_t y)
+{
+#if defined(__CUDA_ARCH__)
+  return __umul64hi(x, y);
+#elif defined(__SIZEOF_INT128__)
+  return static_cast<std::uint64_t>((static_cast<unsigned __int128>(x) * y) >> 64);
+#else
+  // sum the products of the halves of x & y
+  std::uint64_t x_lo = x & 0xffffffff, x_hi = x >> 32;
+  std::uint64_t y_lo = y & 0xffffffff, y_hi = y >> 32;
+
+  std::uint64_t lo_lo = x_lo * y_lo;
+  std::uint64_t hi_lo = x_hi * y_lo;
+  std::uint64_t lo_hi = x_lo * y_hi;
+  std::uint64_t hi_hi = x_hi * y_hi;
+
+  std::uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+
+  return hi_hi + (hi_lo >> 32) + (middle >> 32);
+#endif
+}
+
+
+// returns the quotient of the double word (hi, 0) and d, where hi < d
+__AGENCY_ANNOTATION
+inline std::uint32_t divide_shifted_word(std::uint32_t hi, std::uint32_t d)
+{
+  return static_cast<std::uint32_t>((static_cast<std::uint64_t>(hi) << 32) / d);
+}
+
+__AGENCY_ANNOTATION
+inline std::uint64_t divide_shifted_word(std::uint64_t hi, std::uint64_t d)
+{
+#if !defined(__CUDA_ARCH__) && defined(__SIZEOF_INT128__)
+  return static_cast<std::uint64_t>((static_cast<unsigned __int128>(hi) << 64) / d);
+#else
+  // this is only computed once per divisor, so a simple shift-and-subtract loop suffices
+  const std::uint64_t high_bit = std::uint64_t(1) << 63;
+
+  std::uint64_t remainder = hi;
+  std::uint64_t quotient = 0;
+
+  for(int i = 0; i < 64; ++i)
+  {
+    bool carry = (remainder & high_bit) != 0;
+
+    remainder <<= 1;
+    quotient <<= 1;
+
+    if(carry || remainder >= d)
+    {
+      remainder -= d;
+      quotient |= 1;
+    }
+  }
+
+  return quotient;
+#endif
+}
+
+
+} // end fast_divisor_detail
+
+
+// a fast_divisor divides non-negative integers by a divisor fixed at construction with a multiply, an add, and two shifts
+// rather than a hardware division, which is several times slower
+// it is constructed once per launch from an element of a shape, and then divides the index of each agent of the launch
+//
+// see Granlund & Montgomery, "Division by Invariant Integers using Multiplication", PLDI 1994, Figure 4.1
+//
+// a fast_divisor converts to its divisor, so it may stand in for the element of the shape it was constructed from
+template<class Integer>
+class fast_divisor
+{
+  private:
+    using word_type = fast_divisor_detail::word_t<Integer>;
+
+    static constexpr int num_bits = 8 * sizeof(word_type);
+
+  public:
+    __AGENCY_ANNOTATION
+    fast_divisor()
+      : fast_divisor(Integer(1))
+    {}
+
+    __AGENCY_ANNOTATION
+    fast_divisor(Integer divisor)
+      : divisor_(divisor),
+        multiplier_(0),
+        shift1_(0),
+        shift2_(0)
+    {
+      // an empty shape is never divided by
+      if(divisor <= Integer(0)) return;
+
+      word_type d = static_cast<word_type>(divisor);
+
+      // the smallest log such that d <= 2^log
+      int log = 0;
+      while(log < num_bits && (word_type(1) << log) < d)
+      {
+        ++log;
+      }
+
+      // 2^log - d, computed modulo 2^num_bits
+      word_type difference = (log == num_bits ? word_type(0) : (word_type(1) << log)) - d;
+
+      multiplier_ = fast_divisor_detail::divide_shifted_word(difference, d) + 1;
+      shift1_ = log < 1 ? log : 1;
+      shift2_ = log < 1 ? 0 : log - 1;
+    }
+
+    __AGENCY_ANNOTATION
+    Integer divisor() const
+    {
+      return divisor_;
+    }
+
+    __AGENCY_ANNOTATION
+    operator Integer () const
+    {
+      return divisor_;
+    }
+
+    // n must be non-negative
+    template<class T>
+    __AGENCY_ANNOTATION
+    T divide(const T& n) const
+    {
+      return divide(n, std::integral_constant<bool, (sizeof(T) <= sizeof(word_type))>());
+    }
+
+    // n must be non-negative
+    template<class T>
+    __AGENCY_ANNOTATION
+    T modulus(const T& n) const
+    {
+      return n - divide(n) * static_cast<T>(divisor_);
+    }
+
+  private:
+    // n fits in a word
+    template<class T>
+    __AGENCY_ANNOTATION
+    T divide(const T& n, std::true_type) const
+    {
+      word_type w = static_cast<word_type>(n);
+      word_type t = fast_divisor_detail::mulhi(multiplier_, w);
+
+      return static_cast<T>((t + ((w - t) >> shift1_)) >> shift2_);
+    }
+
+    // n is wider than a word, so this fast_divisor's multiplier does not apply
+    template<class T>
+    __AGENCY_ANNOTATION
+    T divide(const T& n, std::false_type) const
+    {
+      return n / static_cast<T>(divisor_);
+    }
+
+    Integer divisor_;
+    word_type multiplier_;
+    int shift1_;
+    int shift2_;
+};
+
+
+template<class T, class Integer,
+         class = typename std::enable_if<std::is_integral<T>::value>::type>
+__AGENCY_ANNOTATION
+T operator/(const T& n, const fast_divisor<Integer>& d)
+{
+  return d.divide(n);
+}
+
+
+template<class T, class Integer,
+         class = typename std::enable_if<std::is_integral<T>::value>::type>
+__AGENCY_ANNOTATION
+T operator%(const T& n, const fast_divisor<Integer>& d)
+{
+  return d.modulus(n);
+}
+
+
+template<class T, class Integer,
+         class = typename std::enable_if<std::is_integral<T>::value>::type>
+__AGENCY_ANNOTATION
+T& operator/=(T& n, const fast_divisor<Integer>& d)
+{
+  n = d.divide(n);
+  return n;
+}
+
+
+template<class T, class Integer,
+         class = typename std::enable_if<std::is_integral<T>::value>::type>
+__AGENCY_ANNOTATION
+T& operator%=(T& n, const fast_divisor<Integer>& d)
+{
+  n = d.modulus(n);
+  return n;
+}
+
+
+// make_fast_shape() replaces each integral element of a shape with a fast_divisor
+// index_cast() divides by the elements of the shape it casts to, so casting to a fast shape
+// replaces those divisions with multiplications
+template<class Shape, class Enable = void>
+struct fast_shape_impl
+{
+  using type = Shape;
+
+  __AGENCY_ANNOTATION
+  static type make(const Shape& shape)
+  {
+    return shape;
+  }
+};
+
+
+struct make_fast_shape_functor
+{
+  template<class Shape>
+  __AGENCY_ANNOTATION
+  typename fast_shape_impl<Shape>::type operator()(const Shape& shape) const
+  {
+    return fast_shape_impl<Shape>::make(shape);
+  }
+};
+
+
+template<class Shape>
+struct fast_shape_impl<Shape, typename std::enable_if<std::is_integral<Shape>::value>::type>
+{
+  using type = fast_divisor<Shape>;
+
+  __AGENCY_ANNOTATION
+  static type make(const Shape& shape)
+  {
+    return type(shape);
+  }
+};
+
+
+template<class Shape>
+struct fast_shape_impl<Shape, typename std::enable_if<is_tuple<Shape>::value>::type>
+{
+  using type = decltype(detail::tuple_map(make_fast_shape_functor(), std::declval<const Shape&>()));
+
+  __AGENCY_ANNOTATION
+  static type make(const Shape& shape)
+  {
+    return detail::tuple_map(make_fast_shape_functor(), shape);
+  }
+};
+
+
+template<class Shape>
+using fast_shape_t = typename fast_shape_impl<Shape>::type;
+
+
+template<class Shape>
+__AGENCY_ANNOTATION
+fast_shape_t<Shape> make_fast_shape(const Shape& shape)
+{
+  return fast_shape_impl<Shape>::make(shape);
+}
+
+
+} // end detail
+} // end agency
+
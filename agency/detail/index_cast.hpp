@@ -177,7 +177,7 @@ __AGENCY_ANNOTATION
 typename std::enable_if<
   (index_size<FromIndex>::value == index_size<ToIndex>::value) &&
   (index_size<FromIndex>::value == 1),
-  ToShape
+  ToIndex
 >::type
   index_cast(const FromIndex& from_idx, const FromShape& from_shape, const ToShape& to_shape);
 
@@ -228,7 +228,7 @@ __AGENCY_ANNOTATION
 typename std::enable_if<
   (index_size<FromIndex>::value == index_size<ToIndex>::value) &&
   (index_size<FromIndex>::value == 1),
-  ToShape
+  ToIndex
 >::type
   index_cast(const FromIndex& from_idx, const FromShape&, const ToShape&)
 {
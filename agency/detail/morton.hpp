@@ -0,0 +1,188 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/coordinate.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+#include <immintrin.h>
+#endif
+
+namespace agency
+{
+namespace detail
+{
+
+
+// morton_spread<rank>(x) inserts rank - 1 zero bits between each of the low bits of x
+// morton_compact<rank>(x) is its inverse, gathering every rank-th bit of x into its low bits
+//
+// the Morton (Z-order) code of a point interleaves the bits of its coordinates,
+// so that points whose codes are close together are close together in space
+
+
+// rank 1 is the identity
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 1, std::uint64_t>::type
+  morton_spread(std::uint64_t x)
+{
+  return x;
+}
+
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 1, std::uint64_t>::type
+  morton_compact(std::uint64_t x)
+{
+  return x;
+}
+
+
+// rank 2 spreads the low 32 bits of x into the even bits of the result
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 2, std::uint64_t>::type
+  morton_spread(std::uint64_t x)
+{
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+  return _pdep_u64(x, 0x5555555555555555ull);
+#else
+  x &= 0x00000000ffffffffull;
+  x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+  x = (x | (x <<  8)) & 0x00ff00ff00ff00ffull;
+  x = (x | (x <<  4)) & 0x0f0f0f0f0f0f0f0full;
+  x = (x | (x <<  2)) & 0x3333333333333333ull;
+  x = (x | (x <<  1)) & 0x5555555555555555ull;
+  return x;
+#endif
+}
+
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 2, std::uint64_t>::type
+  morton_compact(std::uint64_t x)
+{
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+  return _pext_u64(x, 0x5555555555555555ull);
+#else
+  x &= 0x5555555555555555ull;
+  x = (x | (x >>  1)) & 0x3333333333333333ull;
+  x = (x | (x >>  2)) & 0x0f0f0f0f0f0f0f0full;
+  x = (x | (x >>  4)) & 0x00ff00ff00ff00ffull;
+  x = (x | (x >>  8)) & 0x0000ffff0000ffffull;
+  x = (x | (x >> 16)) & 0x00000000ffffffffull;
+  return x;
+#endif
+}
+
+
+// rank 3 spreads the low 21 bits of x into every third bit of the result
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 3, std::uint64_t>::type
+  morton_spread(std::uint64_t x)
+{
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+  return _pdep_u64(x, 0x1249249249249249ull);
+#else
+  x &= 0x00000000001fffffull;
+  x = (x | (x << 32)) & 0x001f00000000ffffull;
+  x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+  x = (x | (x <<  8)) & 0x100f00f00f00f00full;
+  x = (x | (x <<  4)) & 0x10c30c30c30c30c3ull;
+  x = (x | (x <<  2)) & 0x1249249249249249ull;
+  return x;
+#endif
+}
+
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<rank == 3, std::uint64_t>::type
+  morton_compact(std::uint64_t x)
+{
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+  return _pext_u64(x, 0x1249249249249249ull);
+#else
+  x &= 0x1249249249249249ull;
+  x = (x | (x >>  2)) & 0x10c30c30c30c30c3ull;
+  x = (x | (x >>  4)) & 0x100f00f00f00f00full;
+  x = (x | (x >>  8)) & 0x001f0000ff0000ffull;
+  x = (x | (x >> 16)) & 0x001f00000000ffffull;
+  x = (x | (x >> 32)) & 0x00000000001fffffull;
+  return x;
+#endif
+}
+
+
+// higher ranks move one bit at a time
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<(rank > 3), std::uint64_t>::type
+  morton_spread(std::uint64_t x)
+{
+  std::uint64_t result = 0;
+
+  for(std::size_t bit = 0; bit * rank < 64; ++bit)
+  {
+    result |= ((x >> bit) & 1) << (bit * rank);
+  }
+
+  return result;
+}
+
+template<std::size_t rank>
+__AGENCY_ANNOTATION
+typename std::enable_if<(rank > 3), std::uint64_t>::type
+  morton_compact(std::uint64_t x)
+{
+  std::uint64_t result = 0;
+
+  for(std::size_t bit = 0; bit * rank < 64; ++bit)
+  {
+    result |= ((x >> (bit * rank)) & 1) << bit;
+  }
+
+  return result;
+}
+
+
+// returns the Morton code of p
+// the last dimension of p, which varies fastest in lexicographic order, occupies the least significant bit of each group
+template<class T, std::size_t rank>
+__AGENCY_ANNOTATION
+std::uint64_t morton_encode(const point<T,rank>& p)
+{
+  std::uint64_t result = 0;
+
+  for(std::size_t d = 0; d < rank; ++d)
+  {
+    result |= detail::morton_spread<rank>(static_cast<std::uint64_t>(p[d])) << (rank - 1 - d);
+  }
+
+  return result;
+}
+
+
+// returns the point whose Morton code is code
+template<class Point>
+__AGENCY_ANNOTATION
+Point morton_decode(std::uint64_t code)
+{
+  constexpr std::size_t rank = index_size<Point>::value;
+
+  Point result;
+
+  for(std::size_t d = 0; d < rank; ++d)
+  {
+    result[d] = static_cast<typename Point::value_type>(detail::morton_compact<rank>(code >> (rank - 1 - d)));
+  }
+
+  return result;
+}
+
+
+} // end detail
+} // end agency
+
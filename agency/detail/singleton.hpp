@@ -1,7 +1,11 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+
+// terminate_with_message() is only needed by __device__ code
+#ifdef __CUDACC__
 #include <agency/cuda/detail/terminate.hpp>
+#endif
 
 
 namespace agency
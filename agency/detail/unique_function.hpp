@@ -1,12 +1,16 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/memory/detail/unique_ptr.hpp>
+#include <agency/memory/allocator/detail/allocator_adaptor.hpp>
+#include <agency/memory/detail/resource/thread_caching_resource.hpp>
 #include <stdexcept>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <utility>
 #include <type_traits>
 #include <memory>
+#include <new>
 
 
 namespace agency
@@ -41,33 +45,61 @@ inline void throw_bad_function_call()
 }
 
 
+// by default, unique_function stores callables of up to this many bytes inline, without allocating
+// this is enough for an index plus a few references
+constexpr std::size_t default_inline_size = 4 * sizeof(void*);
+
+
+// callables too large to be stored inline are allocated from a per-thread cache of blocks by default
+template<class T>
+using pooled_allocator = allocator_adaptor<T, thread_caching_resource>;
+
+
 } // end unique_function_detail
 
 
-template<class>
+template<class Signature, std::size_t InlineSize = unique_function_detail::default_inline_size>
 class unique_function;
 
-template<class Result, class... Args>
-class unique_function<Result(Args...)>
+// unique_function is a move-only, type-erased function wrapper
+//
+// callables which fit within InlineSize bytes and may be moved without throwing are stored inline
+// larger callables are stored in a block obtained from an allocator, by default
+// from thread_caching_resource
+//
+// moving a unique_function whose callable is stored in a block, or whose inline callable
+// is trivially copyable, relocates its storage with memcpy
+template<class Result, class... Args, std::size_t InlineSize>
+class unique_function<Result(Args...), InlineSize>
 {
   public:
     using result_type = Result;
 
     __AGENCY_ANNOTATION
-    unique_function() = default;
+    unique_function()
+      : invoke_(nullptr),
+        manage_(nullptr)
+    {}
 
     __AGENCY_ANNOTATION
     unique_function(std::nullptr_t)
-      : f_ptr_(nullptr)
+      : unique_function()
     {}
 
     __AGENCY_ANNOTATION
-    unique_function(unique_function&& other) = default;
+    unique_function(unique_function&& other)
+      : unique_function()
+    {
+      move_from(other);
+    }
 
-    template<class Function>
+    template<class Function,
+             class = typename std::enable_if<
+               !std::is_same<typename std::decay<Function>::type, unique_function>::value
+             >::type>
     __AGENCY_ANNOTATION
     unique_function(Function&& f)
-      : unique_function(std::allocator_arg, default_allocator<typename std::decay<Function>::type>{}, std::forward<Function>(f))
+      : unique_function(std::allocator_arg, unique_function_detail::pooled_allocator<typename std::decay<Function>::type>(), std::forward<Function>(f))
     {}
 
     template<class Alloc>
@@ -85,17 +117,44 @@ class unique_function<Result(Args...)>
     template<class Alloc>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc&, unique_function&& other)
-      : f_ptr_(std::move(other.f_ptr_))
+      : unique_function(std::move(other))
     {}
 
-    template<class Alloc, class Function>
+    template<class Alloc, class Function,
+             class = typename std::enable_if<
+               !std::is_same<typename std::decay<Function>::type, unique_function>::value
+             >::type>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc& alloc, Function&& f)
-      : f_ptr_(allocate_function_pointer(alloc, std::forward<Function>(f)))
-    {}
+      : unique_function()
+    {
+      emplace(is_stored_inline<typename std::decay<Function>::type>(), alloc, std::forward<Function>(f));
+    }
+
+    __AGENCY_ANNOTATION
+    ~unique_function()
+    {
+      reset();
+    }
 
     __AGENCY_ANNOTATION
-    unique_function& operator=(unique_function&& other) = default;
+    unique_function& operator=(unique_function&& other)
+    {
+      if(this != &other)
+      {
+        reset();
+        move_from(other);
+      }
+
+      return *this;
+    }
+
+    __AGENCY_ANNOTATION
+    unique_function& operator=(std::nullptr_t)
+    {
+      reset();
+      return *this;
+    }
 
     __AGENCY_ANNOTATION
     Result operator()(Args... args) const
@@ -105,148 +164,217 @@ class unique_function<Result(Args...)>
         unique_function_detail::throw_bad_function_call();
       }
 
-      return (*f_ptr_)(args...);
+      return invoke_(storage_, args...);
     }
 
     __AGENCY_ANNOTATION
     operator bool () const
     {
-      return f_ptr_;
+      return invoke_ != nullptr;
     }
 
   private:
-    // this is the abstract base class for a type
-    // which is both
-    // 1. callable like a function and
-    // 2. deallocates itself inside its destructor
-    struct callable_self_deallocator_base
-    {
-      using self_deallocate_function_type = void(*)(callable_self_deallocator_base*);
+    static constexpr std::size_t storage_size = InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize;
 
-      self_deallocate_function_type self_deallocate_function;
+    using storage_type = typename std::aligned_storage<storage_size>::type;
 
-      template<class Function>
-      __AGENCY_ANNOTATION
-      callable_self_deallocator_base(Function callback)
-        : self_deallocate_function(callback)
-      {}
-
-      __AGENCY_ANNOTATION
-      virtual ~callable_self_deallocator_base()
-      {
-        self_deallocate_function(this);
-      }
+    enum operation
+    {
+      // move-construct the callable in dst from the callable in src and destroy the callable in src
+      relocate_operation,
 
-      __AGENCY_ANNOTATION
-      virtual Result operator()(Args... args) const = 0;
+      // destroy the callable in dst
+      destroy_operation
     };
 
+    using invoke_function_type = Result(*)(storage_type&, Args...);
+
+    // manage_ is null when the stored object may be relocated with memcpy and needs no destruction
+    using manage_function_type = void(*)(operation, storage_type& dst, storage_type& src);
+
+    template<class Function>
+    using is_stored_inline = std::integral_constant<
+      bool,
+      sizeof(Function) <= InlineSize &&
+      alignof(Function) <= alignof(storage_type) &&
+      std::is_nothrow_move_constructible<Function>::value
+    >;
+
+    // a callable stored out of line, along with a copy of the allocator which allocated it
     template<class Function, class Alloc>
-    struct callable : callable_self_deallocator_base
+    struct block
     {
-      using super_t = callable_self_deallocator_base;
-      using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<callable>;
+      using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<block>;
 
-      mutable Function f_;
+      allocator_type alloc_;
+      Function f_;
 
       __agency_exec_check_disable__
+      template<class OtherFunction>
       __AGENCY_ANNOTATION
-      ~callable() = default;
-
-      __agency_exec_check_disable__
-      template<class OtherFunction,
-               class = typename std::enable_if<
-                 std::is_constructible<Function,OtherFunction&&>::value
-               >::type>
-      __AGENCY_ANNOTATION
-      callable(const Alloc&, OtherFunction&& f)
-        : super_t(deallocate),
+      block(const Alloc& alloc, OtherFunction&& f)
+        : alloc_(alloc),
           f_(std::forward<OtherFunction>(f))
       {}
+    };
 
-      __agency_exec_check_disable__
-      __AGENCY_ANNOTATION
-      virtual Result operator()(Args... args) const
-      {
-        return f_(args...);
-      }
+    template<class Function>
+    __AGENCY_ANNOTATION
+    static Function& inline_callable(storage_type& storage)
+    {
+      return *reinterpret_cast<Function*>(&storage);
+    }
 
-      __agency_exec_check_disable__
-      __AGENCY_ANNOTATION
-      static void deallocate(callable_self_deallocator_base* ptr)
-      {
-        // upcast to the right type of pointer
-        callable* self = static_cast<callable*>(ptr);
+    template<class Block>
+    __AGENCY_ANNOTATION
+    static Block*& block_pointer(storage_type& storage)
+    {
+      return *reinterpret_cast<Block**>(&storage);
+    }
 
-        // XXX seems like creating a new allocator here is cheating
-        //     we should use some member allocator, but it's not clear where to put it
-        allocator_type alloc_;
-        alloc_.deallocate(self, 1);
-      }
-    };
+    __agency_exec_check_disable__
+    template<class Function>
+    __AGENCY_ANNOTATION
+    static Result invoke_inline(storage_type& storage, Args... args)
+    {
+      return inline_callable<Function>(storage)(args...);
+    }
 
-    // this deleter calls the destructor of its argument but does not
-    // deallocate the ptr
-    // T will deallocate itself inside ~T()
-    struct self_deallocator_deleter
+    __agency_exec_check_disable__
+    template<class Block>
+    __AGENCY_ANNOTATION
+    static Result invoke_block(storage_type& storage, Args... args)
     {
-      template<class T>
-      __AGENCY_ANNOTATION
-      void operator()(T* ptr) const
+      return block_pointer<Block>(storage)->f_(args...);
+    }
+
+    __agency_exec_check_disable__
+    template<class Function>
+    __AGENCY_ANNOTATION
+    static void manage_inline(operation op, storage_type& dst, storage_type& src)
+    {
+      switch(op)
       {
-        ptr->~T();
+        case relocate_operation:
+        {
+          ::new(&dst) Function(std::move(inline_callable<Function>(src)));
+          inline_callable<Function>(src).~Function();
+          break;
+        }
+
+        case destroy_operation:
+        {
+          inline_callable<Function>(dst).~Function();
+          break;
+        }
       }
-    };
+    }
 
-    using function_pointer = detail::unique_ptr<callable_self_deallocator_base, self_deallocator_deleter>;
+    __agency_exec_check_disable__
+    template<class Block>
+    __AGENCY_ANNOTATION
+    static void manage_block(operation op, storage_type& dst, storage_type& src)
+    {
+      switch(op)
+      {
+        case relocate_operation:
+        {
+          block_pointer<Block>(dst) = block_pointer<Block>(src);
+          break;
+        }
+
+        case destroy_operation:
+        {
+          Block* ptr = block_pointer<Block>(dst);
+
+          // copy the allocator out of the block before destroying it
+          typename Block::allocator_type alloc = ptr->alloc_;
+          ptr->~Block();
+          alloc.deallocate(ptr, 1);
+          break;
+        }
+      }
+    }
 
+    __agency_exec_check_disable__
     template<class Alloc, class Function>
     __AGENCY_ANNOTATION
-    static function_pointer allocate_function_pointer(const Alloc& alloc, Function&& f)
+    void emplace(std::true_type, const Alloc&, Function&& f)
     {
-      using concrete_function_type = callable<typename std::decay<Function>::type, Alloc>;
-      return agency::detail::allocate_unique_with_deleter<concrete_function_type>(alloc, self_deallocator_deleter(), alloc, std::forward<Function>(f));
+      using function_type = typename std::decay<Function>::type;
+
+      ::new(&storage_) function_type(std::forward<Function>(f));
+
+      invoke_ = &invoke_inline<function_type>;
+
+      // trivially copyable callables need no help to relocate or be destroyed
+      manage_ = std::is_trivially_copyable<function_type>::value ? nullptr : &manage_inline<function_type>;
     }
 
-    template<class T>
-    struct default_allocator
+    __agency_exec_check_disable__
+    template<class Alloc, class Function>
+    __AGENCY_ANNOTATION
+    void emplace(std::false_type, const Alloc& alloc, Function&& f)
     {
-      using value_type = T;
+      using block_type = block<typename std::decay<Function>::type, Alloc>;
 
-      __AGENCY_ANNOTATION
-      default_allocator() = default;
+      typename block_type::allocator_type block_alloc = alloc;
+      block_type* ptr = block_alloc.allocate(1);
 
-      __AGENCY_ANNOTATION
-      default_allocator(const default_allocator&) = default;
+#ifndef __CUDA_ARCH__
+      try
+      {
+        ::new(ptr) block_type(alloc, std::forward<Function>(f));
+      }
+      catch(...)
+      {
+        block_alloc.deallocate(ptr, 1);
+        throw;
+      }
+#else
+      ::new(ptr) block_type(alloc, std::forward<Function>(f));
+#endif
 
-      template<class U>
-      __AGENCY_ANNOTATION
-      default_allocator(const default_allocator<U>&) {}
+      block_pointer<block_type>(storage_) = ptr;
 
-      // XXX we have to implement this member function superfluously because
-      //     agency::detail::allocate_unique calls it directly instead of using std::allocator_traits
-      template<class U, class... OtherArgs>
-      __AGENCY_ANNOTATION
-      void construct(U* ptr, OtherArgs&&... args)
+      invoke_ = &invoke_block<block_type>;
+      manage_ = &manage_block<block_type>;
+    }
+
+    __AGENCY_ANNOTATION
+    void move_from(unique_function& other)
+    {
+      if(other.manage_)
       {
-        ::new(ptr) U(std::forward<OtherArgs>(args)...);
+        other.manage_(relocate_operation, storage_, other.storage_);
       }
-
-      value_type* allocate(size_t n)
+      else
       {
-        std::allocator<T> alloc;
-        return alloc.allocate(n);
+        memcpy(&storage_, &other.storage_, sizeof(storage_type));
       }
 
-      void deallocate(value_type* ptr, std::size_t n)
+      invoke_ = other.invoke_;
+      manage_ = other.manage_;
+
+      other.invoke_ = nullptr;
+      other.manage_ = nullptr;
+    }
+
+    __AGENCY_ANNOTATION
+    void reset()
+    {
+      if(manage_)
       {
-        std::allocator<value_type> alloc;
-        alloc.deallocate(ptr, n);
+        manage_(destroy_operation, storage_, storage_);
       }
-    };
 
+      invoke_ = nullptr;
+      manage_ = nullptr;
+    }
 
-    function_pointer f_ptr_; 
+    mutable storage_type storage_;
+    invoke_function_type invoke_;
+    manage_function_type manage_;
 };
 
 
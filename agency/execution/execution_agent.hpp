@@ -11,8 +11,7 @@
 #include <agency/detail/unwrap_tuple_if_not_scoped.hpp>
 #include <agency/detail/make_tuple_if_not_scoped.hpp>
 #include <agency/memory/detail/resource/arena_resource.hpp>
-#include <agency/memory/detail/resource/malloc_resource.hpp>
-#include <agency/memory/detail/resource/tiered_resource.hpp>
+#include <agency/memory/detail/resource/chunked_arena_resource.hpp>
 #include <agency/coordinate.hpp>
 #include <agency/experimental/array.hpp>
 #include <agency/experimental/optional.hpp>
@@ -354,7 +353,59 @@ namespace detail
 
 
 
-template<class Index, class MemoryResource>
+// arrive_and_wait_with_rank() passes the calling agent's rank to barriers which require it
+template<class Barrier>
+using barrier_arrive_and_wait_with_rank_t = decltype(std::declval<Barrier&>().arrive_and_wait(std::declval<size_t>()));
+
+template<class Barrier,
+         __AGENCY_REQUIRES(
+           is_detected<barrier_arrive_and_wait_with_rank_t, Barrier>::value
+         )>
+void arrive_and_wait_with_rank(Barrier& barrier, size_t rank)
+{
+  barrier.arrive_and_wait(rank);
+}
+
+template<class Barrier,
+         __AGENCY_REQUIRES(
+           !is_detected<barrier_arrive_and_wait_with_rank_t, Barrier>::value
+         )>
+void arrive_and_wait_with_rank(Barrier& barrier, size_t)
+{
+  barrier.arrive_and_wait();
+}
+
+
+// reserve_if_possible() preallocates num_bytes from memory resources which are able to reserve storage in advance
+template<class MemoryResource>
+using memory_resource_reserve_t = decltype(std::declval<MemoryResource&>().reserve(std::declval<size_t>()));
+
+template<class MemoryResource,
+         __AGENCY_REQUIRES(
+           is_detected<memory_resource_reserve_t, MemoryResource>::value
+         )>
+__AGENCY_ANNOTATION
+void reserve_if_possible(MemoryResource& resource, size_t num_bytes)
+{
+  if(num_bytes > 0)
+  {
+    resource.reserve(num_bytes);
+  }
+}
+
+template<class MemoryResource,
+         __AGENCY_REQUIRES(
+           !is_detected<memory_resource_reserve_t, MemoryResource>::value
+         )>
+__AGENCY_ANNOTATION
+void reserve_if_possible(MemoryResource&, size_t)
+{
+}
+
+
+// the Barrier parameter selects the type of barrier which implements wait() in C++
+// in CUDA C++, wait() is always implemented with __syncthreads()
+template<class Index, class MemoryResource, class Barrier = agency::detail::barrier>
 class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_execution_tag, Index>
 {
   private:
@@ -363,7 +414,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
     static constexpr size_t broadcast_channel_size = sizeof(void*);
     using broadcast_channel_type = agency::experimental::array<char, broadcast_channel_size>;
 
-    // this class hides agency::detail::barrier & __syncthreads()
+    // this class hides Barrier & __syncthreads()
     // behind a uniform interface so that we can use basic_concurrent_agent
     // in both C++ and CUDA C++
     class barrier
@@ -377,10 +428,10 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
         {}
 
         __AGENCY_ANNOTATION
-        void arrive_and_wait()
+        void arrive_and_wait(size_t rank)
         {
 #ifndef __CUDA_ARCH__
-          barrier_.arrive_and_wait();
+          agency::detail::arrive_and_wait_with_rank(barrier_, rank);
 #else
           __syncthreads();
 #endif
@@ -388,7 +439,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
 
 #ifndef __CUDA_ARCH__
       private:
-        agency::detail::barrier barrier_;
+        Barrier barrier_;
 #endif
     };
 
@@ -478,12 +529,12 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
 
       // reinterpret the broadcast channel into a pointer
       static_assert(sizeof(broadcast_channel_) >= sizeof(T*), "broadcast channel is too small to accomodate T*");
-      T* shared_temporary_object = reinterpret_cast<T*>(&broadcast_channel_);
+      T*& shared_temporary_object = *reinterpret_cast<T**>(broadcast_channel_.data());
 
       if(value)
       {
         // dynamically allocate the shared temporary object
-        shared_temporary_object = memory_resource().allocate<alignof(T)>(sizeof(T));
+        shared_temporary_object = reinterpret_cast<T*>(memory_resource().allocate(sizeof(T)));
 
         // copy construct the shared temporary
         ::new(shared_temporary_object) T(*value);
@@ -504,7 +555,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
         shared_temporary_object->~T();
 
         // deallocate the temporary storage
-        memory_resource().deallocate(shared_temporary_object);
+        memory_resource().deallocate(shared_temporary_object, sizeof(T));
       }
 
       // all agents wait for the broadcast channel and memory resource to become ready again
@@ -517,7 +568,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
     __AGENCY_ANNOTATION
     void wait() const
     {
-      barrier_.arrive_and_wait();
+      barrier_.arrive_and_wait(this->rank());
     }
 
     template<class T>
@@ -535,15 +586,70 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
       return memory_resource_;
     }
 
+    // in addition to the group's domain, param_type carries a hint of the number of bytes
+    // the group will allocate from its memory resource, e.g. through shared<T> & shared_vector<T>
+    class param_type : public super_t::param_type
+    {
+      private:
+        using super_param_type = typename super_t::param_type;
+
+      public:
+        // note that the default constructor is constexpr so that execution policies may remain constexpr
+        // the base is value-initialized, which zeroes its domain without requiring a constexpr constructor of it
+        __AGENCY_ANNOTATION
+        constexpr param_type()
+          : super_param_type()
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const param_type&) = default;
+
+        __AGENCY_ANNOTATION
+        param_type(const typename super_t::domain_type& d)
+          : param_type(super_param_type(d))
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const typename super_t::index_type& min, const typename super_t::index_type& max)
+          : param_type(super_param_type(min, max))
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const super_param_type& other, size_t shared_memory_size = 0)
+          : super_param_type(other),
+            shared_memory_size_(shared_memory_size)
+        {}
+
+        __AGENCY_ANNOTATION
+        size_t shared_memory_size() const
+        {
+          return shared_memory_size_;
+        }
+
+        // returns a copy of this param_type whose groups preallocate num_bytes from their memory resource
+        __AGENCY_ANNOTATION
+        param_type with_shared_memory(size_t num_bytes) const
+        {
+          return param_type(*this, num_bytes);
+        }
+
+      private:
+        size_t shared_memory_size_ = 0;
+    };
+
     struct shared_param_type
     {
       __AGENCY_ANNOTATION
-      shared_param_type(const typename super_t::param_type& param)
+      shared_param_type(const param_type& param)
         : barrier_(param.domain().size()),
           memory_resource_(),
-          count_(param.domain().size())
+          count_(param.domain().size()),
+          shared_memory_size_(param.shared_memory_size())
       {
         // note we specifically avoid default constructing broadcast_channel_
+
+        // preallocate the group's storage once so that the agents' allocations are simple pointer bumps
+        detail::reserve_if_possible(memory_resource_, shared_memory_size_);
       }
 
       // XXX see if we can eliminate this copy constructor
@@ -552,8 +658,11 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
       shared_param_type(const shared_param_type& other)
         : barrier_(other.count_),
           memory_resource_(),
-          count_(other.count_)
-      {}
+          count_(other.count_),
+          shared_memory_size_(other.shared_memory_size_)
+      {
+        detail::reserve_if_possible(memory_resource_, shared_memory_size_);
+      }
 
       // broadcast_channel_ needs to be the first member to ensure proper alignment because we reinterpret it to arbitrary T*
       // XXX is there a more comprehensive way to ensure that this member falls on the right address?
@@ -561,6 +670,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
       barrier barrier_;
       memory_resource_type memory_resource_;
       int count_;
+      size_t shared_memory_size_;
     };
 
   private:
@@ -570,7 +680,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
 
   protected:
     __AGENCY_ANNOTATION
-    basic_concurrent_agent(const typename super_t::index_type& index, const typename super_t::param_type& param, shared_param_type& shared_param)
+    basic_concurrent_agent(const typename super_t::index_type& index, const param_type& param, shared_param_type& shared_param)
       : super_t(index, param),
         barrier_(shared_param.barrier_),
         broadcast_channel_(shared_param.broadcast_channel_),
@@ -585,7 +695,9 @@ class basic_concurrent_agent : public detail::basic_execution_agent<concurrent_e
 } // end detail
 
 
-using default_concurrent_resource = detail::tiered_resource<detail::arena_resource<sizeof(int) * 128>, detail::malloc_resource>;
+// each group of concurrent agents allocates from an arena which begins inside the group's shared parameter
+// and grows through chunks recycled across launches
+using default_concurrent_resource = detail::chunked_arena_resource<sizeof(int) * 128, detail::arena_chunk_resource>;
 
 
 // XXX consider introducing unique types for concurrent_agent & concurrent_agent_2d for the sake of better compiler error messages
@@ -383,6 +383,37 @@ class basic_execution_policy
       return derived_type{param_type{std::move(arg1), std::move(args)...}, executor()};
     }
 
+    /// \brief Hints the number of bytes each group of agents will allocate collectively.
+    ///
+    ///
+    /// `with_shared_memory()` returns a new execution policy identical to `*this` but whose groups of agents
+    /// preallocate `num_bytes` from their memory resource once, before any agent begins executing. Collective allocations
+    /// such as `shared<T>` and `shared_vector<T>` which fit within these bytes do not allocate any further storage:
+    ///
+    /// ~~~~{.cpp}
+    /// agency::bulk_invoke(agency::con(256).with_shared_memory(64 * 1024), [](agency::concurrent_agent& self)
+    /// {
+    ///   // the storage for this vector was allocated before the group began executing
+    ///   agency::shared_vector<float> scratch(self, 16 * 1024);
+    ///   ...
+    /// });
+    /// ~~~~
+    ///
+    /// \param num_bytes The number of bytes to preallocate for each group of agents.
+    /// \return An execution policy equivalent to `*this` but whose parameterization requests `num_bytes` of shared memory per group.
+    /// \note `with_shared_memory()` only participates in overload resolution when `param_type` has a member function `with_shared_memory()`,
+    ///       as is the case for concurrent execution policies.
+    template<class P = param_type>
+    #ifndef DOXYGEN_SHOULD_SKIP_THIS
+    auto with_shared_memory(std::size_t num_bytes) const ->
+      detail::decay_t<decltype(std::declval<const P&>().with_shared_memory(num_bytes), std::declval<derived_type>())>
+    #else
+    derived_type with_shared_memory(std::size_t num_bytes) const
+    #endif
+    {
+      return derived_type{param().with_shared_memory(num_bytes), executor()};
+    }
+
   protected:
     param_type param_;
 
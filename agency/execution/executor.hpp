@@ -6,6 +6,7 @@
 #include <agency/execution/executor/executor_array.hpp>
 #include <agency/execution/executor/flattened_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/numa_executor.hpp>
 #include <agency/execution/executor/parallel_executor.hpp>
 #include <agency/execution/executor/scoped_executor.hpp>
 #include <agency/execution/executor/sequenced_executor.hpp>
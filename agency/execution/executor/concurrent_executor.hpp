@@ -4,12 +4,18 @@
 #include <agency/execution/execution_categories.hpp>
 #include <agency/detail/invoke.hpp>
 #include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/gang_thread_pool.hpp>
+#include <agency/future/detail/continuation_future.hpp>
 
 #include <thread>
 #include <vector>
 #include <memory>
 #include <algorithm>
 #include <utility>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <exception>
 
 
 namespace agency
@@ -30,8 +36,11 @@ class concurrent_executor
       return hw_concurrency ? hw_concurrency : default_result;
     }
 
+    template<class T>
+    using future = agency::future<T>;
+
     template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<
+    future<
       detail::result_of_t<ResultFactory()>
     >
     bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
@@ -40,8 +49,130 @@ class concurrent_executor
     }
 
   private:
+    // promises are allocated from the calling thread's cache of small blocks, like the states of their futures
+    template<class ResultType>
+    using promise_allocator = detail::allocator_adaptor<detail::continuation_promise<ResultType>, detail::thread_caching_resource>;
+
+    // the result of a gang, along with the first exception thrown by one of its agents
+    template<class ResultType>
+    struct gang_result
+    {
+      ResultType         value;
+      std::atomic<bool>  has_exception;
+      std::exception_ptr exception;
+
+      explicit gang_result(ResultType&& result)
+        : value(std::move(result)),
+          has_exception(false)
+      {}
+
+      // called by an agent from within a catch block
+      // the exceptions of agents after the first are discarded
+      void capture_current_exception()
+      {
+        if(!has_exception.exchange(true, std::memory_order_relaxed))
+        {
+          exception = std::current_exception();
+        }
+      }
+    };
+
+    // this deleter fulfills a promise just before
+    // it deletes its argument
+    template<class ResultType>
+    struct fulfill_promise_and_delete
+    {
+      std::shared_ptr<detail::continuation_promise<ResultType>> shared_promise_ptr;
+
+      void operator()(gang_result<ResultType>* ptr_to_result)
+      {
+        if(ptr_to_result->exception)
+        {
+          shared_promise_ptr->set_exception(ptr_to_result->exception);
+        }
+        else
+        {
+          // move the result object into the promise
+          shared_promise_ptr->set_value(std::move(ptr_to_result->value));
+        }
+
+        // delete the pointer
+        delete ptr_to_result;
+      }
+    };
+
+    template<class ResultType>
+    static std::shared_ptr<gang_result<ResultType>>
+      make_shared_result(ResultType&& result, const std::shared_ptr<detail::continuation_promise<ResultType>>& shared_promise_ptr)
+    {
+      // create a deleter which fulfills the promise with the result and then deletes the result
+      fulfill_promise_and_delete<ResultType> deleter{shared_promise_ptr};
+
+      // create the shared state for the result
+      // note that we use our special deleter with this state
+      return std::shared_ptr<gang_result<ResultType>>(new gang_result<ResultType>(std::move(result)), std::move(deleter));
+    }
+
+    // calls launch() if the predecessor, which must be ready, holds a value
+    // otherwise, the predecessor's exception is propagated to the result without launching
+    template<class SharedFuture, class ResultType, class Function>
+    static void launch_or_fail(SharedFuture& predecessor, const std::shared_ptr<detail::continuation_promise<ResultType>>& shared_promise_ptr, Function& launch)
+    {
+      try
+      {
+        predecessor.get();
+      }
+      catch(...)
+      {
+        shared_promise_ptr->set_exception(std::current_exception());
+        return;
+      }
+
+      launch();
+    }
+
+    // a std::shared_future cannot accept continuations, so when it is pending,
+    // a thread of the gang thread pool waits for it on the launch's behalf
+    template<class T, class ResultType, class Function>
+    static void launch_when_ready(std::shared_future<T>& predecessor, const std::shared_ptr<detail::continuation_promise<ResultType>>& shared_promise_ptr, Function launch)
+    {
+      if(predecessor.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+        launch_or_fail(predecessor, shared_promise_ptr, launch);
+      }
+      else
+      {
+        detail::system_gang_thread_pool().submit_gang(1, [=](size_t) mutable
+        {
+          launch_or_fail(predecessor, shared_promise_ptr, launch);
+        });
+      }
+    }
+
+    // other kinds of foreign futures are waited on by a thread of the gang thread pool
+    // so that the gang's agents never observe an exceptional predecessor
+    template<class SharedFuture, class ResultType, class Function>
+    static void launch_when_ready(SharedFuture& predecessor, const std::shared_ptr<detail::continuation_promise<ResultType>>& shared_promise_ptr, Function launch)
+    {
+      detail::system_gang_thread_pool().submit_gang(1, [=](size_t) mutable
+      {
+        launch_or_fail(predecessor, shared_promise_ptr, launch);
+      });
+    }
+
+    // when the predecessor is a continuation future, launch from a continuation of the predecessor
+    // so that no thread blocks while the predecessor is pending
+    template<class T, class ResultType, class Function>
+    static void launch_when_ready(detail::shared_continuation_future<T>& predecessor, const std::shared_ptr<detail::continuation_promise<ResultType>>& shared_promise_ptr, Function launch)
+    {
+      predecessor.on_ready([=]() mutable
+      {
+        launch_or_fail(predecessor, shared_promise_ptr, launch);
+      });
+    }
+
     template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
+    future<agency::detail::result_of_t<ResultFactory()>>
       bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
                              typename std::enable_if<
                                !std::is_void<
@@ -49,50 +180,64 @@ class concurrent_executor
                                >::value
                              >::type* = 0)
     {
+      using result_type = agency::detail::result_of_t<ResultFactory()>;
+
       if(n > 0)
       {
         using predecessor_type = typename agency::future_traits<Future>::value_type;
 
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=](predecessor_type& predecessor) mutable
-        {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
+        // create a shared promise to fulfill the result
+        auto shared_promise_ptr = std::allocate_shared<detail::continuation_promise<result_type>>(promise_allocator<result_type>());
+        future<result_type> result_future = shared_promise_ptr->get_future();
 
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
-          {
-            agency::detail::invoke(f, idx, predecessor, result, shared_parameter);
-          };
+        auto shared_predecessor = agency::future_traits<Future>::share(predecessor);
 
-          size_t mid = n / 2;
+        launch_when_ready(shared_predecessor, shared_promise_ptr, [=]() mutable
+        {
+          using shared_arg_type = agency::detail::result_of_t<SharedFactory()>;
+
+          std::shared_ptr<shared_arg_type> shared_arg_ptr;
+          std::shared_ptr<gang_result<result_type>> shared_result_ptr;
 
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
+          try
           {
-            left = this->async_execute(g, 0, mid);
+            shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+            shared_result_ptr = make_shared_result(result_factory(), shared_promise_ptr);
           }
-
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
+          catch(...)
           {
-            right = this->async_execute(g, mid + 1, n);
+            shared_promise_ptr->set_exception(std::current_exception());
+            return;
           }
 
-          g(mid);
-
-          left.wait();
-          right.wait();
-
-          return std::move(result);
+          // launch a gang of n concurrent agents on parked threads
+          detail::system_gang_thread_pool().submit_gang(n, [=](size_t idx) mutable
+          {
+            try
+            {
+              // the predecessor is ready, so this does not block
+              predecessor_type& predecessor_arg = const_cast<predecessor_type&>(shared_predecessor.get());
+
+              agency::detail::invoke(f, idx, predecessor_arg, shared_result_ptr->value, *shared_arg_ptr);
+            }
+            catch(...)
+            {
+              shared_result_ptr->capture_current_exception();
+            }
+
+            // the last agent to release shared_result_ptr fulfills the promise via shared_result_ptr's deleter
+            shared_result_ptr.reset();
+          });
         });
+
+        return result_future;
       }
 
-      return agency::detail::make_ready_future(result_factory());
+      return future<result_type>::make_ready(result_factory());
     }
 
     template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
+    future<agency::detail::result_of_t<ResultFactory()>>
       bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
                              typename std::enable_if<
                                std::is_void<
@@ -100,71 +245,55 @@ class concurrent_executor
                                >::value
                              >::type* = 0)
     {
+      using result_type = agency::detail::result_of_t<ResultFactory()>;
+
       if(n > 0)
       {
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=]() mutable
-        {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
+        // create a shared promise to fulfill the result
+        auto shared_promise_ptr = std::allocate_shared<detail::continuation_promise<result_type>>(promise_allocator<result_type>());
+        future<result_type> result_future = shared_promise_ptr->get_future();
 
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
-          {
-            agency::detail::invoke(f, idx, result, shared_parameter);
-          };
+        auto shared_predecessor = agency::future_traits<Future>::share(predecessor);
 
-          size_t mid = n / 2;
+        launch_when_ready(shared_predecessor, shared_promise_ptr, [=]() mutable
+        {
+          using shared_arg_type = agency::detail::result_of_t<SharedFactory()>;
+
+          std::shared_ptr<shared_arg_type> shared_arg_ptr;
+          std::shared_ptr<gang_result<result_type>> shared_result_ptr;
 
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
+          try
           {
-            left = this->async_execute(g, 0, mid);
+            shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+            shared_result_ptr = make_shared_result(result_factory(), shared_promise_ptr);
           }
-
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
+          catch(...)
           {
-            right = this->async_execute(g, mid + 1, n);
+            shared_promise_ptr->set_exception(std::current_exception());
+            return;
           }
 
-          g(mid);
-
-          left.wait();
-          right.wait();
-
-          return std::move(result);
+          // launch a gang of n concurrent agents on parked threads
+          detail::system_gang_thread_pool().submit_gang(n, [=](size_t idx) mutable
+          {
+            try
+            {
+              agency::detail::invoke(f, idx, shared_result_ptr->value, *shared_arg_ptr);
+            }
+            catch(...)
+            {
+              shared_result_ptr->capture_current_exception();
+            }
+
+            // the last agent to release shared_result_ptr fulfills the promise via shared_result_ptr's deleter
+            shared_result_ptr.reset();
+          });
         });
-      }
-
-      return agency::detail::make_ready_future(result_factory());
-    }
-
-    // first must be less than last
-    template<class Function>
-    std::future<void> async_execute(Function f, size_t first, size_t last)
-    {
-      return std::async(std::launch::async, [=]() mutable
-      {
-        size_t mid = (last + first) / 2;
-
-        std::future<void> left = detail::make_ready_future();
-        if(first < mid)
-        {
-          left = this->async_execute(f, first, mid);
-        }
 
-        std::future<void> right = detail::make_ready_future();
-        if(mid + 1 < last)
-        {
-          right = this->async_execute(f, mid + 1, last);
-        }
-
-        agency::detail::invoke(f,mid);
+        return result_future;
+      }
 
-        left.wait();
-        right.wait();
-      });
+      return future<result_type>::make_ready(result_factory());
     }
 };
 
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/default_shape.hpp>
+#include <agency/detail/fast_divisor.hpp>
+#include <agency/detail/morton.hpp>
+#include <agency/detail/shape.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/customization_points.hpp>
+#include <agency/execution/executor/detail/utility/bulk_continuation_executor_adaptor.hpp>
+#include <agency/execution/execution_agent.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace agency
+{
+namespace experimental
+{
+namespace detail
+{
+
+
+// morton_tiling maps the ranks [0, size) of a shape onto its points
+//
+// the shape is covered by tiles whose sides are 2^tile_log2 points long
+// the tiles are visited in lexicographic order, and the points of each whole tile are visited in Morton order,
+// so that each contiguous range of ranks covers compact tiles rather than thin rows of the shape
+// the partial tiles along the far edges of the shape are visited in lexicographic order
+//
+// every rank maps to a distinct point, so no agent is idle, regardless of whether the shape's sides are powers of two
+template<std::size_t rank>
+class morton_tiling
+{
+  public:
+    using shape_type = agency::detail::default_shape_t<rank>;
+    using index_type = shape_type;
+
+    __AGENCY_ANNOTATION
+    morton_tiling(const shape_type& shape, std::size_t tile_log2)
+      : shape_(shape),
+        tile_log2_(tile_log2),
+        tile_size_(std::size_t(1) << tile_log2)
+    {
+      // suffix_[d] is the number of points in a slice of the shape perpendicular to dimension d
+      suffix_[rank - 1] = 1;
+      for(std::size_t d = rank - 1; d-- > 0;)
+      {
+        suffix_[d] = suffix_[d + 1] * shape_[d + 1];
+      }
+
+      // when the tiles of the lower dimensions are whole, a slab of tiles perpendicular to dimension d
+      // contains tile_size^(d+1) * suffix_[d] points
+      // these divisors serve all but the edges of the shape, so they are divided by multiplication
+      std::size_t tile_volume = 1;
+      for(std::size_t d = 0; d < rank; ++d)
+      {
+        tile_volume *= tile_size_;
+        whole_slab_size_[d] = agency::detail::fast_divisor<std::size_t>(tile_volume * suffix_[d]);
+      }
+    }
+
+    __AGENCY_ANNOTATION
+    index_type operator()(std::size_t r) const
+    {
+      index_type origin;
+      index_type tile_shape;
+
+      bool whole = true;
+      std::size_t tile_volume = 1;
+
+      // select the slab of tiles perpendicular to each dimension in turn
+      for(std::size_t d = 0; d < rank; ++d)
+      {
+        std::size_t slab_size = whole ? whole_slab_size_[d].divisor() : tile_volume * tile_size_ * suffix_[d];
+        std::size_t slab = whole ? r / whole_slab_size_[d] : r / slab_size;
+
+        r -= slab * slab_size;
+
+        origin[d] = slab << tile_log2_;
+        tile_shape[d] = shape_[d] - origin[d] < tile_size_ ? shape_[d] - origin[d] : tile_size_;
+
+        whole = whole && tile_shape[d] == tile_size_;
+        tile_volume *= tile_shape[d];
+      }
+
+      // r is now the rank of the point within its tile
+      index_type offset;
+
+      if(whole)
+      {
+        offset = agency::detail::morton_decode<index_type>(r);
+      }
+      else
+      {
+        for(std::size_t d = rank; d-- > 0;)
+        {
+          offset[d] = r % tile_shape[d];
+          r /= tile_shape[d];
+        }
+      }
+
+      return origin + offset;
+    }
+
+  private:
+    shape_type shape_;
+    std::size_t tile_log2_;
+    std::size_t tile_size_;
+    std::size_t suffix_[rank];
+    agency::detail::fast_divisor<std::size_t> whole_slab_size_[rank];
+};
+
+
+// morton_index_and_invoke is used by morton_executor::bulk_then_execute()
+// it receives the flat index of the base executor's agent and invokes f with the corresponding point
+template<class Function, std::size_t rank>
+struct morton_index_and_invoke
+{
+  mutable Function    f_;
+  morton_tiling<rank> tiling_;
+
+  template<class Index, class... Args>
+  __AGENCY_ANNOTATION
+  void operator()(const Index& idx, Args&... args) const
+  {
+    f_(tiling_(static_cast<std::size_t>(idx)), args...);
+  }
+};
+
+
+} // end detail
+
+
+/// \brief Adapts a one-dimensional executor to create multidimensional agents in Morton order.
+///
+/// `morton_executor` creates a `rank`-dimensional group of agents with a launch of its base executor.
+/// The base executor's agents, whose indices are contiguous integers, are assigned the points of the shape in a tiled Morton (Z-order) order:
+/// the shape is divided into tiles whose sides are `2^tile_log2` points long, and the points within each tile are visited in Morton order.
+///
+/// Executors such as `parallel_executor` give each of their threads a contiguous range of indices.
+/// Through a `morton_executor`, each thread therefore receives compact tiles of the shape rather than thin rows,
+/// which improves the cache reuse of stencils & transposes.
+///
+/// \tparam Executor The type of the base executor, whose shape must be an integer.
+/// \tparam rank The number of dimensions of the agents created by this executor.
+template<class Executor, std::size_t rank>
+class morton_executor
+{
+  static_assert(rank > 1, "morton_executor's rank must be greater than one.");
+
+  static_assert(std::is_integral<executor_shape_t<Executor>>::value, "The shape_type of morton_executor's base_executor must be an integer.");
+
+  public:
+    using base_executor_type = Executor;
+    using execution_category = executor_execution_category_t<base_executor_type>;
+    using shape_type = agency::detail::default_shape_t<rank>;
+    using index_type = shape_type;
+
+    template<class T>
+    using future = executor_future_t<base_executor_type, T>;
+
+    template<class T>
+    using allocator = executor_allocator_t<base_executor_type, T>;
+
+    /// \brief The default length of the sides of the tiles, as a power of two. Each tile contains roughly a thousand points.
+    static constexpr std::size_t default_tile_log2 = 10 / rank > 0 ? 10 / rank : 1;
+
+    future<void> make_ready_future()
+    {
+      return agency::make_ready_future<void>(base_executor());
+    }
+
+    morton_executor(const base_executor_type& base_executor = base_executor_type(), std::size_t tile_log2 = default_tile_log2)
+      : base_executor_(base_executor),
+        tile_log2_(tile_log2)
+    {}
+
+    template<class Function, class Future, class ResultFactory, class... SharedFactories>
+    future<agency::detail::result_of_t<ResultFactory()>>
+      bulk_then_execute(Function f, shape_type shape, Future& predecessor, ResultFactory result_factory, SharedFactories... shared_factories)
+    {
+      using base_shape_type = executor_shape_t<base_executor_type>;
+      base_shape_type base_shape = static_cast<base_shape_type>(agency::detail::index_space_size(shape));
+
+      detail::morton_index_and_invoke<Function,rank> execute_me{f, detail::morton_tiling<rank>(shape, tile_log2_)};
+
+      agency::detail::bulk_continuation_executor_adaptor<base_executor_type> adapted_executor(base_executor());
+
+      return adapted_executor.bulk_then_execute(execute_me, base_shape, predecessor, result_factory, shared_factories...);
+    }
+
+    const base_executor_type& base_executor() const
+    {
+      return base_executor_;
+    }
+
+    base_executor_type& base_executor()
+    {
+      return base_executor_;
+    }
+
+    std::size_t tile_log2() const
+    {
+      return tile_log2_;
+    }
+
+  private:
+    base_executor_type base_executor_;
+    std::size_t tile_log2_;
+};
+
+
+/// \brief Returns an execution policy whose agents are created in Morton order.
+///
+/// `morton_order(policy)` is equivalent to `policy.on(morton_executor<E,rank>(policy.executor(), tile_log2))`,
+/// where `E` is the type of `policy`'s executor and `rank` is the number of dimensions of `policy`'s agents.
+/// It is intended for the two- & three-dimensional policies, such as `par2d`, whose agents otherwise visit their shape in lexicographic order.
+///
+/// \param policy The execution policy whose agents to create in Morton order. Its executor's shape must be an integer.
+/// \param tile_log2 The length of the sides of the tiles in which agents are created in Morton order, as a power of two.
+template<class ExecutionPolicy,
+         std::size_t rank = agency::detail::index_size<typename execution_agent_traits<typename ExecutionPolicy::execution_agent_type>::index_type>::value,
+         class Executor = typename ExecutionPolicy::executor_type>
+auto morton_order(const ExecutionPolicy& policy, std::size_t tile_log2 = morton_executor<Executor,rank>::default_tile_log2)
+  -> decltype(policy.on(morton_executor<Executor,rank>(policy.executor(), tile_log2)))
+{
+  return policy.on(morton_executor<Executor,rank>(policy.executor(), tile_log2));
+}
+
+
+} // end experimental
+} // end agency
+
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/execution/executor/executor_array.hpp>
+#include <agency/execution/executor/concurrent_executor.hpp>
+// XXX include parallel_executor.hpp rather than thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <vector>
+
+namespace agency
+{
+
+
+// numa_executor is an executor_array with one parallel_executor per NUMA node
+//
+// each inner executor executes on its node's pool from detail::numa_thread_pools(),
+// whose threads are bound to the node's cpus
+// outer indices are distributed round robin across the nodes, so the agents of
+// a single outer index always execute on the same node
+// the outer executor is concurrent so that every node's launch is issued at once
+class numa_executor : public executor_array<parallel_executor, concurrent_executor>
+{
+  private:
+    using super_t = executor_array<parallel_executor, concurrent_executor>;
+
+  public:
+    numa_executor()
+      : numa_executor(detail::thread_pool_schedule())
+    {}
+
+    // creates a numa_executor whose inner executors balance their launches according to schedule
+    explicit numa_executor(const detail::thread_pool_schedule& schedule)
+      : numa_executor(make_node_executors(schedule))
+    {}
+
+    // the number of NUMA nodes
+    size_t num_nodes() const
+    {
+      return size();
+    }
+
+  private:
+    explicit numa_executor(const std::vector<parallel_executor>& node_executors)
+      : super_t(node_executors.begin(), node_executors.end())
+    {}
+
+    static std::vector<parallel_executor> make_node_executors(const detail::thread_pool_schedule& schedule)
+    {
+      std::vector<parallel_executor> result;
+
+      for(const auto& pool : detail::numa_thread_pools())
+      {
+        result.emplace_back(*pool, schedule);
+      }
+
+      return result;
+    }
+};
+
+
+} // end agency
+
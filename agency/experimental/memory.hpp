@@ -2,4 +2,5 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/experimental/memory/allocator.hpp>
+#include <agency/experimental/memory/huge_page_allocator.hpp>
 
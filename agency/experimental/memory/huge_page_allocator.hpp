@@ -0,0 +1,300 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/tuple.hpp>
+#include <agency/detail/factory.hpp>
+#include <agency/detail/integer_sequence.hpp>
+#include <agency/experimental/memory/allocator.hpp>
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/detail/utility/bulk_sync_execute_with_void_result.hpp>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace agency
+{
+namespace experimental
+{
+namespace detail
+{
+namespace huge_page_allocator_detail
+{
+
+
+// allocations at least this large are mapped directly and aligned to this boundary
+constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+
+inline std::size_t round_up_to_huge_page(std::size_t num_bytes)
+{
+  return (num_bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+}
+
+
+inline void* allocate(std::size_t num_bytes)
+{
+  if(num_bytes < huge_page_size)
+  {
+    return ::operator new(num_bytes);
+  }
+
+#ifdef __linux__
+  std::size_t mapped_size = round_up_to_huge_page(num_bytes);
+
+  // over-allocate so that the mapping may begin on a huge page boundary
+  std::size_t padded_size = mapped_size + huge_page_size;
+
+  void* mapping = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if(mapping == MAP_FAILED)
+  {
+    detail::throw_bad_alloc();
+  }
+
+  char* first = reinterpret_cast<char*>(mapping);
+  char* result = reinterpret_cast<char*>(round_up_to_huge_page(reinterpret_cast<std::size_t>(first)));
+  char* last = first + padded_size;
+
+  // trim the unaligned head & tail of the mapping
+  if(result != first)
+  {
+    munmap(first, result - first);
+  }
+
+  if(result + mapped_size != last)
+  {
+    munmap(result + mapped_size, last - (result + mapped_size));
+  }
+
+#ifdef MADV_HUGEPAGE
+  // this is only a hint, so we ignore failure
+  madvise(result, mapped_size, MADV_HUGEPAGE);
+#endif
+
+  return result;
+#else
+  return ::operator new(num_bytes);
+#endif
+}
+
+
+inline void deallocate(void* ptr, std::size_t num_bytes)
+{
+#ifdef __linux__
+  if(num_bytes >= huge_page_size)
+  {
+    munmap(ptr, round_up_to_huge_page(num_bytes));
+    return;
+  }
+#endif
+
+  ::operator delete(ptr);
+}
+
+
+// attempts to grow an allocation of old_num_bytes to new_num_bytes without moving it
+inline bool try_expand(void* ptr, std::size_t old_num_bytes, std::size_t new_num_bytes)
+{
+  // allocations from ::operator new cannot grow
+  if(old_num_bytes < huge_page_size) return false;
+
+  std::size_t old_mapped_size = round_up_to_huge_page(old_num_bytes);
+  std::size_t new_mapped_size = round_up_to_huge_page(new_num_bytes);
+
+  // the mapping may already have room
+  if(new_mapped_size <= old_mapped_size) return true;
+
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+  // without MREMAP_MAYMOVE, mremap() only succeeds if it can extend the mapping where it is
+  if(mremap(ptr, old_mapped_size, new_mapped_size, 0) == MAP_FAILED)
+  {
+    return false;
+  }
+
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, new_mapped_size, MADV_HUGEPAGE);
+#endif
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+template<class T, class Iterator, class... Iterators>
+struct first_touch_constructor
+{
+  Iterator first;
+  agency::detail::tuple<Iterators...> iters;
+
+  template<std::size_t... Indices>
+  void construct(std::size_t i, agency::detail::index_sequence<Indices...>) const
+  {
+    ::new(static_cast<void*>(&*(first + i))) T(*(agency::detail::get<Indices>(iters) + i)...);
+  }
+
+  template<class Unit>
+  void operator()(std::size_t i, Unit&) const
+  {
+    construct(i, agency::detail::make_index_sequence<sizeof...(Iterators)>());
+  }
+};
+
+
+template<class... Iterators>
+struct are_random_access_iterators;
+
+template<>
+struct are_random_access_iterators<> : std::true_type {};
+
+template<class Iterator, class... Iterators>
+struct are_random_access_iterators<Iterator,Iterators...>
+  : std::integral_constant<
+      bool,
+      std::is_convertible<
+        typename std::iterator_traits<Iterator>::iterator_category,
+        std::random_access_iterator_tag
+      >::value &&
+      are_random_access_iterators<Iterators...>::value
+    >
+{};
+
+
+template<class... Args>
+inline void swallow(Args&&...) {}
+
+
+} // end huge_page_allocator_detail
+} // end detail
+
+
+// huge_page_allocator is an allocator for large arrays which are processed in parallel
+//
+// allocations of at least 2 MiB are mapped directly from the operating system on a huge page boundary and,
+// on Linux, are advised to be backed by transparent huge pages. smaller allocations use ::operator new
+//
+// because the operating system places each page on the NUMA node of the thread which first touches it,
+// construct_n() constructs large ranges of elements in parallel on the allocator's executor,
+// element i by the agent with index i. when the same executor later processes the elements with a group
+// of the same shape, e.g. bulk_invoke(par(n).on(exec), ...), each agent finds its elements on its own node
+template<class T, class Executor = parallel_executor>
+class huge_page_allocator
+{
+  static_assert(std::is_same<executor_shape_t<Executor>, std::size_t>::value, "huge_page_allocator: Executor's shape_type must be size_t.");
+
+  public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    using executor_type = Executor;
+
+    template<class U>
+    struct rebind
+    {
+      using other = huge_page_allocator<U,Executor>;
+    };
+
+    huge_page_allocator() = default;
+
+    huge_page_allocator(const huge_page_allocator&) = default;
+
+    explicit huge_page_allocator(const executor_type& exec)
+      : executor_(exec)
+    {}
+
+    template<class U>
+    huge_page_allocator(const huge_page_allocator<U,Executor>& other)
+      : executor_(other.executor())
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      return static_cast<T*>(detail::huge_page_allocator_detail::allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+      detail::huge_page_allocator_detail::deallocate(p, sizeof(T) * n);
+    }
+
+    // attempts to grow the allocation at p from n to new_n elements without moving it
+    // returns false if the allocation must be moved to grow
+    bool try_expand(T* p, std::size_t n, std::size_t new_n)
+    {
+      return detail::huge_page_allocator_detail::try_expand(p, sizeof(T) * n, sizeof(T) * new_n);
+    }
+
+    executor_type& executor() const
+    {
+      return executor_;
+    }
+
+    // constructs n elements at first from the elements of iters...
+    // ranges spanning at least a huge page are constructed in parallel so that each page is first touched by the agent which will later use it
+    template<class Iterator, class... Iterators>
+    agency::detail::tuple<Iterator,Iterators...> construct_n(Iterator first, std::size_t n, Iterators... iters)
+    {
+      using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+      return construct_n_impl<value_type>(
+        std::integral_constant<bool, detail::huge_page_allocator_detail::are_random_access_iterators<Iterator,Iterators...>::value>(),
+        first, n, iters...
+      );
+    }
+
+  private:
+    template<class U, class Iterator, class... Iterators>
+    agency::detail::tuple<Iterator,Iterators...> construct_n_impl(std::true_type, Iterator first, std::size_t n, Iterators... iters)
+    {
+      if(n * sizeof(U) < detail::huge_page_allocator_detail::huge_page_size)
+      {
+        return construct_n_impl<U>(std::false_type(), first, n, iters...);
+      }
+
+      detail::huge_page_allocator_detail::first_touch_constructor<U,Iterator,Iterators...> f{first, agency::detail::make_tuple(iters...)};
+
+      agency::detail::bulk_sync_execute_with_void_result(executor_, f, n, agency::detail::unit_factory());
+
+      return agency::detail::make_tuple(first + n, (iters + n)...);
+    }
+
+    template<class U, class Iterator, class... Iterators>
+    agency::detail::tuple<Iterator,Iterators...> construct_n_impl(std::false_type, Iterator first, std::size_t n, Iterators... iters)
+    {
+      for(std::size_t i = 0; i < n; ++i, ++first, detail::huge_page_allocator_detail::swallow(++iters...))
+      {
+        ::new(static_cast<void*>(&*first)) U(*iters...);
+      }
+
+      return agency::detail::make_tuple(first, iters...);
+    }
+
+    // executor_ is mutable because executors' member functions are not const
+    mutable executor_type executor_;
+};
+
+
+template<class T1, class T2, class Executor>
+bool operator==(const huge_page_allocator<T1,Executor>&, const huge_page_allocator<T2,Executor>&)
+{
+  return true;
+}
+
+
+template<class T1, class T2, class Executor>
+bool operator!=(const huge_page_allocator<T1,Executor>&, const huge_page_allocator<T2,Executor>&)
+{
+  return false;
+}
+
+
+} // end experimental
+} // end agency
+
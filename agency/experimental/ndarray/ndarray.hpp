@@ -7,6 +7,7 @@
 #include <agency/detail/utility.hpp>
 #include <agency/memory/allocator/detail/allocator_traits.hpp>
 #include <agency/detail/iterator/constant_iterator.hpp>
+#include <agency/execution/executor/executor_traits/is_bulk_executor.hpp>
 #include <utility>
 #include <memory>
 #include <iterator>
@@ -14,6 +15,19 @@
 
 namespace agency
 {
+namespace detail
+{
+
+
+// declare bulk_construct_n() for basic_ndarray's use below
+// XXX it is defined in bulk_construct_n.hpp, which we can't #include here due to circular #inclusion problems
+template<class Executor, class Alloc, class Iterator, class... Iterators>
+detail::tuple<Iterator,Iterators...> bulk_construct_n(Executor& exec, Alloc& alloc, Iterator first, std::size_t n, Iterators... iters);
+
+
+} // end detail
+
+
 namespace experimental
 {
 
@@ -60,6 +74,18 @@ class basic_ndarray
     {
     }
 
+    // this constructor value-initializes the elements in parallel on the given executor
+    // note that the program must #include <agency/memory/allocator/detail/bulk_construct_n.hpp> to use it
+    template<class BulkExecutor,
+             __AGENCY_REQUIRES(
+               agency::is_bulk_executor<BulkExecutor>::value
+             )>
+    basic_ndarray(const BulkExecutor& exec, const shape_type& shape, const allocator_type& alloc = allocator_type())
+      : alloc_(alloc),
+        all_(allocate_and_construct_elements_on(exec, alloc_, agency::detail::index_space_size(shape)), shape)
+    {
+    }
+
     __agency_exec_check_disable__
     template<class Iterator,
              // XXX this requirement should really be something like is_input_iterator<InputIterator>
@@ -208,11 +234,7 @@ class basic_ndarray
     {
       if(size())
       {
-        // XXX should really destroy through the allocator
-        for(auto& x : *this)
-        {
-          x.~value_type();
-        }
+        agency::detail::allocator_traits<allocator_type>::destroy_n(alloc_, data(), size());
 
         alloc_.deallocate(data(), size());
 
@@ -283,6 +305,17 @@ class basic_ndarray
       return result;
     }
 
+    template<class BulkExecutor>
+    static pointer allocate_and_construct_elements_on(const BulkExecutor& exec, allocator_type& alloc, size_t size)
+    {
+      pointer result = alloc.allocate(size);
+
+      BulkExecutor exec_copy = exec;
+      agency::detail::bulk_construct_n(exec_copy, alloc, result, size);
+
+      return result;
+    }
+
     allocator_type alloc_;
 
     all_t all_;
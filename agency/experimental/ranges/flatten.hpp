@@ -4,6 +4,7 @@
 #include <agency/detail/requires.hpp>
 #include <agency/experimental/ranges/range_traits.hpp>
 #include <agency/experimental/ranges/all.hpp>
+#include <agency/experimental/span.hpp>
 #include <type_traits>
 #include <utility>
 
@@ -18,6 +19,12 @@ namespace experimental
 // operator[] and size() would have more efficient implementations if
 // we made that assumption
 // we should consider another kind of fancy range that would "un-tile" a collection of tiles
+//
+// a flatten_view may be given a table of the offsets of its segments' first elements,
+// which the owner of the segments keeps up to date
+// with a table, operator[] finds its segment with a binary search and size() is O(1)
+// without one, both are linear in the number of segments
+// either way, iterators track their current segment, so traversing a flatten_view with an iterator is O(1) per element
 template<class RangeOfRanges>
 class flatten_view
 {
@@ -52,6 +59,21 @@ class flatten_view
       : segments_(all(ranges))
     {}
 
+    // segment_offsets[i] is the offset of the first element of segment i, and its final element is the size of the view
+    template<class OtherRangeOfRanges,
+             __AGENCY_REQUIRES(
+               std::is_convertible<
+                 experimental::all_t<OtherRangeOfRanges>,
+                 all_t
+               >::value
+             )
+            >
+    __AGENCY_ANNOTATION
+    flatten_view(OtherRangeOfRanges&& ranges, span<const size_type> segment_offsets)
+      : segments_(all(ranges)),
+        segment_offsets_(segment_offsets)
+    {}
+
     // converting copy constructor
     template<class OtherRangeOfRanges,
              __AGENCY_REQUIRES(
@@ -62,7 +84,8 @@ class flatten_view
              )>
     __AGENCY_ANNOTATION
     flatten_view(const flatten_view<OtherRangeOfRanges>& other)
-      : segments_(other.segments_)
+      : segments_(other.segments_),
+        segment_offsets_(other.segment_offsets_)
     {}
 
   private:
@@ -81,11 +104,72 @@ class flatten_view
         bracket_operator(element_idx - size, current_segment_idx + 1);
     }
 
+    // returns the index of the segment containing the element at element_idx, or the number of segments if element_idx is size()
+    // the segment's first element is at segment_offset
+    __AGENCY_ANNOTATION
+    size_type find_segment(size_type element_idx, size_type& segment_offset) const
+    {
+      size_type num_segments = segments_.size();
+
+      if(has_segment_offsets())
+      {
+        // find the last segment which begins at or before element_idx
+        // empty segments begin where their successors do, so the last such segment is not empty
+        size_type lo = 0;
+        size_type hi = num_segments;
+
+        while(lo < hi)
+        {
+          size_type mid = lo + (hi - lo + 1) / 2;
+
+          if(segment_offsets_[mid] <= element_idx)
+          {
+            lo = mid;
+          }
+          else
+          {
+            hi = mid - 1;
+          }
+        }
+
+        segment_offset = segment_offsets_[lo];
+        return lo;
+      }
+
+      segment_offset = 0;
+
+      size_type segment_idx = 0;
+      for(; segment_idx < num_segments; ++segment_idx)
+      {
+        size_type size = segments_[segment_idx].size();
+
+        if(element_idx - segment_offset < size) break;
+
+        segment_offset += size;
+      }
+
+      return segment_idx;
+    }
+
   public:
+    __AGENCY_ANNOTATION
+    bool has_segment_offsets() const
+    {
+      return segment_offsets_.size() != 0;
+    }
+
     __AGENCY_ANNOTATION
     reference operator[](size_type i) const
     {
-      // seems like we have to do a linear search through the segments
+      if(has_segment_offsets())
+      {
+        size_type segment_offset;
+        size_type segment_idx = find_segment(i, segment_offset);
+
+        return segments_[segment_idx][i - segment_offset];
+      }
+
+      // without a table of segment offsets, we have to do a linear search through the segments
       // so, it't not clear this can be computed in O(1)
       // OTOH, it's not O(N) either (N being the total number of elements viewed by this view)
       return bracket_operator(i, 0);
@@ -94,6 +178,11 @@ class flatten_view
     __AGENCY_ANNOTATION
     size_type size() const
     {
+      if(has_segment_offsets())
+      {
+        return segment_offsets_[segments_.size()];
+      }
+
       size_type result = 0;
       for(auto& segment : segments_)
       {
@@ -103,6 +192,11 @@ class flatten_view
       return result;
     }
 
+    // this iterator tracks both its position within the view and its position within its current segment,
+    // so dereferencing it indexes a single segment, and incrementing it only occasionally moves to the next segment
+    //
+    // an iterator's segment is never an empty segment nor beyond the end of its segment,
+    // except for an iterator at the end of the view, whose segment is one past the last segment
     class iterator
     {
       public:
@@ -116,7 +210,7 @@ class flatten_view
         __AGENCY_ANNOTATION
         reference operator*() const
         {
-          return self_[current_position_];
+          return self_.segments_[segment_idx_][segment_position_];
         }
 
         // pre-increment
@@ -124,6 +218,8 @@ class flatten_view
         iterator operator++()
         {
           ++current_position_;
+          ++segment_position_;
+          skip_to_element();
           return *this;
         }
 
@@ -131,7 +227,14 @@ class flatten_view
         __AGENCY_ANNOTATION
         iterator operator--()
         {
+          while(segment_position_ == 0)
+          {
+            --segment_idx_;
+            segment_position_ = self_.segments_[segment_idx_].size();
+          }
+
           --current_position_;
+          --segment_position_;
           return *this;
         }
 
@@ -140,7 +243,7 @@ class flatten_view
         iterator operator++(int)
         {
           iterator result = *this;
-          current_position_++;
+          ++(*this);
           return result;
         }
 
@@ -149,7 +252,7 @@ class flatten_view
         iterator operator--(int)
         {
           iterator result = *this;
-          current_position_--;
+          --(*this);
           return result;
         }
 
@@ -158,6 +261,23 @@ class flatten_view
         iterator operator+=(size_type n)
         {
           current_position_ += n;
+
+          if(segment_position_ + n < segment_size())
+          {
+            // the common case stays within the current segment
+            segment_position_ += n;
+          }
+          else if(self_.has_segment_offsets())
+          {
+            seek();
+          }
+          else
+          {
+            // walk forward through the segments
+            segment_position_ += n;
+            skip_to_element();
+          }
+
           return *this;
         }
 
@@ -166,12 +286,42 @@ class flatten_view
         iterator operator-=(size_type n)
         {
           current_position_ -= n;
+
+          if(n <= segment_position_)
+          {
+            // the common case stays within the current segment
+            segment_position_ -= n;
+          }
+          else if(self_.has_segment_offsets())
+          {
+            seek();
+          }
+          else
+          {
+            // walk backward through the segments
+            n -= segment_position_;
+
+            --segment_idx_;
+            size_type size = self_.segments_[segment_idx_].size();
+
+            while(n > size)
+            {
+              n -= size;
+
+              --segment_idx_;
+              size = self_.segments_[segment_idx_].size();
+            }
+
+            segment_position_ = size - n;
+            skip_to_element();
+          }
+
           return *this;
         }
 
         // add
         __AGENCY_ANNOTATION
-        iterator operator+(size_type n)
+        iterator operator+(size_type n) const
         {
           iterator result = *this;
           result += n;
@@ -180,7 +330,7 @@ class flatten_view
 
         // minus
         __AGENCY_ANNOTATION
-        iterator operator-(size_type n)
+        iterator operator-(size_type n) const
         {
           iterator result = *this;
           result -= n;
@@ -189,7 +339,7 @@ class flatten_view
 
         // bracket
         __AGENCY_ANNOTATION
-        reference operator[](size_type n)
+        reference operator[](size_type n) const
         {
           iterator tmp = *this + n;
           return *tmp;
@@ -211,6 +361,34 @@ class flatten_view
           return !(*this == rhs);
         }
 
+        // less
+        __AGENCY_ANNOTATION
+        bool operator<(const iterator& rhs) const
+        {
+          return current_position_ < rhs.current_position_;
+        }
+
+        // greater
+        __AGENCY_ANNOTATION
+        bool operator>(const iterator& rhs) const
+        {
+          return rhs < *this;
+        }
+
+        // less or equal
+        __AGENCY_ANNOTATION
+        bool operator<=(const iterator& rhs) const
+        {
+          return !(rhs < *this);
+        }
+
+        // greater or equal
+        __AGENCY_ANNOTATION
+        bool operator>=(const iterator& rhs) const
+        {
+          return !(*this < rhs);
+        }
+
         // difference
         __AGENCY_ANNOTATION
         difference_type operator-(const iterator& rhs) const
@@ -218,6 +396,27 @@ class flatten_view
           return current_position_ - rhs.current_position_;
         }
 
+        // returns the view this iterator came from
+        __AGENCY_ANNOTATION
+        const flatten_view& view() const
+        {
+          return self_;
+        }
+
+        // returns the index of the segment containing the element this iterator points to
+        __AGENCY_ANNOTATION
+        size_type segment_index() const
+        {
+          return segment_idx_;
+        }
+
+        // returns the position of the element this iterator points to within its segment
+        __AGENCY_ANNOTATION
+        size_type segment_position() const
+        {
+          return segment_position_;
+        }
+
       private:
         friend flatten_view;
 
@@ -225,13 +424,46 @@ class flatten_view
         iterator(size_type current_position, const flatten_view& self)
           : current_position_(current_position),
             self_(self)
-        {}
+        {
+          seek();
+        }
+
+        __AGENCY_ANNOTATION
+        size_type segment_size() const
+        {
+          return segment_idx_ < static_cast<size_type>(self_.segments_.size()) ? self_.segments_[segment_idx_].size() : 0;
+        }
+
+        // finds the segment & position of current_position_ from scratch
+        __AGENCY_ANNOTATION
+        void seek()
+        {
+          size_type segment_offset;
+          segment_idx_ = self_.find_segment(current_position_, segment_offset);
+          segment_position_ = current_position_ - segment_offset;
+        }
+
+        // moves forward through the segments until segment_position_ lies within the current segment
+        // or this iterator reaches the end of the view
+        __AGENCY_ANNOTATION
+        void skip_to_element()
+        {
+          size_type num_segments = self_.segments_.size();
+
+          while(segment_idx_ < num_segments)
+          {
+            size_type size = self_.segments_[segment_idx_].size();
+
+            if(segment_position_ < size) break;
+
+            segment_position_ -= size;
+            ++segment_idx_;
+          }
+        }
 
-        // XXX a more efficient implementation would track the current segment
-        // XXX and the current position within the segment
-        //     could keep an iterator to the current segment
-        //     would make operator- and operator+= less efficient because they would involve linear searches
         size_type current_position_;
+        size_type segment_idx_;
+        size_type segment_position_;
 
         flatten_view self_;
     };
@@ -250,6 +482,7 @@ class flatten_view
 
   private:
     all_t segments_;
+    span<const size_type> segment_offsets_;
 
   public:
     __AGENCY_ANNOTATION
@@ -275,6 +508,15 @@ flatten_view<RangeOfRanges> flatten(RangeOfRanges&& ranges)
 }
 
 
+// segment_offsets[i] is the offset of the first element of ranges[i], and segment_offsets[ranges.size()] is the total number of elements
+template<class RangeOfRanges>
+__AGENCY_ANNOTATION
+flatten_view<RangeOfRanges> flatten(RangeOfRanges&& ranges, span<const typename flatten_view<RangeOfRanges>::size_type> segment_offsets)
+{
+  return flatten_view<RangeOfRanges>(std::forward<RangeOfRanges>(ranges), segment_offsets);
+}
+
+
 } // end experimental
 } // end agency
 
@@ -77,6 +77,17 @@ class segmented_array
           segments_.emplace_back(1, val, *alloc);
         }
       }
+
+      // record the offset of each segment's first element, so that all() may find an element's segment with a binary search
+      size_type offset = 0;
+      segment_offsets_.reserve(segments_.size() + 1);
+      for(auto& segment : segments_)
+      {
+        segment_offsets_.push_back(offset);
+        offset += segment.size();
+      }
+
+      segment_offsets_.push_back(offset);
     }
 
     // constructs a segmented_array with a single segment
@@ -92,19 +103,22 @@ class segmented_array
     using outer_container = vector<inner_container, outer_allocator_type>;
     outer_container segments_;
 
+    // segment_offsets_[i] is the offset of the first element of segment i, and its final element is size()
+    vector<size_type> segment_offsets_;
+
   public:
     using all_t = flatten_view<outer_container>;
 
     all_t all()
     {
-      return flatten(segments_);
+      return flatten(segments_, segment_offsets_);
     }
 
     using const_all_t = flatten_view<const outer_container>;
 
     const_all_t all() const
     {
-      return flatten(segments_);
+      return flatten(segments_, segment_offsets_);
     }
 
     size_type size() const
@@ -173,6 +187,7 @@ class segmented_array
     void clear()
     {
       segments_.clear();
+      segment_offsets_.clear();
     }
 
     bool operator==(const segmented_array& rhs) const
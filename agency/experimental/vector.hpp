@@ -2,6 +2,7 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
 #include <agency/memory/allocator/detail/allocator_traits.hpp>
 #include <agency/detail/utility.hpp>
 #include <agency/detail/iterator.hpp>
@@ -13,15 +14,61 @@
 #include <agency/experimental/memory/allocator.hpp>
 #include <memory>
 #include <initializer_list>
+#include <iterator>
+#include <cstring>
+#include <ratio>
+#include <type_traits>
 
 namespace agency
 {
 namespace experimental
 {
+
+
+// is_trivially_relocatable<T> indicates that moving an object of type T to a new address and
+// destroying the original is equivalent to copying its bytes
+// vector relocates the elements of such types with memcpy when it grows
+// specialize this trait for types which are not trivially copyable but may be relocated by memcpy,
+// e.g. types which hold a std::unique_ptr
+template<class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+
 namespace detail
 {
 
 
+// elements are relocated with memcpy when their type is trivially relocatable and the allocator does not customize
+// their construction or destruction
+template<class Allocator, class T>
+struct is_memcpy_relocatable
+  : std::integral_constant<
+      bool,
+      is_trivially_relocatable<T>::value &&
+      !agency::detail::allocator_traits_detail::has_custom_construct<Allocator,T*,T&&>::value &&
+      !agency::detail::allocator_traits_detail::has_custom_destroy<Allocator,T*>::value
+    >
+{};
+
+
+// an allocator may tune the geometric growth of the vectors which use it by defining a member type
+// growth_factor, a std::ratio greater than one. the default is std::ratio<2>
+template<class Allocator>
+using allocator_growth_factor_member_t = typename Allocator::growth_factor;
+
+template<class Allocator>
+using allocator_growth_factor_t = agency::detail::detected_or_t<std::ratio<2>, allocator_growth_factor_member_t, Allocator>;
+
+
+// an allocator may grow an allocation where it lies by defining a member function
+// bool try_expand(pointer p, size_t n, size_t new_n), which returns false if the allocation must be moved
+template<class Allocator, class T>
+using allocator_try_expand_t = decltype(std::declval<Allocator&>().try_expand(std::declval<T*>(), std::declval<std::size_t>(), std::declval<std::size_t>()));
+
+template<class Allocator, class T>
+using has_try_expand = agency::detail::is_detected_exact<bool, allocator_try_expand_t, Allocator, T>;
+
+
 template<class Allocator, class Iterator1, class Size, class Iterator2>
 __AGENCY_ANNOTATION
 Iterator2 uninitialized_move_n(Allocator& alloc, Iterator1 first, Size n, Iterator2 result)
@@ -40,6 +87,44 @@ Iterator2 uninitialized_copy_n(Allocator& alloc, Iterator1 first, Size n, Iterat
 }
 
 
+// like std::move_if_noexcept, elements are moved only if their move constructor does not throw or if they cannot be copied
+// otherwise, they are copied so that the originals are intact if a constructor throws
+template<class T>
+struct is_move_if_noexcept_constructible
+  : std::integral_constant<
+      bool,
+      std::is_nothrow_move_constructible<T>::value ||
+      !std::is_copy_constructible<T>::value
+    >
+{};
+
+
+template<class Allocator, class Iterator1, class Size, class Iterator2>
+__AGENCY_ANNOTATION
+Iterator2 uninitialized_move_if_noexcept_n(std::true_type, Allocator& alloc, Iterator1 first, Size n, Iterator2 result)
+{
+  return detail::uninitialized_move_n(alloc, first, n, result);
+}
+
+
+template<class Allocator, class Iterator1, class Size, class Iterator2>
+__AGENCY_ANNOTATION
+Iterator2 uninitialized_move_if_noexcept_n(std::false_type, Allocator& alloc, Iterator1 first, Size n, Iterator2 result)
+{
+  return detail::uninitialized_copy_n(alloc, first, n, result);
+}
+
+
+template<class Allocator, class Iterator1, class Size, class Iterator2>
+__AGENCY_ANNOTATION
+Iterator2 uninitialized_move_if_noexcept_n(Allocator& alloc, Iterator1 first, Size n, Iterator2 result)
+{
+  using value_type = typename std::iterator_traits<Iterator1>::value_type;
+
+  return detail::uninitialized_move_if_noexcept_n(is_move_if_noexcept_constructible<value_type>(), alloc, first, n, result);
+}
+
+
 template<class Allocator, class ForwardIterator, class OutputIterator>
 __AGENCY_ANNOTATION
 OutputIterator uninitialized_copy(Allocator& alloc, ForwardIterator first, ForwardIterator last, OutputIterator result)
@@ -131,16 +216,11 @@ Iterator construct_n(Allocator& alloc, Iterator first, size_t n, Iterators... it
 }
 
 
-// XXX seems like this should be a member of allocator_traits
-
 template<class Allocator, class Iterator>
 __AGENCY_ANNOTATION
 void destroy_each(Allocator& alloc, Iterator first, Iterator last)
 {
-  for(; first != last; ++first)
-  {
-    agency::detail::allocator_traits<Allocator>::destroy(alloc, &*first);
-  }
+  agency::detail::allocator_traits<Allocator>::destroy_n(alloc, first, last - first);
 }
 
 __AGENCY_ANNOTATION
@@ -286,6 +366,31 @@ class storage
       return allocator_;
     }
 
+    // attempts to grow this storage to new_count elements without moving it
+    // returns false if the allocator cannot grow the allocation where it lies
+    __agency_exec_check_disable__
+    template<class A = Allocator,
+             __AGENCY_REQUIRES(has_try_expand<A,T>::value)>
+    __AGENCY_ANNOTATION
+    bool try_expand(size_t new_count)
+    {
+      if(data_ == nullptr || !allocator_.try_expand(data_, size_, new_count))
+      {
+        return false;
+      }
+
+      size_ = new_count;
+      return true;
+    }
+
+    template<class A = Allocator,
+             __AGENCY_REQUIRES(!has_try_expand<A,T>::value)>
+    __AGENCY_ANNOTATION
+    bool try_expand(size_t)
+    {
+      return false;
+    }
+
     __AGENCY_ANNOTATION
     void swap(storage& other)
     {
@@ -670,14 +775,12 @@ class vector
           detail::throw_length_error("reserve(): new capacity exceeds max_size().");
         }
 
-        // create a new storage object
-        storage_type new_storage(new_capacity, storage_.allocator());
-
-        // copy our elements into the new storage
-        end_ = detail::uninitialized_copy(new_storage.allocator(), begin(), end(), new_storage.data());
-
-        // swap out our storage
-        storage_.swap(new_storage);
+        if(!storage_.try_expand(new_capacity))
+        {
+          // relocate our elements into new storage
+          // no new elements are constructed, but reallocate_and_emplace_n() requires an iterator to construct them from
+          reallocate_and_emplace_n(new_capacity, end(), 0, agency::detail::make_move_iterator(end()));
+        }
       }
     }
 
@@ -896,55 +999,127 @@ class vector
       {
         size_type old_size = size();
 
-        // compute the new capacity after the allocation
-        size_type new_capacity = old_size + agency::detail::max(old_size, count);
-
-        // allocate exponentially larger new storage
-        new_capacity = agency::detail::max(new_capacity, size_type(2) * capacity());
+        if(count > max_size() - old_size)
+        {
+          detail::throw_length_error("insert(): insertion exceeds max_size().");
+        }
 
-        // do not exceed maximum storage
-        new_capacity = agency::detail::min(new_capacity, max_size());
+        size_type new_capacity = growth_capacity(old_size + count);
 
-        if(new_capacity > max_size())
+        if(storage_.try_expand(new_capacity))
         {
-          detail::throw_length_error("insert(): insertion exceeds max_size().");
+          // the storage grew in place, so position remains valid
+          return emplace_n(position, count, iters...);
         }
 
-        storage_type new_storage(new_capacity, storage_.allocator());
+        result = reallocate_and_emplace_n(new_capacity, position, count, iters...);
+      }
+
+      return result;
+    }
+
+    // returns the capacity to grow to in order to accomodate required_capacity elements
+    __AGENCY_ANNOTATION
+    size_type growth_capacity(size_type required_capacity) const
+    {
+      using growth_factor = detail::allocator_growth_factor_t<allocator_type>;
+      static_assert(growth_factor::num > growth_factor::den, "vector: Allocator::growth_factor must be greater than one.");
+
+      // grow capacity() geometrically without overflowing
+      size_type grown_capacity = max_size();
+      if(capacity() / growth_factor::den < max_size() / growth_factor::num)
+      {
+        grown_capacity = capacity() / growth_factor::den * growth_factor::num + capacity() % growth_factor::den * growth_factor::num / growth_factor::den;
+      }
+
+      return agency::detail::min(agency::detail::max(required_capacity, grown_capacity), max_size());
+    }
+
+    // allocates new storage of new_capacity elements, constructs count new elements from iters... at position, and relocates our elements around them
+    template<class... InputIterator>
+    __AGENCY_ANNOTATION
+    iterator reallocate_and_emplace_n(size_type new_capacity, iterator position, size_type count, InputIterator... iters)
+    {
+      return reallocate_and_emplace_n(detail::is_memcpy_relocatable<allocator_type,value_type>(), new_capacity, position, count, iters...);
+    }
+
+    template<class... InputIterator>
+    __AGENCY_ANNOTATION
+    iterator reallocate_and_emplace_n(std::true_type, size_type new_capacity, iterator position, size_type count, InputIterator... iters)
+    {
+      storage_type new_storage(new_capacity, storage_.allocator());
+
+      size_type num_elements_before = position - begin();
+      size_type num_elements_after = end() - position;
+
+      iterator result = new_storage.data() + num_elements_before;
 
-        // record how many constructors we invoke in the try block below
-        iterator new_end = new_storage.data();
+      // construct the new elements first, so that our elements are untouched if a constructor throws
+      detail::construct_n(new_storage.allocator(), result, count, iters...);
+
+      // relocate our elements around the new elements by copying their bytes
+      // the old storage is deallocated without destroying its elements
+      if(num_elements_before > 0)
+      {
+        std::memcpy(static_cast<void*>(new_storage.data()), static_cast<const void*>(begin()), num_elements_before * sizeof(value_type));
+      }
+
+      if(num_elements_after > 0)
+      {
+        std::memcpy(static_cast<void*>(result + count), static_cast<const void*>(position), num_elements_after * sizeof(value_type));
+      }
+
+      // record the vector's new state
+      storage_.swap(new_storage);
+      end_ = result + count + num_elements_after;
+
+      return result;
+    }
+
+    template<class... InputIterator>
+    __AGENCY_ANNOTATION
+    iterator reallocate_and_emplace_n(std::false_type, size_type new_capacity, iterator position, size_type count, InputIterator... iters)
+    {
+      storage_type new_storage(new_capacity, storage_.allocator());
+
+      iterator result = new_storage.data();
+
+      // record how many constructors we invoke in the try block below
+      iterator new_end = new_storage.data();
 
 #ifndef __CUDA_ARCH__
-        try
+      try
 #endif
-        {
-          // move elements before the insertion to the beginning of the new storage
-          new_end = detail::uninitialized_move_n(new_storage.allocator(), begin(), position - begin(), new_storage.data());
+      {
+        // move elements before the insertion to the beginning of the new storage
+        // elements whose move constructor may throw are copied instead, so that a throw leaves our elements intact
+        new_end = detail::uninitialized_move_if_noexcept_n(new_storage.allocator(), begin(), position - begin(), new_storage.data());
 
-          result = new_end;
+        result = new_end;
 
-          // copy construct new elements
-          new_end = detail::construct_n(new_storage.allocator(), new_end, count, iters...);
+        // copy construct new elements
+        new_end = detail::construct_n(new_storage.allocator(), new_end, count, iters...);
 
-          // move elements after the insertion to the end of the new storage
-          new_end = detail::uninitialized_move_n(new_storage.allocator(), position, end() - position, new_end);
-        }
+        // move elements after the insertion to the end of the new storage
+        new_end = detail::uninitialized_move_if_noexcept_n(new_storage.allocator(), position, end() - position, new_end);
+      }
 #ifndef __CUDA_ARCH__
-        catch(...)
-        {
-          // something went wrong, so destroy as many new elements as were constructed
-          detail::destroy_each(new_storage.allocator(), new_storage.data(), new_end);
+      catch(...)
+      {
+        // something went wrong, so destroy as many new elements as were constructed
+        detail::destroy_each(new_storage.allocator(), new_storage.data(), new_end);
 
-          // rethrow
-          throw;
-        }
+        // rethrow
+        throw;
+      }
 #endif
 
-        // record the vector's new state
-        storage_.swap(new_storage);
-        end_ = new_end;
-      }
+      // destroy our moved-from elements
+      detail::destroy_each(storage_.allocator(), begin(), end());
+
+      // record the vector's new state
+      storage_.swap(new_storage);
+      end_ = new_end;
 
       return result;
     }
@@ -5,6 +5,7 @@
 #include <agency/exception_list.hpp>
 #include <agency/detail/tuple.hpp>
 #include <agency/future/future_traits/future_rebind_value.hpp>
+#include <agency/future/detail/continuation_future.hpp>
 
 #include <future>
 #include <utility>
@@ -562,6 +563,29 @@ using has_share = typename has_share_impl<Future>::type;
 } // end detail
 
 
+/// \brief `future` is the type of future returned by Agency's CPU executors, such as `parallel_executor` & `concurrent_executor`.
+///
+/// Unlike `std::future`, `future`'s readiness is a single atomic word which `is_ready()` reads without taking a lock,
+/// and waiting threads park on that word with a futex. Continuations attached with `.then()` are executed by the
+/// thread which fulfills the future, so chaining work onto a pending `future` never blocks a thread.
+/// `.share()` reuses the future's state and returns a `shared_future`.
+///
+/// A `future` may be moved into a `std::future`, which becomes ready along with it:
+///
+///     std::future<void> f = agency::bulk_async(agency::par(5), [](agency::parallel_agent&){});
+///
+/// \tparam T The type of the future's value.
+template<class T>
+using future = detail::continuation_future<T>;
+
+
+/// \brief `shared_future` is the copyable counterpart of `future`, returned by `future::share()`.
+///
+/// \tparam T The type of the future's value.
+template<class T>
+using shared_future = detail::shared_continuation_future<T>;
+
+
 template<class Future>
 struct future_traits
 {
@@ -0,0 +1,911 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/unit.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <agency/detail/concurrency/worker_identity.hpp>
+#include <agency/detail/concurrency/futex.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/memory/allocator/detail/allocator_adaptor.hpp>
+#include <agency/memory/detail/resource/thread_caching_resource.hpp>
+
+#include <future>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <utility>
+#include <type_traits>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// continuation_state is the shared state of continuation_future & shared_continuation_future
+//
+// in addition to a value or an exception, the state holds a list of continuations
+// continuations are executed by the thread which makes the state ready, so chaining
+// a continuation onto a continuation_future never blocks a thread on the predecessor
+//
+// the state never takes a lock: its readiness is a single atomic status word, which threads
+// waiting for the state park on with futex_wait(), and continuations are pushed onto an
+// atomic list which the thread making the state ready exchanges for a sentinel
+template<class T>
+class continuation_state
+{
+  private:
+    struct continuation_node
+    {
+      unique_function<void()> function;
+      continuation_node* next;
+    };
+
+    using node_allocator = allocator_adaptor<continuation_node, thread_caching_resource>;
+
+    // the bits of status_
+    // a value or exception has been claimed by set_value() or set_exception()
+    static constexpr int satisfied_bit = 1;
+    // the value or exception may be read
+    static constexpr int ready_bit = 2;
+    // a thread is parked on status_
+    static constexpr int waiting_bit = 4;
+
+  public:
+    using value_type = T;
+
+    // void results are stored as a unit
+    using storage_type = typename std::conditional<std::is_void<T>::value, unit, T>::type;
+
+    continuation_state()
+      : status_(0),
+        continuations_(nullptr)
+    {}
+
+    continuation_state(const continuation_state&) = delete;
+    continuation_state& operator=(const continuation_state&) = delete;
+
+    ~continuation_state()
+    {
+      // the continuations of a state which never became ready are discarded
+      continuation_node* node = continuations_.load(std::memory_order_acquire);
+
+      if(node != ready_sentinel())
+      {
+        while(node)
+        {
+          continuation_node* next = node->next;
+          delete_node(node);
+          node = next;
+        }
+      }
+    }
+
+    template<class... Args>
+    void set_value(Args&&... args)
+    {
+      claim();
+
+      try
+      {
+        value_.emplace(std::forward<Args>(args)...);
+      }
+      catch(...)
+      {
+        // the value was not stored, so the state may still be satisfied
+        status_.fetch_and(~satisfied_bit, std::memory_order_relaxed);
+        throw;
+      }
+
+      become_ready();
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+      claim();
+
+      exception_ = e;
+
+      become_ready();
+    }
+
+    // arranges for f() to be called once this state is ready
+    // if the state is already ready, f() is called immediately by the calling thread
+    // otherwise, f() is called by the thread which makes this state ready
+    template<class Function>
+    void add_continuation(Function&& f)
+    {
+      continuation_node* head = continuations_.load(std::memory_order_acquire);
+
+      if(head == ready_sentinel())
+      {
+        std::forward<Function>(f)();
+        return;
+      }
+
+      node_allocator alloc;
+      continuation_node* node = alloc.allocate(1);
+      ::new(node) continuation_node{unique_function<void()>(std::forward<Function>(f)), head};
+
+      while(!continuations_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_acquire))
+      {
+        if(node->next == ready_sentinel())
+        {
+          // the state became ready while we were pushing
+          unique_function<void()> continuation = std::move(node->function);
+          delete_node(node);
+
+          continuation();
+          return;
+        }
+      }
+    }
+
+    bool is_ready() const
+    {
+      return status_.load(std::memory_order_acquire) & ready_bit;
+    }
+
+    void wait() const
+    {
+      if(is_ready()) return;
+
+      // a thread pool's worker executes the pool's pending tasks rather than blocking,
+      // because the state may be fulfilled by a task which is queued behind it
+      if(help_until([this]{ return is_ready(); }, [this](std::chrono::microseconds timeout){ park_for(timeout); })) return;
+
+      int status = status_.load(std::memory_order_acquire);
+
+      while(!(status & ready_bit))
+      {
+        // announce that a thread is parked, so that become_ready() knows to wake it
+        if(!(status & waiting_bit))
+        {
+          if(!status_.compare_exchange_weak(status, status | waiting_bit, std::memory_order_acquire))
+          {
+            continue;
+          }
+
+          status |= waiting_bit;
+        }
+
+        futex_wait(status_, status);
+
+        status = status_.load(std::memory_order_acquire);
+      }
+    }
+
+    // waits for the state to become ready and returns a reference to its value
+    // if the state holds an exception, it is rethrown
+    storage_type& value()
+    {
+      wait();
+
+      if(exception_)
+      {
+        std::rethrow_exception(exception_);
+      }
+
+      return *value_;
+    }
+
+    std::exception_ptr exception() const
+    {
+      wait();
+      return exception_;
+    }
+
+  private:
+    // blocks the calling thread until the state becomes ready, or until timeout elapses
+    void park_for(std::chrono::microseconds timeout) const
+    {
+      int status = status_.load(std::memory_order_acquire);
+
+      if(status & ready_bit) return;
+
+      // announce that a thread is parked, so that become_ready() knows to wake it
+      if(!(status & waiting_bit))
+      {
+        // the status changed, so the caller should check it again rather than park
+        if(!status_.compare_exchange_strong(status, status | waiting_bit, std::memory_order_acquire)) return;
+
+        status |= waiting_bit;
+      }
+
+      futex_wait_for(status_, status, timeout);
+    }
+
+    // the value of continuations_ once the state is ready
+    static continuation_node* ready_sentinel()
+    {
+      static char sentinel;
+      return reinterpret_cast<continuation_node*>(&sentinel);
+    }
+
+    static void delete_node(continuation_node* node)
+    {
+      node->~continuation_node();
+
+      node_allocator alloc;
+      alloc.deallocate(node, 1);
+    }
+
+    void claim()
+    {
+      if(status_.fetch_or(satisfied_bit, std::memory_order_acquire) & satisfied_bit)
+      {
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+      }
+    }
+
+    void become_ready()
+    {
+      // the caller owns a reference to this state, so it remains alive after waiting threads are released
+      if(status_.fetch_or(ready_bit, std::memory_order_acq_rel) & waiting_bit)
+      {
+        futex_wake_all(status_);
+      }
+
+      continuation_node* node = continuations_.exchange(ready_sentinel(), std::memory_order_acq_rel);
+
+      // continuations were pushed onto the front of the list, so reverse it to execute them in the order they were added
+      continuation_node* reversed = nullptr;
+      while(node)
+      {
+        continuation_node* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+      }
+
+      while(reversed)
+      {
+        continuation_node* next = reversed->next;
+
+        unique_function<void()> continuation = std::move(reversed->function);
+        delete_node(reversed);
+
+        continuation();
+
+        reversed = next;
+      }
+    }
+
+    mutable std::atomic<int>             status_;
+    std::atomic<continuation_node*>      continuations_;
+    experimental::optional<storage_type> value_;
+    std::exception_ptr                   exception_;
+};
+
+
+// continuation states are allocated from the calling thread's cache of small blocks,
+// so the states of short-lived futures are recycled rather than returned to the heap
+template<class T>
+std::shared_ptr<continuation_state<T>> make_continuation_state()
+{
+  return std::allocate_shared<continuation_state<T>>(allocator_adaptor<continuation_state<T>, thread_caching_resource>());
+}
+
+
+template<class T>
+class continuation_future;
+
+
+namespace continuation_future_detail
+{
+
+
+// moves a T out of a state's storage
+template<class T>
+struct move_out
+{
+  static T apply(T& value)
+  {
+    return std::move(value);
+  }
+};
+
+template<>
+struct move_out<void>
+{
+  static void apply(unit&) {}
+};
+
+
+// the type of the result of a continuation applied to a continuation_state<T>'s value
+template<class T, class Function>
+struct continuation_result
+{
+  using type = result_of_t<Function(T&)>;
+};
+
+template<class Function>
+struct continuation_result<void,Function>
+{
+  using type = result_of_t<Function()>;
+};
+
+template<class T, class Function>
+using continuation_result_t = typename continuation_result<T,Function>::type;
+
+
+// calls f with the value of a state, or with no arguments when the state's value_type is void
+template<class T, class Function>
+continuation_result_t<T,Function&> invoke_with_value(std::false_type, Function& f, continuation_state<T>& state)
+{
+  return f(state.value());
+}
+
+template<class T, class Function>
+continuation_result_t<T,Function&> invoke_with_value(std::true_type, Function& f, continuation_state<T>& state)
+{
+  state.value();
+  return f();
+}
+
+
+// calls f() and stores its result in state
+template<class U, class Function>
+void set_value_with_result(std::false_type, continuation_state<U>& state, Function& f)
+{
+  state.set_value(f());
+}
+
+template<class U, class Function>
+void set_value_with_result(std::true_type, continuation_state<U>& state, Function& f)
+{
+  f();
+  state.set_value();
+}
+
+
+// arranges for successor_state to receive the result of f(), or the exception it throws,
+// once predecessor_state is ready
+template<class T, class U, class Function>
+void attach_continuation(const std::shared_ptr<continuation_state<T>>& predecessor_state,
+                         const std::shared_ptr<continuation_state<U>>& successor_state,
+                         Function f)
+{
+  predecessor_state->add_continuation([=]() mutable
+  {
+    try
+    {
+      continuation_future_detail::set_value_with_result(std::is_void<U>(), *successor_state, f);
+    }
+    catch(...)
+    {
+      successor_state->set_exception(std::current_exception());
+    }
+  });
+}
+
+
+// arranges for successor_state to receive the result of f applied to predecessor_state's value
+// an exception stored in predecessor_state propagates to successor_state
+template<class T, class U, class Function>
+void attach_then(const std::shared_ptr<continuation_state<T>>& predecessor_state,
+                 const std::shared_ptr<continuation_state<U>>& successor_state,
+                 Function f)
+{
+  // the continuation refers to the predecessor through a raw pointer,
+  // because the predecessor owns the continuation until it executes
+  continuation_state<T>* predecessor = predecessor_state.get();
+
+  continuation_future_detail::attach_continuation(predecessor_state, successor_state, [=]() mutable
+  {
+    return continuation_future_detail::invoke_with_value(std::is_void<T>(), f, *predecessor);
+  });
+}
+
+
+// calls f with the value of a ready future, or with no arguments when T is void
+template<class T, class Function>
+continuation_result_t<T,Function&> invoke_with_ready_value(std::false_type, Function& f, typename continuation_state<T>::storage_type& value)
+{
+  return f(value);
+}
+
+template<class T, class Function>
+continuation_result_t<T,Function&> invoke_with_ready_value(std::true_type, Function& f, unit&)
+{
+  return f();
+}
+
+
+// calls f() and returns a ready future to its result, or to the exception it throws
+template<class U, class Function>
+continuation_future<U> make_ready_with_result(std::false_type, Function&& f)
+{
+  try
+  {
+    return continuation_future<U>::make_ready(f());
+  }
+  catch(...)
+  {
+    return continuation_future<U>::make_exceptional(std::current_exception());
+  }
+}
+
+template<class U, class Function>
+continuation_future<U> make_ready_with_result(std::true_type, Function&& f)
+{
+  try
+  {
+    f();
+    return continuation_future<U>::make_ready();
+  }
+  catch(...)
+  {
+    return continuation_future<U>::make_exceptional(std::current_exception());
+  }
+}
+
+
+// stores a value in a std::promise
+template<class T>
+void set_std_promise_value(std::promise<T>& promise, T& value)
+{
+  promise.set_value(std::move(value));
+}
+
+inline void set_std_promise_value(std::promise<void>& promise, unit&)
+{
+  promise.set_value();
+}
+
+
+// fulfills a std::promise with the value or exception of a state once the state is ready
+template<class T>
+struct fulfill_std_promise
+{
+  std::promise<T> promise;
+
+  // the state owns this continuation until it executes, so it is referred to through a raw pointer
+  continuation_state<T>* state;
+
+  void operator()()
+  {
+    try
+    {
+      continuation_future_detail::set_std_promise_value(promise, state->value());
+    }
+    catch(...)
+    {
+      promise.set_exception(std::current_exception());
+    }
+  }
+};
+
+
+} // end continuation_future_detail
+
+
+template<class T>
+class shared_continuation_future;
+
+
+// continuation_future is a future whose continuations are executed by the thread which
+// fulfills the future, rather than by a new thread which blocks until the future is ready
+//
+// a future which is ready when it is created, e.g. by make_ready(), stores its value inline
+// and allocates no state
+template<class T>
+class continuation_future
+{
+  private:
+    using state_type = continuation_state<T>;
+    using storage_type = typename state_type::storage_type;
+
+  public:
+    continuation_future() = default;
+
+    explicit continuation_future(std::shared_ptr<state_type> state)
+      : state_(std::move(state))
+    {}
+
+    continuation_future(continuation_future&& other)
+      : state_(std::move(other.state_)),
+        value_(std::move(other.value_))
+    {
+      other.value_.reset();
+    }
+
+    continuation_future& operator=(continuation_future&& other)
+    {
+      state_ = std::move(other.state_);
+      value_ = std::move(other.value_);
+      other.value_.reset();
+      return *this;
+    }
+
+    template<class... Args>
+    static continuation_future make_ready(Args&&... args)
+    {
+      continuation_future result;
+      result.value_.emplace(std::forward<Args>(args)...);
+      return result;
+    }
+
+    static continuation_future make_exceptional(std::exception_ptr e)
+    {
+      auto state = make_continuation_state<T>();
+      state->set_exception(e);
+      return continuation_future(std::move(state));
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_) || static_cast<bool>(value_);
+    }
+
+    bool is_ready() const
+    {
+      return value_ || state_->is_ready();
+    }
+
+    void wait() const
+    {
+      if(!value_)
+      {
+        state_->wait();
+      }
+    }
+
+    T get()
+    {
+      if(!valid())
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+
+      if(value_)
+      {
+        storage_type value = std::move(*value_);
+        value_.reset();
+        return continuation_future_detail::move_out<T>::apply(value);
+      }
+
+      std::shared_ptr<state_type> state = std::move(state_);
+
+      return continuation_future_detail::move_out<T>::apply(state->value());
+    }
+
+    shared_continuation_future<T> share()
+    {
+      if(value_)
+      {
+        // sharing a value requires a state
+        state_ = make_continuation_state<T>();
+        state_->set_value(std::move(*value_));
+        value_.reset();
+      }
+
+      return shared_continuation_future<T>(std::move(state_));
+    }
+
+    // returns a future to the result of f applied to this future's value
+    // f is called by the thread which fulfills this future, or immediately if this future is already ready
+    // this future is invalidated
+    template<class Function>
+    continuation_future<
+      continuation_future_detail::continuation_result_t<T,decay_t<Function>&>
+    >
+      then(Function&& f)
+    {
+      using result_type = continuation_future_detail::continuation_result_t<T,decay_t<Function>&>;
+
+      decay_t<Function> g(std::forward<Function>(f));
+
+      if(value_)
+      {
+        continuation_future ready_future(std::move(*this));
+
+        return continuation_future_detail::make_ready_with_result<result_type>(std::is_void<result_type>(), [&]
+        {
+          return continuation_future_detail::invoke_with_ready_value<T>(std::is_void<T>(), g, *ready_future.value_);
+        });
+      }
+
+      auto successor_state = make_continuation_state<result_type>();
+
+      continuation_future_detail::attach_then(state_, successor_state, std::move(g));
+
+      state_.reset();
+
+      return continuation_future<result_type>(std::move(successor_state));
+    }
+
+    // returns a future to the result of f applied to this future, once it is ready
+    // this is the non-monadic counterpart of then()
+    // this future is invalidated
+    template<class Function>
+    continuation_future<result_of_t<decay_t<Function>(continuation_future&)>>
+      then_with_future(Function&& f)
+    {
+      using result_type = result_of_t<decay_t<Function>(continuation_future&)>;
+
+      decay_t<Function> g(std::forward<Function>(f));
+
+      if(value_)
+      {
+        continuation_future ready_future(std::move(*this));
+
+        return continuation_future_detail::make_ready_with_result<result_type>(std::is_void<result_type>(), [&]
+        {
+          return g(ready_future);
+        });
+      }
+
+      auto successor_state = make_continuation_state<result_type>();
+
+      // the continuation refers to this future's state through a weak_ptr,
+      // because the state owns the continuation until it executes
+      std::weak_ptr<state_type> weak_state = state_;
+
+      continuation_future_detail::attach_continuation(state_, successor_state, [=]() mutable
+      {
+        continuation_future ready_future(weak_state.lock());
+        return g(ready_future);
+      });
+
+      state_.reset();
+
+      return continuation_future<result_type>(std::move(successor_state));
+    }
+
+    // arranges for f() to be called once this future is ready
+    // f() is called by the thread which fulfills this future, or immediately if this future is already ready
+    // this future remains valid
+    template<class Function>
+    void on_ready(Function&& f) const
+    {
+      if(value_)
+      {
+        std::forward<Function>(f)();
+        return;
+      }
+
+      state_->add_continuation(std::forward<Function>(f));
+    }
+
+    // moves this future into a std::future which becomes ready along with this future
+    // this future is invalidated
+    operator std::future<T>() &&
+    {
+      // an invalid future becomes an invalid std::future
+      if(!valid()) return std::future<T>();
+
+      std::promise<T> promise;
+      std::future<T> result = promise.get_future();
+
+      if(value_)
+      {
+        continuation_future_detail::set_std_promise_value(promise, *value_);
+        value_.reset();
+      }
+      else
+      {
+        state_type* state = state_.get();
+        state->add_continuation(continuation_future_detail::fulfill_std_promise<T>{std::move(promise), state});
+        state_.reset();
+      }
+
+      return result;
+    }
+
+  private:
+    template<class> friend class shared_continuation_future;
+
+    std::shared_ptr<state_type> state_;
+
+    // the value of a future which was ready at creation
+    experimental::optional<storage_type> value_;
+};
+
+
+// shared_continuation_future is the copyable counterpart of continuation_future
+template<class T>
+class shared_continuation_future
+{
+  private:
+    using state_type = continuation_state<T>;
+
+  public:
+    shared_continuation_future() = default;
+
+    explicit shared_continuation_future(std::shared_ptr<state_type> state)
+      : state_(std::move(state))
+    {}
+
+    shared_continuation_future(continuation_future<T>&& other)
+      : state_(other.share().state_)
+    {}
+
+    template<class... Args>
+    static shared_continuation_future make_ready(Args&&... args)
+    {
+      return continuation_future<T>::make_ready(std::forward<Args>(args)...).share();
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_);
+    }
+
+    bool is_ready() const
+    {
+      return state_->is_ready();
+    }
+
+    void wait() const
+    {
+      state_->wait();
+    }
+
+    // returns a reference to the shared value, or nothing when T is void
+    typename std::add_lvalue_reference<
+      typename std::add_const<T>::type
+    >::type
+      get() const
+    {
+      if(!valid())
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+
+      return get_impl(std::is_void<T>());
+    }
+
+    shared_continuation_future share() const
+    {
+      return *this;
+    }
+
+    // returns a future to the result of f applied to this future's value
+    // f is called by the thread which fulfills this future
+    // this future remains valid
+    template<class Function>
+    continuation_future<
+      continuation_future_detail::continuation_result_t<T,decay_t<Function>&>
+    >
+      then(Function&& f) const
+    {
+      using result_type = continuation_future_detail::continuation_result_t<T,decay_t<Function>&>;
+
+      auto successor_state = make_continuation_state<result_type>();
+
+      continuation_future_detail::attach_then(state_, successor_state, decay_t<Function>(std::forward<Function>(f)));
+
+      return continuation_future<result_type>(std::move(successor_state));
+    }
+
+    template<class Function>
+    void on_ready(Function&& f) const
+    {
+      state_->add_continuation(std::forward<Function>(f));
+    }
+
+  private:
+    void get_impl(std::true_type) const
+    {
+      state_->value();
+    }
+
+    const typename state_type::storage_type& get_impl(std::false_type) const
+    {
+      return state_->value();
+    }
+
+    std::shared_ptr<state_type> state_;
+};
+
+
+// a promise which fulfills a continuation_future
+template<class T>
+class continuation_promise
+{
+  private:
+    using state_type = continuation_state<T>;
+
+  public:
+    continuation_promise()
+      : state_(make_continuation_state<T>()),
+        future_retrieved_(false)
+    {}
+
+    continuation_promise(continuation_promise&&) = default;
+    continuation_promise& operator=(continuation_promise&&) = default;
+
+    // like std::promise, abandoning an unsatisfied promise breaks it
+    ~continuation_promise()
+    {
+      if(state_ && !state_->is_ready())
+      {
+        state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+      }
+    }
+
+    continuation_future<T> get_future()
+    {
+      if(future_retrieved_) throw std::future_error(std::future_errc::future_already_retrieved);
+
+      future_retrieved_ = true;
+      return continuation_future<T>(state_);
+    }
+
+    template<class... Args>
+    void set_value(Args&&... args)
+    {
+      state_->set_value(std::forward<Args>(args)...);
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+      state_->set_exception(e);
+    }
+
+  private:
+    std::shared_ptr<state_type> state_;
+    bool future_retrieved_;
+};
+
+
+// these overloads of then() & monadic_then() attach continuations to continuation futures
+// rather than blocking a new thread on the predecessor like the std::future overloads in <agency/future.hpp>
+
+template<class T, class Function>
+continuation_future<result_of_t<decay_t<Function>(continuation_future<T>&)>>
+  then(continuation_future<T>& fut, Function&& f)
+{
+  return fut.then_with_future(std::forward<Function>(f));
+}
+
+
+template<class T, class Function>
+continuation_future<result_of_t<decay_t<Function>(continuation_future<T>&)>>
+  then(continuation_future<T>& fut, std::launch, Function&& f)
+{
+  return fut.then_with_future(std::forward<Function>(f));
+}
+
+
+template<class T, class Function>
+auto monadic_then(continuation_future<T>& fut, Function&& f) ->
+  decltype(fut.then(std::forward<Function>(f)))
+{
+  return fut.then(std::forward<Function>(f));
+}
+
+
+template<class T, class Function>
+auto monadic_then(shared_continuation_future<T>& fut, Function&& f) ->
+  decltype(fut.then(std::forward<Function>(f)))
+{
+  return fut.then(std::forward<Function>(f));
+}
+
+
+// the launch policy is ignored: continuations of continuation futures always execute
+// on the thread which fulfills the predecessor
+template<class T, class Function>
+auto monadic_then(continuation_future<T>& fut, std::launch, Function&& f) ->
+  decltype(fut.then(std::forward<Function>(f)))
+{
+  return fut.then(std::forward<Function>(f));
+}
+
+
+template<class T, class Function>
+auto monadic_then(shared_continuation_future<T>& fut, std::launch, Function&& f) ->
+  decltype(fut.then(std::forward<Function>(f)))
+{
+  return fut.then(std::forward<Function>(f));
+}
+
+
+} // end detail
+} // end agency
+
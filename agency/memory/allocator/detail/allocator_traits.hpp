@@ -42,6 +42,10 @@ struct allocator_traits : std::allocator_traits<Alloc>
   __AGENCY_ANNOTATION
   static void destroy(Alloc& a, T* p);
 
+  template<class Iterator>
+  __AGENCY_ANNOTATION
+  static Iterator destroy_n(Alloc& a, Iterator first, size_t n);
+
   __AGENCY_ANNOTATION
   static size_type max_size(const Alloc& a);
 }; // end allocator_traits
@@ -53,5 +57,6 @@ struct allocator_traits : std::allocator_traits<Alloc>
 #include <agency/memory/allocator/detail/allocator_traits/construct.hpp>
 #include <agency/memory/allocator/detail/allocator_traits/construct_n.hpp>
 #include <agency/memory/allocator/detail/allocator_traits/destroy.hpp>
+#include <agency/memory/allocator/detail/allocator_traits/destroy_n.hpp>
 #include <agency/memory/allocator/detail/allocator_traits/max_size.hpp>
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <memory>
 #include <type_traits>
 
 namespace agency
@@ -87,6 +88,29 @@ template<class Alloc, class Pointer>
 using has_destroy = typename has_destroy_impl<Alloc,Pointer>::type;
 
 
+// std::allocator's construct() & destroy() are equivalent to placement new & calling the destructor,
+// so algorithms which can do better than that treat std::allocator as if it did not have them
+template<class Alloc>
+struct is_std_allocator : std::false_type {};
+
+template<class T>
+struct is_std_allocator<std::allocator<T>> : std::true_type {};
+
+
+template<class Alloc, class Pointer, class... Args>
+using has_custom_construct = std::integral_constant<
+  bool,
+  has_construct<Alloc,Pointer,Args...>::value && !is_std_allocator<Alloc>::value
+>;
+
+
+template<class Alloc, class Pointer>
+using has_custom_destroy = std::integral_constant<
+  bool,
+  has_destroy<Alloc,Pointer>::value && !is_std_allocator<Alloc>::value
+>;
+
+
 template<class Alloc>
 struct has_max_size_impl
 {
@@ -4,6 +4,9 @@
 #include <agency/memory/allocator/detail/allocator_traits.hpp>
 #include <agency/memory/allocator/detail/allocator_traits/check_for_member_functions.hpp>
 #include <memory>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
 
 namespace agency
 {
@@ -22,8 +25,8 @@ void swallow(Args&&...)
 
 // construct_n algorithm:
 // 1. If a.construct_n(...) is well-formed, use it. otherwise
-// 2. If a.construct(...) is well-formed, use it in a for loop. otherwise
-// 3. Use placement new in a for loop
+// 2. If a.construct(...) is well-formed and Alloc is not std::allocator, use it in a for loop. otherwise
+// 3. Use placement new in a for loop, or memset or memcpy when that is equivalent
 
 
 __agency_exec_check_disable__
@@ -43,7 +46,7 @@ __agency_exec_check_disable__
 template<class Alloc, class Iterator, class... Iterators>
 __AGENCY_ANNOTATION
 typename std::enable_if<
-  has_construct<Alloc,typename std::iterator_traits<Iterator>::pointer, typename std::iterator_traits<Iterators>::reference...>::value,
+  has_custom_construct<Alloc,typename std::iterator_traits<Iterator>::pointer, typename std::iterator_traits<Iterators>::reference...>::value,
   detail::tuple<Iterator,Iterators...>
 >::type
   construct_n_impl2(Alloc& a, Iterator first, size_t n, Iterators... iters)
@@ -57,14 +60,73 @@ typename std::enable_if<
 } // end construct_n_impl2()
 
 
+// value-initializing scalars other than pointers to members is equivalent to zeroing their bytes
+// a null pointer to data member is not all-zero bytes on some ABIs (e.g., it is -1 on the Itanium ABI),
+// so pointers to members, and the trivial classes which may contain them, are value-initialized with placement new
+template<class Iterator, class... Iterators>
+struct is_memset_constructible : std::false_type {};
+
+template<class T>
+struct is_memset_constructible<T*>
+  : std::integral_constant<
+      bool,
+      std::is_scalar<T>::value &&
+      !std::is_member_pointer<T>::value
+    >
+{};
+
+
+// copying trivially copyable objects is equivalent to copying their bytes
+template<class Iterator, class... Iterators>
+struct is_memcpy_constructible : std::false_type {};
+
+template<class T, class U>
+struct is_memcpy_constructible<T*,U*>
+  : std::integral_constant<
+      bool,
+      std::is_same<T, typename std::remove_cv<U>::type>::value &&
+      std::is_trivially_copyable<T>::value
+    >
+{};
+
+
+template<class T>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  is_memset_constructible<T*>::value,
+  detail::tuple<T*>
+>::type
+  construct_n_with_placement_new(T* first, size_t n)
+{
+  std::memset(first, 0, n * sizeof(T));
+
+  return detail::make_tuple(first + n);
+} // end construct_n_with_placement_new()
+
+
+template<class T, class U>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  is_memcpy_constructible<T*,U*>::value,
+  detail::tuple<T*,U*>
+>::type
+  construct_n_with_placement_new(T* first, size_t n, U* source)
+{
+  std::memcpy(first, source, n * sizeof(T));
+
+  return detail::make_tuple(first + n, source + n);
+} // end construct_n_with_placement_new()
+
+
 __agency_exec_check_disable__
-template<class Alloc, class Iterator, class... Iterators>
+template<class Iterator, class... Iterators>
 __AGENCY_ANNOTATION
 typename std::enable_if<
-  !has_construct<Alloc,typename std::iterator_traits<Iterator>::pointer, typename std::iterator_traits<Iterators>::reference...>::value,
+  !is_memset_constructible<Iterator,Iterators...>::value &&
+  !is_memcpy_constructible<Iterator,Iterators...>::value,
   detail::tuple<Iterator,Iterators...>
 >::type
-  construct_n_impl2(Alloc&, Iterator first, size_t n, Iterators... iters)
+  construct_n_with_placement_new(Iterator first, size_t n, Iterators... iters)
 {
   using value_type = typename std::iterator_traits<Iterator>::value_type;
 
@@ -74,6 +136,18 @@ typename std::enable_if<
   }
 
   return detail::make_tuple(first,iters...);
+} // end construct_n_with_placement_new()
+
+
+template<class Alloc, class Iterator, class... Iterators>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  !has_custom_construct<Alloc,typename std::iterator_traits<Iterator>::pointer, typename std::iterator_traits<Iterators>::reference...>::value,
+  detail::tuple<Iterator,Iterators...>
+>::type
+  construct_n_impl2(Alloc&, Iterator first, size_t n, Iterators... iters)
+{
+  return allocator_traits_detail::construct_n_with_placement_new(first, n, iters...);
 } // end construct_n_impl2()
 
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/memory/allocator/detail/allocator_traits.hpp>
+#include <agency/memory/allocator/detail/allocator_traits/check_for_member_functions.hpp>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace agency
+{
+namespace detail
+{
+namespace allocator_traits_detail
+{
+
+
+// destroy_n algorithm:
+// 1. If a.destroy(...) is well-formed and Alloc is not std::allocator, use it in a for loop. otherwise
+// 2. If the elements are trivially destructible, do nothing. otherwise
+// 3. Call the destructor in a for loop
+
+
+__agency_exec_check_disable__
+template<class Alloc, class Iterator>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  has_custom_destroy<Alloc,typename std::iterator_traits<Iterator>::pointer>::value,
+  Iterator
+>::type
+  destroy_n(Alloc& a, Iterator first, size_t n)
+{
+  for(size_t i = 0; i < n; ++i, ++first)
+  {
+    a.destroy(&*first);
+  }
+
+  return first;
+} // end destroy_n()
+
+
+template<class Alloc, class Iterator>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  !has_custom_destroy<Alloc,typename std::iterator_traits<Iterator>::pointer>::value &&
+  std::is_trivially_destructible<typename std::iterator_traits<Iterator>::value_type>::value,
+  Iterator
+>::type
+  destroy_n(Alloc&, Iterator first, size_t n)
+{
+  return first + n;
+} // end destroy_n()
+
+
+__agency_exec_check_disable__
+template<class Alloc, class Iterator>
+__AGENCY_ANNOTATION
+typename std::enable_if<
+  !has_custom_destroy<Alloc,typename std::iterator_traits<Iterator>::pointer>::value &&
+  !std::is_trivially_destructible<typename std::iterator_traits<Iterator>::value_type>::value,
+  Iterator
+>::type
+  destroy_n(Alloc&, Iterator first, size_t n)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  for(size_t i = 0; i < n; ++i, ++first)
+  {
+    first->~value_type();
+  }
+
+  return first;
+} // end destroy_n()
+
+
+} // end allocator_traits_detail
+
+
+template<class Alloc>
+  template<class Iterator>
+__AGENCY_ANNOTATION
+Iterator allocator_traits<Alloc>
+  ::destroy_n(Alloc& alloc, Iterator first, size_t n)
+{
+  return allocator_traits_detail::destroy_n(alloc, first, n);
+} // end allocator_traits::destroy_n()
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/tuple.hpp>
+#include <agency/detail/factory.hpp>
+#include <agency/detail/integer_sequence.hpp>
+#include <agency/memory/allocator/detail/allocator_traits.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/detail/utility/bulk_sync_execute_with_void_result.hpp>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+
+namespace agency
+{
+namespace detail
+{
+namespace bulk_construct_n_detail
+{
+
+
+// ranges smaller than this are not worth the cost of a bulk launch
+constexpr std::size_t min_bytes_per_chunk = std::size_t(1) << 18;
+
+
+template<class... Iterators>
+struct are_random_access_iterators;
+
+template<>
+struct are_random_access_iterators<> : std::true_type {};
+
+template<class Iterator, class... Iterators>
+struct are_random_access_iterators<Iterator,Iterators...>
+  : std::integral_constant<
+      bool,
+      std::is_convertible<
+        typename std::iterator_traits<Iterator>::iterator_category,
+        std::random_access_iterator_tag
+      >::value &&
+      are_random_access_iterators<Iterators...>::value
+    >
+{};
+
+
+// a range is constructed in parallel when the executor is flat, the range may be chunked,
+// and the constructor may not throw, because there is no one to catch an exception thrown by an agent
+template<class Executor, class Iterator, class... Iterators>
+struct is_bulk_constructible
+  : std::integral_constant<
+      bool,
+      std::is_same<executor_shape_t<Executor>, std::size_t>::value &&
+      are_random_access_iterators<Iterator,Iterators...>::value &&
+      std::is_nothrow_constructible<
+        typename std::iterator_traits<Iterator>::value_type,
+        typename std::iterator_traits<Iterators>::reference...
+      >::value
+    >
+{};
+
+
+template<class Executor, class Iterator>
+struct is_bulk_destructible
+  : std::integral_constant<
+      bool,
+      std::is_same<executor_shape_t<Executor>, std::size_t>::value &&
+      are_random_access_iterators<Iterator>::value
+    >
+{};
+
+
+// returns the number of chunks to divide n elements of type T into
+template<class T>
+std::size_t num_chunks(std::size_t n)
+{
+  std::size_t elements_per_chunk = std::max<std::size_t>(1, min_bytes_per_chunk / sizeof(T));
+  std::size_t result = (n + elements_per_chunk - 1) / elements_per_chunk;
+
+  return std::min<std::size_t>(result, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+
+template<class Alloc, class Iterator, class... Iterators>
+struct construct_chunk
+{
+  Alloc* alloc;
+  std::size_t n;
+  std::size_t chunk_size;
+  Iterator first;
+  detail::tuple<Iterators...> iters;
+
+  template<std::size_t... Indices>
+  void construct(std::size_t begin, std::size_t end, index_sequence<Indices...>) const
+  {
+    allocator_traits<Alloc>::construct_n(*alloc, first + begin, end - begin, (detail::get<Indices>(iters) + begin)...);
+  }
+
+  template<class Unit>
+  void operator()(std::size_t chunk_idx, Unit&) const
+  {
+    std::size_t begin = std::min(n, chunk_idx * chunk_size);
+    std::size_t end = std::min(n, begin + chunk_size);
+
+    construct(begin, end, make_index_sequence<sizeof...(Iterators)>());
+  }
+};
+
+
+template<class Alloc, class Iterator>
+struct destroy_chunk
+{
+  Alloc* alloc;
+  std::size_t n;
+  std::size_t chunk_size;
+  Iterator first;
+
+  template<class Unit>
+  void operator()(std::size_t chunk_idx, Unit&) const
+  {
+    std::size_t begin = std::min(n, chunk_idx * chunk_size);
+    std::size_t end = std::min(n, begin + chunk_size);
+
+    allocator_traits<Alloc>::destroy_n(*alloc, first + begin, end - begin);
+  }
+};
+
+
+template<class Executor, class Alloc, class Iterator, class... Iterators>
+detail::tuple<Iterator,Iterators...> bulk_construct_n(std::false_type, Executor&, Alloc& alloc, Iterator first, std::size_t n, Iterators... iters)
+{
+  return allocator_traits<Alloc>::construct_n(alloc, first, n, iters...);
+}
+
+
+template<class Executor, class Alloc, class Iterator, class... Iterators>
+detail::tuple<Iterator,Iterators...> bulk_construct_n(std::true_type, Executor& exec, Alloc& alloc, Iterator first, std::size_t n, Iterators... iters)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  std::size_t num_chunks = bulk_construct_n_detail::num_chunks<value_type>(n);
+
+  if(num_chunks < 2)
+  {
+    return allocator_traits<Alloc>::construct_n(alloc, first, n, iters...);
+  }
+
+  std::size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+
+  construct_chunk<Alloc,Iterator,Iterators...> f{&alloc, n, chunk_size, first, detail::make_tuple(iters...)};
+
+  detail::bulk_sync_execute_with_void_result(exec, f, num_chunks, unit_factory());
+
+  return detail::make_tuple(first + n, (iters + n)...);
+}
+
+
+template<class Executor, class Alloc, class Iterator>
+Iterator bulk_destroy_n(std::false_type, Executor&, Alloc& alloc, Iterator first, std::size_t n)
+{
+  return allocator_traits<Alloc>::destroy_n(alloc, first, n);
+}
+
+
+template<class Executor, class Alloc, class Iterator>
+Iterator bulk_destroy_n(std::true_type, Executor& exec, Alloc& alloc, Iterator first, std::size_t n)
+{
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  std::size_t num_chunks = bulk_construct_n_detail::num_chunks<value_type>(n);
+
+  // there's no work to distribute when destruction is a no-op
+  if(num_chunks < 2 ||
+     (std::is_trivially_destructible<value_type>::value &&
+      !allocator_traits_detail::has_custom_destroy<Alloc, typename std::iterator_traits<Iterator>::pointer>::value))
+  {
+    return allocator_traits<Alloc>::destroy_n(alloc, first, n);
+  }
+
+  std::size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+
+  destroy_chunk<Alloc,Iterator> f{&alloc, n, chunk_size, first};
+
+  detail::bulk_sync_execute_with_void_result(exec, f, num_chunks, unit_factory());
+
+  return first + n;
+}
+
+
+} // end bulk_construct_n_detail
+
+
+// bulk_construct_n() is allocator_traits<Alloc>::construct_n() parallelized across the agents of a bulk executor
+// large ranges are divided into chunks of contiguous elements, and each agent constructs a chunk with allocator_traits<Alloc>::construct_n()
+// so that the elements of trivial types are still constructed with memset & memcpy
+// small ranges, ranges whose constructor may throw, and ranges which cannot be chunked are constructed by the calling thread
+// note that basic_ndarray forward declares this function, so its signature should not change
+template<class Executor, class Alloc, class Iterator, class... Iterators>
+detail::tuple<Iterator,Iterators...> bulk_construct_n(Executor& exec, Alloc& alloc, Iterator first, std::size_t n, Iterators... iters)
+{
+  return bulk_construct_n_detail::bulk_construct_n(
+    bulk_construct_n_detail::is_bulk_constructible<Executor,Iterator,Iterators...>(),
+    exec, alloc, first, n, iters...
+  );
+}
+
+
+// bulk_destroy_n() is allocator_traits<Alloc>::destroy_n() parallelized across the agents of a bulk executor
+template<class Executor, class Alloc, class Iterator>
+Iterator bulk_destroy_n(Executor& exec, Alloc& alloc, Iterator first, std::size_t n)
+{
+  return bulk_construct_n_detail::bulk_destroy_n(
+    bulk_construct_n_detail::is_bulk_destructible<Executor,Iterator>(),
+    exec, alloc, first, n
+  );
+}
+
+
+} // end detail
+} // end agency
+
@@ -2,71 +2,445 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/singleton.hpp>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <mutex>
 #include <map>
+#include <vector>
+#include <utility>
 
 namespace agency
 {
 namespace detail
 {
+namespace cached_resource_detail
+{
+
+
+// blocks are binned into power-of-two size classes
+// size class c holds blocks of min_block_size << c bytes
+constexpr std::size_t min_block_size = 16;
+
+// the largest size class holds blocks of 1 GiB
+// larger allocations bypass the cache
+constexpr std::size_t num_size_classes = 27;
+
+// a thread caches at most this many blocks of each size class in its magazine
+constexpr std::size_t max_magazine_capacity = 32;
+
+// ...and at most roughly this many bytes, so magazines of large blocks hold few blocks
+constexpr std::size_t max_magazine_bytes = 64 * 1024;
+
+// by default, a depot caches at most this many bytes of free blocks
+constexpr std::size_t default_high_water_mark = std::size_t(256) << 20;
+
+
+// returns num_size_classes when num_bytes is too large to be cached
+inline std::size_t size_class(std::size_t num_bytes)
+{
+  std::size_t c = 0;
+  for(std::size_t block_size = min_block_size; block_size < num_bytes && c < num_size_classes; block_size <<= 1)
+  {
+    ++c;
+  }
+
+  return c;
+}
+
+inline std::size_t block_size(std::size_t c)
+{
+  return min_block_size << c;
+}
+
+inline std::size_t magazine_capacity(std::size_t c)
+{
+  return std::max<std::size_t>(1, std::min(max_magazine_capacity, max_magazine_bytes / block_size(c)));
+}
+
+
+// a magazine is a stack of free blocks of a single size class
+struct magazine
+{
+  std::size_t size;
+  void* blocks[max_magazine_capacity];
+};
 
 
+// a depot is the part of a cached_resource shared by all threads
+// it owns the upstream resource and a collection of full magazines of each size class
+// threads exchange whole magazines with the depot, so the depot's locks are taken
+// at most once per batch of allocations or deallocations
 template<class MemoryResource>
-class cached_resource : private MemoryResource
+class depot
+{
+  public:
+    explicit depot(const MemoryResource& resource)
+      : is_global(false),
+        resource_(resource),
+        high_water_mark_(default_high_water_mark),
+        num_cached_bytes_(0)
+    {}
+
+    ~depot()
+    {
+      // swallow any exceptions thrown by the upstream resource
+      // in order to avoid propagating exceptions out of destructors
+      try
+      {
+        trim();
+      }
+      catch(...)
+      {
+      }
+    }
+
+    // true when this depot belongs to the cached_resource which globally_cached_resource uses for resource()
+    bool is_global;
+
+    MemoryResource& resource()
+    {
+      return resource_;
+    }
+
+    // replaces the empty magazine mag with a full magazine from the depot
+    // returns false if the depot has no magazines of size class c
+    bool try_refill(std::size_t c, magazine& mag)
+    {
+      std::lock_guard<std::mutex> guard(mutexes_[c]);
+
+      if(magazines_[c].empty()) return false;
+
+      mag = magazines_[c].back();
+      magazines_[c].pop_back();
+
+      num_cached_bytes_.fetch_sub(mag.size * block_size(c), std::memory_order_relaxed);
+
+      return true;
+    }
+
+    // empties mag into the depot, or into the upstream resource if the depot would exceed its high water mark
+    void flush(std::size_t c, magazine& mag)
+    {
+      std::size_t num_bytes = mag.size * block_size(c);
+
+      if(num_cached_bytes_.fetch_add(num_bytes, std::memory_order_relaxed) + num_bytes <= high_water_mark_.load(std::memory_order_relaxed))
+      {
+        std::lock_guard<std::mutex> guard(mutexes_[c]);
+        magazines_[c].push_back(mag);
+      }
+      else
+      {
+        num_cached_bytes_.fetch_sub(num_bytes, std::memory_order_relaxed);
+        release(c, mag);
+      }
+
+      mag.size = 0;
+    }
+
+    // returns the blocks of mag to the upstream resource
+    void release(std::size_t c, magazine& mag)
+    {
+      for(std::size_t i = 0; i < mag.size; ++i)
+      {
+        resource_.deallocate(mag.blocks[i], block_size(c));
+      }
+
+      mag.size = 0;
+    }
+
+    // returns every block cached in the depot to the upstream resource
+    void trim()
+    {
+      for(std::size_t c = 0; c < num_size_classes; ++c)
+      {
+        std::vector<magazine> magazines;
+
+        {
+          std::lock_guard<std::mutex> guard(mutexes_[c]);
+          magazines.swap(magazines_[c]);
+        }
+
+        for(auto& mag : magazines)
+        {
+          num_cached_bytes_.fetch_sub(mag.size * block_size(c), std::memory_order_relaxed);
+          release(c, mag);
+        }
+      }
+    }
+
+    std::size_t high_water_mark() const
+    {
+      return high_water_mark_.load(std::memory_order_relaxed);
+    }
+
+    void set_high_water_mark(std::size_t num_bytes)
+    {
+      high_water_mark_.store(num_bytes, std::memory_order_relaxed);
+
+      if(cached_bytes() > num_bytes)
+      {
+        trim();
+      }
+    }
+
+    std::size_t cached_bytes() const
+    {
+      return num_cached_bytes_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    MemoryResource           resource_;
+    std::mutex               mutexes_[num_size_classes];
+    std::vector<magazine>    magazines_[num_size_classes];
+    std::atomic<std::size_t> high_water_mark_;
+    std::atomic<std::size_t> num_cached_bytes_;
+};
+
+
+// a thread's magazines for a single depot
+template<class MemoryResource>
+class thread_magazines
+{
+  public:
+    explicit thread_magazines(const std::shared_ptr<depot<MemoryResource>>& d)
+      : depot_(d)
+    {
+      for(auto& mag : magazines_)
+      {
+        mag.size = 0;
+      }
+    }
+
+    ~thread_magazines()
+    {
+      flush();
+    }
+
+    const std::shared_ptr<depot<MemoryResource>>& get_depot() const
+    {
+      return depot_;
+    }
+
+    void* allocate(std::size_t c)
+    {
+      magazine& mag = magazines_[c];
+
+      if(mag.size == 0 && !depot_->try_refill(c, mag))
+      {
+        return depot_->resource().allocate(block_size(c));
+      }
+
+      return mag.blocks[--mag.size];
+    }
+
+    void deallocate(void* ptr, std::size_t c)
+    {
+      magazine& mag = magazines_[c];
+
+      if(mag.size == magazine_capacity(c))
+      {
+        depot_->flush(c, mag);
+      }
+
+      mag.blocks[mag.size++] = ptr;
+    }
+
+    // returns every block in these magazines to the depot
+    void flush()
+    {
+      for(std::size_t c = 0; c < num_size_classes; ++c)
+      {
+        if(magazines_[c].size > 0)
+        {
+          depot_->flush(c, magazines_[c]);
+        }
+      }
+    }
+
+  private:
+    std::shared_ptr<depot<MemoryResource>> depot_;
+    magazine magazines_[num_size_classes];
+};
+
+
+// a thread's magazines for each depot it has used
+// each set of magazines keeps its depot alive until the thread exits
+template<class MemoryResource>
+class thread_cache
+{
+  public:
+    explicit thread_cache(bool& is_destroyed)
+      : is_destroyed_(is_destroyed)
+    {}
+
+    ~thread_cache()
+    {
+      // return this thread's blocks to their depots before the depots may be destroyed
+      entries_.clear();
+
+      is_destroyed_ = true;
+    }
+
+    thread_magazines<MemoryResource>* find(const depot<MemoryResource>* d)
+    {
+      for(auto& entry : entries_)
+      {
+        if(entry->get_depot().get() == d) return entry.get();
+      }
+
+      return nullptr;
+    }
+
+    // finds this thread's magazines for the global depot of resource
+    thread_magazines<MemoryResource>* find_global(const MemoryResource& resource)
+    {
+      for(auto& entry : entries_)
+      {
+        if(entry->get_depot()->is_global && entry->get_depot()->resource() == resource) return entry.get();
+      }
+
+      return nullptr;
+    }
+
+    thread_magazines<MemoryResource>& find_or_insert(const std::shared_ptr<depot<MemoryResource>>& d)
+    {
+      thread_magazines<MemoryResource>* result = find(d.get());
+
+      if(!result)
+      {
+        entries_.emplace_back(new thread_magazines<MemoryResource>(d));
+        result = entries_.back().get();
+      }
+
+      return *result;
+    }
+
+    void erase(const depot<MemoryResource>* d)
+    {
+      auto new_end = std::remove_if(entries_.begin(), entries_.end(), [=](const std::unique_ptr<thread_magazines<MemoryResource>>& entry)
+      {
+        return entry->get_depot().get() == d;
+      });
+
+      entries_.erase(new_end, entries_.end());
+    }
+
+  private:
+    bool& is_destroyed_;
+    std::vector<std::unique_ptr<thread_magazines<MemoryResource>>> entries_;
+};
+
+
+// returns this thread's cache, or nullptr if this thread is exiting
+template<class MemoryResource>
+inline thread_cache<MemoryResource>* this_thread_cache()
+{
+  // thread_local objects of trivial type are zero-initialized
+  static thread_local bool is_destroyed;
+  static thread_local thread_cache<MemoryResource> cache(is_destroyed);
+
+  return is_destroyed ? nullptr : &cache;
+}
+
+
+} // end cached_resource_detail
+
+
+// cached_resource caches the blocks deallocated through it for reuse by later allocations
+//
+// blocks are binned into power-of-two size classes. each thread keeps a magazine of free blocks
+// per size class, so most allocations and deallocations touch only thread-local state
+// empty magazines are refilled, and full magazines are emptied, in batches through a depot shared by all threads
+// once the depot caches more than high_water_mark() bytes, further deallocations go to the upstream resource
+//
+// cached_resource is safe to use from multiple threads concurrently
+// blocks must be deallocated with the same size they were allocated with
+template<class MemoryResource>
+class cached_resource
 {
   public:
     using resource_type = MemoryResource;
 
-    // inherit the base resource's constructors
-    using resource_type::resource_type;
+    cached_resource()
+      : cached_resource(resource_type())
+    {}
 
-    cached_resource() = default;
+    explicit cached_resource(const resource_type& resource)
+      : depot_(std::make_shared<depot_type>(resource))
+    {}
 
     cached_resource(const cached_resource&) = delete;
 
     cached_resource(cached_resource&&) = default;
 
+    // returns the blocks cached in the depot and in the calling thread's magazines to the upstream resource
+    // blocks cached by other threads are returned when those threads exit
     ~cached_resource()
     {
-      deallocate_free_blocks();
+      if(depot_)
+      {
+        cached_resource_detail::thread_cache<resource_type>* cache = cached_resource_detail::this_thread_cache<resource_type>();
+        if(cache)
+        {
+          cache->erase(depot_.get());
+        }
+
+        // swallow any exceptions thrown by the upstream resource
+        // in order to avoid propagating exceptions out of destructors
+        try
+        {
+          depot_->trim();
+        }
+        catch(...)
+        {
+        }
+      }
     }
 
     void* allocate(size_t num_bytes)
     {
-      void* ptr = nullptr;
+      return allocate(depot_, num_bytes);
+    }
 
-      // XXX this searches for a block of exactly the right size, but
-      //     in general we could look for anything that fits, which is just
-      //     the textbook malloc implementation
-      auto free_block = free_blocks_.find(num_bytes);
-      if(free_block != free_blocks_.end())
-      {
-        ptr = free_block->second;
+    void deallocate(void* ptr, size_t num_bytes)
+    {
+      deallocate(depot_, ptr, num_bytes);
+    }
 
-        // erase from the free blocks map
-        free_blocks_.erase(free_block);
-      }
-      else
+    // returns the blocks cached in the depot and in the calling thread's magazines to the upstream resource
+    void trim()
+    {
+      cached_resource_detail::thread_cache<resource_type>* cache = cached_resource_detail::this_thread_cache<resource_type>();
+      if(cache)
       {
-        // no allocation of the right size exists
-        // create a new allocation with the base resource
-        ptr = resource_type::allocate(num_bytes);
+        cached_resource_detail::thread_magazines<resource_type>* magazines = cache->find(depot_.get());
+        if(magazines)
+        {
+          magazines->flush();
+        }
       }
 
-      // insert the allocation into the allocated_blocks map
-      allocated_blocks_.insert(std::make_pair(ptr, num_bytes));
+      depot_->trim();
+    }
 
-      return ptr;
+    // the number of bytes of free blocks the depot may cache before deallocations bypass it
+    size_t high_water_mark() const
+    {
+      return depot_->high_water_mark();
     }
 
-    void deallocate(void* ptr, size_t num_bytes)
+    void set_high_water_mark(size_t num_bytes)
     {
-      // erase the allocation from the allocated blocks map
-      auto found = allocated_blocks_.find(reinterpret_cast<char*>(ptr));
-      allocated_blocks_.erase(found);
+      depot_->set_high_water_mark(num_bytes);
+    }
 
-      // insert the block into the free blocks map
-      free_blocks_.insert(std::make_pair(num_bytes, reinterpret_cast<char*>(ptr)));
+    // the number of bytes of free blocks cached in the depot
+    // this does not include blocks cached in threads' magazines
+    size_t cached_bytes() const
+    {
+      return depot_->cached_bytes();
     }
 
     // the trailing return type of this function enables or disables it (via SFINAE)
@@ -76,7 +450,7 @@ class cached_resource : private MemoryResource
     auto construct_n(Iterator first, size_t n, Iterators... iters) ->
       decltype(std::declval<DeducedMemoryResource&>().construct_n(first, n, iters...))
     {
-      return resource_type::construct_n(first, n, iters...);
+      return depot_->resource().construct_n(first, n, iters...);
     }
 
     bool operator==(const cached_resource& other) const
@@ -90,34 +464,52 @@ class cached_resource : private MemoryResource
     }
 
   private:
-    using free_blocks_type = std::multimap<size_t, void*>;
-    using allocated_blocks_type = std::map<void*, size_t>;
-    
-    free_blocks_type      free_blocks_;
-    allocated_blocks_type allocated_blocks_;
+    using depot_type = cached_resource_detail::depot<resource_type>;
+
+    template<class> friend class globally_cached_resource;
 
-    void deallocate_free_blocks()
+    template<class OtherMemoryResource>
+    friend cached_resource<OtherMemoryResource>* find_cached_resource_in_singleton(const OtherMemoryResource&);
+
+    static void* allocate(const std::shared_ptr<depot_type>& d, size_t num_bytes)
     {
-      for(auto b : free_blocks_)
+      size_t c = cached_resource_detail::size_class(num_bytes);
+
+      if(c == cached_resource_detail::num_size_classes)
       {
-        // since this is only called from the destructor,
-        // swallow any exceptions thrown by this call to
-        // deallocate in order to avoid propagating exceptions
-        // out of destructors
-        try
-        {
-          resource_type::deallocate(b.second, b.first);
-        }
-        catch(...)
-        {
-          // just swallow any exceptions we encounter
-        }
+        return d->resource().allocate(num_bytes);
+      }
+
+      cached_resource_detail::thread_cache<resource_type>* cache = cached_resource_detail::this_thread_cache<resource_type>();
+      if(!cache)
+      {
+        return d->resource().allocate(cached_resource_detail::block_size(c));
+      }
+
+      return cache->find_or_insert(d).allocate(c);
+    }
+
+    static void deallocate(const std::shared_ptr<depot_type>& d, void* ptr, size_t num_bytes)
+    {
+      size_t c = cached_resource_detail::size_class(num_bytes);
+
+      if(c == cached_resource_detail::num_size_classes)
+      {
+        d->resource().deallocate(ptr, num_bytes);
+        return;
+      }
+
+      cached_resource_detail::thread_cache<resource_type>* cache = cached_resource_detail::this_thread_cache<resource_type>();
+      if(!cache)
+      {
+        d->resource().deallocate(ptr, cached_resource_detail::block_size(c));
+        return;
       }
-      free_blocks_.clear();
 
-      // note that we do not attempt to deallocate allocated blocks
-      // that's the user's responsibility
+      cache->find_or_insert(d).deallocate(ptr, c);
     }
+
+    std::shared_ptr<depot_type> depot_;
 };
 
 
@@ -136,38 +528,45 @@ inline cached_resources_singleton_t<MemoryResource>* cached_resources_singleton(
 }
 
 
+// returns the cached_resource associated with the given resource, or nullptr if the singleton has been destroyed
 template<class MemoryResource>
-inline void* allocate_from_cached_resources_singleton(const MemoryResource& resource, size_t num_bytes)
+inline cached_resource<MemoryResource>* find_cached_resource_in_singleton(const MemoryResource& resource)
 {
-  void* result = nullptr;
-
   cached_resources_singleton_t<MemoryResource>* resources_ptr = cached_resources_singleton<MemoryResource>();
 
-  if(resources_ptr)
-  {
-    // lock the resources
-    std::lock_guard<std::mutex> guard(resources_ptr->mutex);
+  if(!resources_ptr) return nullptr;
 
-    // allocate using the cached resource associated with the given resource
-    result = resources_ptr->cached_resources[resource].allocate(num_bytes);
+  // lock the resources
+  std::lock_guard<std::mutex> guard(resources_ptr->mutex);
+
+  auto found = resources_ptr->cached_resources.find(resource);
+  if(found == resources_ptr->cached_resources.end())
+  {
+    found = resources_ptr->cached_resources.emplace(resource, cached_resource<MemoryResource>(resource)).first;
+    found->second.depot_->is_global = true;
   }
 
-  return result;
+  return &found->second;
+}
+
+
+template<class MemoryResource>
+inline void* allocate_from_cached_resources_singleton(const MemoryResource& resource, size_t num_bytes)
+{
+  cached_resource<MemoryResource>* cached = find_cached_resource_in_singleton(resource);
+
+  return cached ? cached->allocate(num_bytes) : nullptr;
 }
 
 
 template<class MemoryResource>
 inline void deallocate_from_cached_resources_singleton(const MemoryResource& resource, void* ptr, size_t num_bytes)
 {
-  cached_resources_singleton_t<MemoryResource>* resources_ptr = cached_resources_singleton<MemoryResource>();
+  cached_resource<MemoryResource>* cached = find_cached_resource_in_singleton(resource);
 
-  if(resources_ptr)
+  if(cached)
   {
-    // lock the resources
-    std::lock_guard<std::mutex> guard(resources_ptr->mutex);
-
-    // deallocate using the cached resource associated with the given resource
-    resources_ptr->cached_resources[resource].deallocate(ptr, num_bytes);
+    cached->deallocate(ptr, num_bytes);
   }
 }
 
@@ -188,11 +587,25 @@ class globally_cached_resource
 
     inline void* allocate(size_t num_bytes)
     {
+      // when this thread has already used the cache for resource_, avoid locking the singleton
+      cached_resource_detail::thread_magazines<MemoryResource>* magazines = this_thread_magazines();
+      if(magazines)
+      {
+        return cached_resource<MemoryResource>::allocate(magazines->get_depot(), num_bytes);
+      }
+
       return allocate_from_cached_resources_singleton(resource_, num_bytes);
     }
 
     inline void deallocate(void *ptr, size_t num_bytes)
     {
+      cached_resource_detail::thread_magazines<MemoryResource>* magazines = this_thread_magazines();
+      if(magazines)
+      {
+        cached_resource<MemoryResource>::deallocate(magazines->get_depot(), ptr, num_bytes);
+        return;
+      }
+
       deallocate_from_cached_resources_singleton(resource_, ptr, num_bytes);
     }
 
@@ -216,6 +629,13 @@ class globally_cached_resource
     }
 
   private:
+    cached_resource_detail::thread_magazines<MemoryResource>* this_thread_magazines() const
+    {
+      cached_resource_detail::thread_cache<MemoryResource>* cache = cached_resource_detail::this_thread_cache<MemoryResource>();
+
+      return cache ? cache->find_global(resource_) : nullptr;
+    }
+
     MemoryResource resource_;
 };
 
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/cached_resource.hpp>
+#include <cstddef>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// chunked_arena_resource is a monotonic memory resource for the lifetime of a single group of agents
+//
+// allocations are carved from a buffer of InitialSize bytes stored inside the resource itself
+// when the current chunk is exhausted, a new chunk, twice as large as the previous, is obtained from
+// UpstreamResource and chained to the others
+// like arena_resource, deallocate() only reclaims the most recent allocation
+// all chunks are returned to UpstreamResource at once by release() or by the destructor
+template<std::size_t InitialSize, class UpstreamResource, std::size_t alignment = alignof(std::max_align_t)>
+class chunked_arena_resource : private UpstreamResource
+{
+  private:
+    // each chunk begins with a header which links it to the previous chunk
+    struct chunk_header
+    {
+      chunk_header* previous;
+      std::size_t size;
+    };
+
+    static constexpr std::size_t header_size = (sizeof(chunk_header) + (alignment-1)) & ~(alignment-1);
+
+    static constexpr std::size_t min_chunk_size = 2 * (InitialSize < header_size ? header_size : InitialSize);
+
+    alignas(alignment) char initial_buffer_[InitialSize == 0 ? 1 : InitialSize];
+    char* ptr_to_first_free_byte_;
+    char* end_of_current_chunk_;
+    chunk_header* current_chunk_;
+    std::size_t next_chunk_size_;
+
+  public:
+    using upstream_resource_type = UpstreamResource;
+
+    __AGENCY_ANNOTATION
+    chunked_arena_resource() noexcept
+      : ptr_to_first_free_byte_(initial_buffer_),
+        end_of_current_chunk_(initial_buffer_ + InitialSize),
+        current_chunk_(nullptr),
+        next_chunk_size_(min_chunk_size)
+    {}
+
+    __AGENCY_ANNOTATION
+    chunked_arena_resource(const chunked_arena_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    chunked_arena_resource& operator=(const chunked_arena_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    ~chunked_arena_resource()
+    {
+      release();
+    }
+
+    __AGENCY_ANNOTATION
+    void* allocate(std::size_t n)
+    {
+      std::size_t aligned_n = align_up(n);
+
+      if(aligned_n > capacity())
+      {
+        if(!grow(next_chunk_size(aligned_n))) return nullptr;
+      }
+
+      char* result = ptr_to_first_free_byte_;
+      ptr_to_first_free_byte_ += aligned_n;
+      return result;
+    }
+
+    __AGENCY_ANNOTATION
+    void deallocate(void* p_, std::size_t n) noexcept
+    {
+      char* p = reinterpret_cast<char*>(p_);
+
+      if(p + align_up(n) == ptr_to_first_free_byte_)
+      {
+        ptr_to_first_free_byte_ = p;
+      }
+    }
+
+    // ensures that the next n bytes of allocations are carved from the current chunk
+    // if the current chunk is too small, a chunk with exactly enough room for n bytes is obtained from the upstream resource
+    // note that each allocation consumes its size rounded up to a multiple of alignment
+    // returns false if the upstream resource fails to allocate
+    __AGENCY_ANNOTATION
+    bool reserve(std::size_t n)
+    {
+      std::size_t aligned_n = align_up(n);
+
+      if(aligned_n <= capacity()) return true;
+
+      return grow(header_size + aligned_n);
+    }
+
+    // the number of bytes which may be allocated before the arena must grow
+    __AGENCY_ANNOTATION
+    std::size_t capacity() const noexcept
+    {
+      return static_cast<std::size_t>(end_of_current_chunk_ - ptr_to_first_free_byte_);
+    }
+
+    // returns every chunk to the upstream resource and begins allocating from the initial buffer again
+    __AGENCY_ANNOTATION
+    void release()
+    {
+      while(current_chunk_)
+      {
+        chunk_header* previous = current_chunk_->previous;
+        upstream_resource_type::deallocate(current_chunk_, current_chunk_->size);
+        current_chunk_ = previous;
+      }
+
+      ptr_to_first_free_byte_ = initial_buffer_;
+      end_of_current_chunk_ = initial_buffer_ + InitialSize;
+      next_chunk_size_ = min_chunk_size;
+    }
+
+    __AGENCY_ANNOTATION
+    static constexpr std::size_t initial_size() noexcept
+    {
+      return InitialSize;
+    }
+
+    // the number of chunks obtained from the upstream resource
+    __AGENCY_ANNOTATION
+    std::size_t num_chunks() const noexcept
+    {
+      std::size_t result = 0;
+      for(chunk_header* c = current_chunk_; c; c = c->previous)
+      {
+        ++result;
+      }
+
+      return result;
+    }
+
+    __AGENCY_ANNOTATION
+    bool owns(void*, std::size_t) const noexcept
+    {
+      // every allocation is owned by the arena until release()
+      return true;
+    }
+
+    __AGENCY_ANNOTATION
+    bool operator==(const chunked_arena_resource& other) const
+    {
+      return this == &other;
+    }
+
+    __AGENCY_ANNOTATION
+    bool operator!=(const chunked_arena_resource& other) const
+    {
+      return this != &other;
+    }
+
+  private:
+    __AGENCY_ANNOTATION
+    static std::size_t align_up(std::size_t n) noexcept
+    {
+      return (n + (alignment-1)) & ~(alignment-1);
+    }
+
+    // returns the size of the next chunk in the geometric sequence which has room for n bytes
+    __AGENCY_ANNOTATION
+    std::size_t next_chunk_size(std::size_t n) const noexcept
+    {
+      std::size_t result = next_chunk_size_;
+      while(result < header_size + n)
+      {
+        result *= 2;
+      }
+
+      return result;
+    }
+
+    // chains a new chunk of chunk_size bytes
+    __AGENCY_ANNOTATION
+    bool grow(std::size_t chunk_size)
+    {
+      chunk_header* chunk = reinterpret_cast<chunk_header*>(upstream_resource_type::allocate(chunk_size));
+      if(!chunk) return false;
+
+      chunk->previous = current_chunk_;
+      chunk->size = chunk_size;
+      current_chunk_ = chunk;
+
+      ptr_to_first_free_byte_ = reinterpret_cast<char*>(chunk) + header_size;
+      end_of_current_chunk_ = reinterpret_cast<char*>(chunk) + chunk_size;
+
+      if(chunk_size >= next_chunk_size_)
+      {
+        next_chunk_size_ = 2 * chunk_size;
+      }
+
+      return true;
+    }
+};
+
+
+// the upstream resource of the cache of arena chunks
+// it is a distinct type so that arena chunks are cached apart from other globally cached allocations
+struct arena_chunk_malloc_resource : malloc_resource
+{
+  inline bool operator<(const arena_chunk_malloc_resource&) const
+  {
+    return false;
+  }
+};
+
+
+// arena_chunk_resource is the upstream resource of concurrent groups' chunked_arena_resources
+//
+// in host code, chunks are recycled through a globally_cached_resource dedicated to arena chunks,
+// so the groups of successive launches reuse the same chunks instead of calling malloc
+// in device code, chunks are obtained from malloc
+struct arena_chunk_resource
+{
+  __AGENCY_ANNOTATION
+  inline void* allocate(std::size_t num_bytes)
+  {
+#ifndef __CUDA_ARCH__
+    return globally_cached_resource<arena_chunk_malloc_resource>().allocate(num_bytes);
+#else
+    return malloc_resource().allocate(num_bytes);
+#endif
+  }
+
+  __AGENCY_ANNOTATION
+  inline void deallocate(void* ptr, std::size_t num_bytes)
+  {
+#ifndef __CUDA_ARCH__
+    globally_cached_resource<arena_chunk_malloc_resource>().deallocate(ptr, num_bytes);
+#else
+    malloc_resource().deallocate(ptr, num_bytes);
+#endif
+  }
+
+  __AGENCY_ANNOTATION
+  inline bool operator==(const arena_chunk_resource&) const
+  {
+    return true;
+  }
+
+  __AGENCY_ANNOTATION
+  inline bool operator!=(const arena_chunk_resource&) const
+  {
+    return false;
+  }
+};
+
+
+} // end detail
+} // end agency
+
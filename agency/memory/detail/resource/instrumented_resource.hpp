@@ -0,0 +1,469 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/singleton.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace agency
+{
+namespace detail
+{
+namespace instrumented_resource_detail
+{
+
+
+// size bin b counts allocations of at most 2^b bytes which do not fit in bin b - 1
+constexpr std::size_t num_size_bins = 8 * sizeof(std::size_t) + 1;
+
+// a thread publishes the change in its live bytes once the change reaches this many bytes
+// so peak_bytes_live is accurate to within this many bytes per thread
+constexpr std::int64_t publication_threshold = 64 * 1024;
+
+// a thread remembers where its counters are for this many resource_counters objects
+// lookups for further resource_counters take a lock
+constexpr std::size_t thread_cache_capacity = 8;
+
+
+inline std::size_t size_bin(std::size_t num_bytes)
+{
+  std::size_t b = 0;
+  while(b < num_size_bins - 1 && (std::size_t(1) << b) < num_bytes)
+  {
+    ++b;
+  }
+
+  return b;
+}
+
+
+// counters are written only by their thread, so they are incremented without read-modify-write operations
+// they are atomic so that snapshot() may read them concurrently
+inline void increment(std::atomic<std::uint64_t>& counter, std::uint64_t n)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+
+struct thread_counters
+{
+  explicit thread_counters(std::thread::id id)
+    : thread_id(id),
+      num_allocations(0),
+      num_deallocations(0),
+      num_failed_allocations(0),
+      bytes_allocated(0),
+      bytes_deallocated(0),
+      unpublished_peak_bytes(0),
+      unpublished_bytes(0)
+  {
+    for(auto& bin : size_histogram)
+    {
+      bin.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::thread::id thread_id;
+
+  std::atomic<std::uint64_t> num_allocations;
+  std::atomic<std::uint64_t> num_deallocations;
+  std::atomic<std::uint64_t> num_failed_allocations;
+  std::atomic<std::uint64_t> bytes_allocated;
+  std::atomic<std::uint64_t> bytes_deallocated;
+  std::atomic<std::uint64_t> size_histogram[num_size_bins];
+
+  // the largest value of unpublished_bytes since it was last published
+  std::atomic<std::int64_t> unpublished_peak_bytes;
+
+  // the change in live bytes by this thread which has not yet been added to resource_counters' live bytes
+  // only this thread touches it
+  std::int64_t unpublished_bytes;
+};
+
+
+// each thread caches the locations of its counters in the resource_counters it has recently used
+// the cache is trivially destructible so that it remains usable while the thread's other thread_local objects,
+// e.g. the magazines of a cached_resource, return memory to an instrumented_resource at thread exit
+struct thread_cache
+{
+  std::uint64_t ids[thread_cache_capacity];
+  thread_counters* counters[thread_cache_capacity];
+  std::size_t next;
+};
+
+
+inline thread_cache& this_thread_cache()
+{
+  // thread_local objects of trivial type are zero-initialized
+  static thread_local thread_cache cache;
+  return cache;
+}
+
+
+inline std::uint64_t next_resource_counters_id()
+{
+  // 0 is reserved for empty entries of thread_cache
+  static std::atomic<std::uint64_t> next_id(1);
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+} // end instrumented_resource_detail
+
+
+// resource_statistics is a snapshot of the counters of an instrumented_resource
+struct resource_statistics
+{
+  static constexpr std::size_t num_size_bins = instrumented_resource_detail::num_size_bins;
+
+  std::uint64_t num_allocations;
+  std::uint64_t num_deallocations;
+
+  // the number of allocations the instrumented resource failed to satisfy
+  // when an instrumented_resource is the primary resource of a tiered_resource, these are the allocations which spilled to the fallback resource
+  std::uint64_t num_failed_allocations;
+
+  std::uint64_t bytes_allocated;
+  std::uint64_t bytes_deallocated;
+
+  // the largest number of bytes live at once, to within 64 KiB per thread
+  std::uint64_t peak_bytes_live;
+
+  // size_histogram[b] is the number of allocations of size_bin_upper_bound(b - 1) + 1 through size_bin_upper_bound(b) bytes
+  std::array<std::uint64_t, num_size_bins> size_histogram;
+
+  std::uint64_t bytes_live() const
+  {
+    return bytes_allocated - bytes_deallocated;
+  }
+
+  // the largest allocation counted by size_histogram[b]
+  static std::size_t size_bin_upper_bound(std::size_t b)
+  {
+    return b + 1 < num_size_bins ? (std::size_t(1) << b) : static_cast<std::size_t>(-1);
+  }
+};
+
+
+// resource_counters accumulates the allocation statistics of one or more instrumented_resources
+//
+// each thread records its allocations & deallocations in counters of its own, so recording
+// never contends with other threads. snapshot() sums every thread's counters
+// the counters of threads which have exited are retained
+class resource_counters
+{
+  public:
+    resource_counters()
+      : id_(instrumented_resource_detail::next_resource_counters_id()),
+        published_bytes_live_(0),
+        peak_bytes_live_(0)
+    {}
+
+    resource_counters(const resource_counters&) = delete;
+
+    resource_counters& operator=(const resource_counters&) = delete;
+
+    void record_allocation(std::size_t num_bytes)
+    {
+      instrumented_resource_detail::thread_counters& counters = this_thread_counters();
+
+      instrumented_resource_detail::increment(counters.num_allocations, 1);
+      instrumented_resource_detail::increment(counters.bytes_allocated, num_bytes);
+      instrumented_resource_detail::increment(counters.size_histogram[instrumented_resource_detail::size_bin(num_bytes)], 1);
+
+      counters.unpublished_bytes += static_cast<std::int64_t>(num_bytes);
+      if(counters.unpublished_bytes > counters.unpublished_peak_bytes.load(std::memory_order_relaxed))
+      {
+        counters.unpublished_peak_bytes.store(counters.unpublished_bytes, std::memory_order_relaxed);
+      }
+
+      if(counters.unpublished_bytes >= instrumented_resource_detail::publication_threshold)
+      {
+        publish(counters);
+      }
+    }
+
+    void record_failed_allocation(std::size_t)
+    {
+      instrumented_resource_detail::increment(this_thread_counters().num_failed_allocations, 1);
+    }
+
+    void record_deallocation(std::size_t num_bytes)
+    {
+      instrumented_resource_detail::thread_counters& counters = this_thread_counters();
+
+      instrumented_resource_detail::increment(counters.num_deallocations, 1);
+      instrumented_resource_detail::increment(counters.bytes_deallocated, num_bytes);
+
+      counters.unpublished_bytes -= static_cast<std::int64_t>(num_bytes);
+      if(counters.unpublished_bytes <= -instrumented_resource_detail::publication_threshold)
+      {
+        publish(counters);
+      }
+    }
+
+    resource_statistics snapshot() const
+    {
+      resource_statistics result{};
+
+      // the bytes live when each thread reached its unpublished peak are at most the published bytes live plus every thread's unpublished peak
+      std::int64_t unpublished_peak_bytes_live = published_bytes_live_.load(std::memory_order_relaxed);
+
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+
+        for(auto& counters : threads_)
+        {
+          result.num_allocations        += counters->num_allocations.load(std::memory_order_relaxed);
+          result.num_deallocations      += counters->num_deallocations.load(std::memory_order_relaxed);
+          result.num_failed_allocations += counters->num_failed_allocations.load(std::memory_order_relaxed);
+          result.bytes_allocated        += counters->bytes_allocated.load(std::memory_order_relaxed);
+          result.bytes_deallocated      += counters->bytes_deallocated.load(std::memory_order_relaxed);
+          unpublished_peak_bytes_live   += counters->unpublished_peak_bytes.load(std::memory_order_relaxed);
+
+          for(std::size_t b = 0; b < resource_statistics::num_size_bins; ++b)
+          {
+            result.size_histogram[b] += counters->size_histogram[b].load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      std::uint64_t peak = peak_bytes_live_.load(std::memory_order_relaxed);
+
+      if(unpublished_peak_bytes_live > 0 && static_cast<std::uint64_t>(unpublished_peak_bytes_live) > peak)
+      {
+        peak = static_cast<std::uint64_t>(unpublished_peak_bytes_live);
+      }
+
+      // the bytes live now may exceed the peaks which have been recorded
+      result.peak_bytes_live = result.bytes_live() > peak ? result.bytes_live() : peak;
+
+      return result;
+    }
+
+  private:
+    instrumented_resource_detail::thread_counters& this_thread_counters()
+    {
+      instrumented_resource_detail::thread_cache& cache = instrumented_resource_detail::this_thread_cache();
+
+      for(std::size_t i = 0; i < instrumented_resource_detail::thread_cache_capacity; ++i)
+      {
+        if(cache.ids[i] == id_) return *cache.counters[i];
+      }
+
+      instrumented_resource_detail::thread_counters& result = find_or_insert(std::this_thread::get_id());
+
+      // replace the oldest entry
+      std::size_t i = cache.next;
+      cache.ids[i] = id_;
+      cache.counters[i] = &result;
+      cache.next = (i + 1) % instrumented_resource_detail::thread_cache_capacity;
+
+      return result;
+    }
+
+    instrumented_resource_detail::thread_counters& find_or_insert(std::thread::id thread_id)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      for(auto& counters : threads_)
+      {
+        if(counters->thread_id == thread_id) return *counters;
+      }
+
+      threads_.emplace_back(new instrumented_resource_detail::thread_counters(thread_id));
+      return *threads_.back();
+    }
+
+    void publish(instrumented_resource_detail::thread_counters& counters)
+    {
+      // the bytes live peaked, as far as this thread can tell, when its unpublished bytes peaked
+      std::int64_t bytes_live = published_bytes_live_.fetch_add(counters.unpublished_bytes, std::memory_order_relaxed) +
+                                counters.unpublished_peak_bytes.load(std::memory_order_relaxed);
+
+      counters.unpublished_bytes = 0;
+      counters.unpublished_peak_bytes.store(0, std::memory_order_relaxed);
+
+      if(bytes_live > 0)
+      {
+        std::uint64_t peak = peak_bytes_live_.load(std::memory_order_relaxed);
+        while(static_cast<std::uint64_t>(bytes_live) > peak &&
+              !peak_bytes_live_.compare_exchange_weak(peak, static_cast<std::uint64_t>(bytes_live), std::memory_order_relaxed))
+        {
+        }
+      }
+    }
+
+    const std::uint64_t id_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<instrumented_resource_detail::thread_counters>> threads_;
+
+    std::atomic<std::int64_t> published_bytes_live_;
+    std::atomic<std::uint64_t> peak_bytes_live_;
+};
+
+
+namespace instrumented_resource_detail
+{
+
+
+// the counters shared by default-constructed instrumented_resource<MemoryResource>s
+template<class MemoryResource>
+struct global_resource_counters : resource_counters {};
+
+
+} // end instrumented_resource_detail
+
+
+// instrumented_resource adapts a memory resource to record statistics of the allocations made through it
+//
+// an instrumented_resource records into a resource_counters object. default-constructed instrumented_resources
+// of the same type share a process-wide resource_counters object, so the statistics of resources which are
+// constructed on demand, e.g. the memory resources of concurrent agents' groups, accumulate in one place:
+//
+//   using resource_type = instrumented_resource<default_concurrent_resource>;
+//   ... bulk_invoke(con(n), f) with basic_concurrent_agent<size_t, resource_type> ...
+//   resource_statistics stats = resource_type::global_statistics();
+//
+// to count the allocations a resource forwards to its upstream resource, e.g. the chunks an arena spills to
+// or the blocks a cache retains, instrument the upstream resource instead:
+//
+//   chunked_arena_resource<N, instrumented_resource<arena_chunk_resource>>
+//   globally_cached_resource<instrumented_resource<malloc_resource>>
+template<class MemoryResource>
+class instrumented_resource : private MemoryResource
+{
+  public:
+    using resource_type = MemoryResource;
+
+    instrumented_resource()
+      : MemoryResource(),
+        counters_(agency::detail::singleton<instrumented_resource_detail::global_resource_counters<MemoryResource>>())
+    {}
+
+    // records into counters, which must outlive this instrumented_resource
+    // args... are forwarded to the constructor of MemoryResource
+    template<class... Args>
+    explicit instrumented_resource(resource_counters& counters, Args&&... args)
+      : MemoryResource(std::forward<Args>(args)...),
+        counters_(&counters)
+    {}
+
+    instrumented_resource(const instrumented_resource&) = default;
+
+    instrumented_resource(instrumented_resource&&) = default;
+
+    void* allocate(std::size_t num_bytes)
+    {
+      void* result = resource().allocate(num_bytes);
+
+      // counters_ is null when the global counters have been destroyed at program exit
+      if(counters_)
+      {
+        if(result)
+        {
+          counters_->record_allocation(num_bytes);
+        }
+        else
+        {
+          counters_->record_failed_allocation(num_bytes);
+        }
+      }
+
+      return result;
+    }
+
+    void deallocate(void* ptr, std::size_t num_bytes)
+    {
+      resource().deallocate(ptr, num_bytes);
+
+      if(counters_)
+      {
+        counters_->record_deallocation(num_bytes);
+      }
+    }
+
+    // returns a snapshot of the statistics recorded by this resource's counters
+    resource_statistics statistics() const
+    {
+      return counters_ ? counters_->snapshot() : resource_statistics{};
+    }
+
+    // returns a snapshot of the statistics recorded by default-constructed instrumented_resource<MemoryResource>s
+    static resource_statistics global_statistics()
+    {
+      resource_counters* counters = agency::detail::singleton<instrumented_resource_detail::global_resource_counters<MemoryResource>>();
+      return counters ? counters->snapshot() : resource_statistics{};
+    }
+
+    resource_type& resource()
+    {
+      return *this;
+    }
+
+    const resource_type& resource() const
+    {
+      return *this;
+    }
+
+    // the trailing return types of the following functions enable or disable them (via SFINAE)
+    // based on the existence of the corresponding members of MemoryResource
+
+    template<class DeducedMemoryResource = MemoryResource>
+    auto owns(void* ptr, std::size_t num_bytes) const ->
+      decltype(std::declval<const DeducedMemoryResource&>().owns(ptr, num_bytes))
+    {
+      return resource().owns(ptr, num_bytes);
+    }
+
+    template<class DeducedMemoryResource = MemoryResource>
+    auto reserve(std::size_t num_bytes) ->
+      decltype(std::declval<DeducedMemoryResource&>().reserve(num_bytes))
+    {
+      return resource().reserve(num_bytes);
+    }
+
+    template<class Iterator, class... Iterators,
+             class DeducedMemoryResource = MemoryResource>
+    auto construct_n(Iterator first, std::size_t n, Iterators... iters) ->
+      decltype(std::declval<DeducedMemoryResource&>().construct_n(first, n, iters...))
+    {
+      return resource().construct_n(first, n, iters...);
+    }
+
+    bool operator==(const instrumented_resource& other) const
+    {
+      return resource() == other.resource() && counters_ == other.counters_;
+    }
+
+    bool operator!=(const instrumented_resource& other) const
+    {
+      return !(*this == other);
+    }
+
+    // enables instrumented_resource to key the map of globally_cached_resource
+    template<class DeducedMemoryResource = MemoryResource>
+    auto operator<(const instrumented_resource& other) const ->
+      decltype(std::declval<const DeducedMemoryResource&>() < std::declval<const DeducedMemoryResource&>())
+    {
+      if(resource() < other.resource()) return true;
+      if(other.resource() < resource()) return false;
+      return counters_ < other.counters_;
+    }
+
+  private:
+    resource_counters* counters_;
+};
+
+
+} // end detail
+} // end agency
+
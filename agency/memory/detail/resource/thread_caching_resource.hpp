@@ -0,0 +1,163 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <cstddef>
+#include <new>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// thread_block_cache is a per-thread cache of small, short-lived blocks of memory
+//
+// freed blocks are kept in free lists segregated by size class, so the next allocation of a similar size
+// is satisfied without a trip to the system allocator
+// blocks may be freed by a different thread than the one which allocated them, as when a task is submitted
+// to a thread pool, in which case they migrate to the freeing thread's cache
+struct thread_block_cache
+{
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  static constexpr std::size_t size_class_granularity = 64;
+  static constexpr std::size_t num_size_classes = 8;
+  static constexpr std::size_t max_cached_blocks_per_size_class = 64;
+
+  // thread_block_cache is trivially destructible so that it outlives the thread's
+  // thread_block_cache_cleanup, which disables the cache when the thread exits
+  free_block* free_lists[num_size_classes];
+  std::size_t num_cached_blocks[num_size_classes];
+  bool is_disabled;
+
+  static std::size_t size_class(std::size_t num_bytes)
+  {
+    return num_bytes == 0 ? 0 : (num_bytes + size_class_granularity - 1) / size_class_granularity - 1;
+  }
+
+  void* allocate(std::size_t num_bytes)
+  {
+    std::size_t c = size_class(num_bytes);
+
+    if(c < num_size_classes && free_lists[c])
+    {
+      free_block* result = free_lists[c];
+      free_lists[c] = result->next;
+      --num_cached_blocks[c];
+      return result;
+    }
+
+    // round up to the size class so the block may be reused by any allocation of the same class
+    return ::operator new(c < num_size_classes ? (c + 1) * size_class_granularity : num_bytes);
+  }
+
+  void deallocate(void* ptr, std::size_t num_bytes)
+  {
+    std::size_t c = size_class(num_bytes);
+
+    if(c < num_size_classes && num_cached_blocks[c] < max_cached_blocks_per_size_class)
+    {
+      free_block* block = reinterpret_cast<free_block*>(ptr);
+      block->next = free_lists[c];
+      free_lists[c] = block;
+      ++num_cached_blocks[c];
+    }
+    else
+    {
+      ::operator delete(ptr);
+    }
+  }
+
+  void release()
+  {
+    for(std::size_t c = 0; c < num_size_classes; ++c)
+    {
+      while(free_lists[c])
+      {
+        free_block* block = free_lists[c];
+        free_lists[c] = block->next;
+        ::operator delete(block);
+      }
+
+      num_cached_blocks[c] = 0;
+    }
+  }
+};
+
+
+struct thread_block_cache_cleanup
+{
+  thread_block_cache* cache;
+
+  ~thread_block_cache_cleanup()
+  {
+    cache->release();
+    cache->is_disabled = true;
+  }
+};
+
+
+// returns this thread's thread_block_cache, or nullptr if this thread is exiting
+inline thread_block_cache* this_thread_block_cache()
+{
+  // thread_local objects of trivial type are zero-initialized
+  static thread_local thread_block_cache cache;
+  static thread_local thread_block_cache_cleanup cleanup{&cache};
+
+  return cache.is_disabled ? nullptr : &cache;
+}
+
+
+// thread_caching_resource is a stateless memory resource which allocates from the calling thread's thread_block_cache
+// it is intended for small allocations which are freed soon after they are allocated
+class thread_caching_resource
+{
+  public:
+    inline void* allocate(std::size_t num_bytes)
+    {
+      thread_block_cache* cache = this_thread_block_cache();
+
+      return cache ? cache->allocate(num_bytes) : ::operator new(num_bytes);
+    }
+
+    inline void deallocate(void* ptr, std::size_t num_bytes)
+    {
+      thread_block_cache* cache = this_thread_block_cache();
+
+      if(cache)
+      {
+        cache->deallocate(ptr, num_bytes);
+      }
+      else
+      {
+        ::operator delete(ptr);
+      }
+    }
+
+    __AGENCY_ANNOTATION
+    inline bool is_equal(const thread_caching_resource&) const
+    {
+      return true;
+    }
+};
+
+
+__AGENCY_ANNOTATION
+inline bool operator==(const thread_caching_resource& a, const thread_caching_resource& b)
+{
+  return a.is_equal(b);
+}
+
+__AGENCY_ANNOTATION
+inline bool operator!=(const thread_caching_resource& a, const thread_caching_resource& b)
+{
+  return !(a == b);
+}
+
+
+} // end detail
+} // end agency
+
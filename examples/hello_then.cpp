@@ -11,7 +11,7 @@ int main()
   std::mutex mut;
 
   // asynchronously create 5 agents to greet us in a predecessor task
-  std::future<void> predecessor = bulk_async(par(5), [&](parallel_agent& self)
+  agency::future<void> predecessor = bulk_async(par(5), [&](parallel_agent& self)
   {
     mut.lock();
     std::cout << "Hello, world from agent " << self.index() << " in the predecessor task" << std::endl;
@@ -19,7 +19,7 @@ int main()
   });
 
   // create a continuation to the predecessor
-  std::future<void> continuation = bulk_then(par(5), [&](parallel_agent& self)
+  agency::future<void> continuation = bulk_then(par(5), [&](parallel_agent& self)
   {
     mut.lock();
     std::cout << "Hello, world from agent " << self.index() << " in the continuation" << std::endl;
@@ -0,0 +1,78 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    std::vector<int> data(n);
+    std::iota(data.begin(), data.end(), 0);
+
+    std::vector<long long> expected(n);
+    long long sum = 13;
+    for(size_t i = 0; i < n; ++i)
+    {
+      expected[i] = sum;
+      sum += data[i];
+    }
+
+    {
+      // exclusive_scan with init
+      std::vector<long long> result(n);
+      auto end = agency::exclusive_scan(policy, data.begin(), data.end(), result.begin(), 13ll);
+
+      assert(end == result.end());
+      assert(result == expected);
+    }
+
+    {
+      // exclusive_scan in place with a non-commutative binary_op
+      std::vector<affine> result(n);
+      for(size_t i = 0; i < n; ++i)
+      {
+        result[i] = affine{static_cast<unsigned int>(2 * i + 1), static_cast<unsigned int>(i)};
+      }
+
+      affine identity{1, 0};
+
+      std::vector<affine> serial(n);
+      affine carry = identity;
+      for(size_t i = 0; i < n; ++i)
+      {
+        serial[i] = carry;
+        carry = compose()(carry, result[i]);
+      }
+
+      agency::exclusive_scan(policy, result.begin(), result.end(), result.begin(), identity, compose());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(result[i].a == serial[i].a);
+        assert(result[i].b == serial[i].b);
+      }
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<>()));
+  test(agency::par.on(partitioning_executor<>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
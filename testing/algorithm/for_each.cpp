@@ -0,0 +1,102 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <agency/experimental/segmented_array.hpp>
+#include <agency/experimental/ranges/flatten.hpp>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+struct increment
+{
+  void operator()(int& x) const
+  {
+    ++x;
+  }
+};
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    {
+      // for_each over a vector
+      std::vector<int> data(n);
+      std::iota(data.begin(), data.end(), 0);
+
+      agency::for_each(policy, data.begin(), data.end(), increment());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(data[i] == static_cast<int>(i) + 1);
+      }
+    }
+
+    {
+      // for_each over a segmented_array
+      std::vector<agency::experimental::allocator<int>> allocators(10);
+      agency::experimental::segmented_array<int> data(n, 0, allocators);
+
+      agency::for_each(policy, data.begin(), data.end(), increment());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(data[i] == 1);
+      }
+    }
+  }
+
+  {
+    // for_each over parts of a flatten_view of segments of various sizes, including empty segments
+    std::vector<std::vector<int>> segments;
+    for(size_t size : {0, 5000, 0, 1, 20000, 0, 0, 3, 10000, 0})
+    {
+      segments.emplace_back(size, 0);
+    }
+
+    auto flattened = agency::experimental::flatten(segments);
+    size_t n = flattened.size();
+
+    for(size_t begin : {size_t(0), size_t(1), size_t(4999), size_t(5000), size_t(5001), n - 1, n})
+    {
+      for(size_t end : {begin, begin + 1, size_t(5001), size_t(25004), n - 1, n})
+      {
+        if(end < begin || end > n) continue;
+
+        for(auto& segment : segments)
+        {
+          std::fill(segment.begin(), segment.end(), 0);
+        }
+
+        agency::for_each(policy, flattened.begin() + begin, flattened.begin() + end, increment());
+
+        for(size_t i = 0; i < n; ++i)
+        {
+          assert(flattened[i] == (begin <= i && i < end ? 1 : 0));
+        }
+      }
+    }
+  }
+}
+
+
+int main()
+{
+  static_assert(!agency::detail::is_segmented_iterator<std::vector<int>::iterator>::value, "std::vector<int>::iterator should not be segmented");
+  static_assert(agency::detail::is_segmented_iterator<agency::experimental::segmented_array<int>::iterator>::value, "segmented_array<int>::iterator should be segmented");
+
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<>()));
+  test(agency::par.on(partitioning_executor<>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    std::vector<int> data(n);
+    std::iota(data.begin(), data.end(), 0);
+
+    std::vector<int> expected(n);
+    std::partial_sum(data.begin(), data.end(), expected.begin());
+
+    {
+      // inclusive_scan
+      std::vector<int> result(n);
+      auto end = agency::inclusive_scan(policy, data.begin(), data.end(), result.begin());
+
+      assert(end == result.end());
+      assert(result == expected);
+    }
+
+    {
+      // inclusive_scan with binary_op & init
+      std::vector<int> result(n);
+      agency::inclusive_scan(policy, data.begin(), data.end(), result.begin(), std::plus<int>(), 13);
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(result[i] == expected[i] + 13);
+      }
+    }
+
+    {
+      // inclusive_scan in place with a non-commutative binary_op
+      std::vector<affine> result(n);
+      for(size_t i = 0; i < n; ++i)
+      {
+        result[i] = affine{static_cast<unsigned int>(2 * i + 1), static_cast<unsigned int>(i)};
+      }
+
+      std::vector<affine> serial(n);
+      std::partial_sum(result.begin(), result.end(), serial.begin(), compose());
+
+      agency::inclusive_scan(policy, result.begin(), result.end(), result.begin(), compose());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(result[i].a == serial[i].a);
+        assert(result[i].b == serial[i].b);
+      }
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<>()));
+  test(agency::par.on(partitioning_executor<>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,69 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    std::vector<int> data(n);
+    std::iota(data.begin(), data.end(), 0);
+
+    {
+      // reduce with init & binary_op
+      int result = agency::reduce(policy, data.begin(), data.end(), 13, std::plus<int>());
+      assert(result == std::accumulate(data.begin(), data.end(), 13));
+    }
+
+    {
+      // reduce with init
+      long long result = agency::reduce(policy, data.begin(), data.end(), 0ll);
+      assert(result == std::accumulate(data.begin(), data.end(), 0ll));
+    }
+
+    {
+      // reduce
+      int result = agency::reduce(policy, data.begin(), data.end());
+      assert(result == std::accumulate(data.begin(), data.end(), 0));
+    }
+
+    {
+      // reduce with a non-commutative binary_op
+      std::vector<affine> functions(n);
+      for(size_t i = 0; i < n; ++i)
+      {
+        functions[i] = affine{static_cast<unsigned int>(2 * i + 1), static_cast<unsigned int>(i)};
+      }
+
+      affine identity{1, 0};
+
+      affine result = agency::reduce(policy, functions.begin(), functions.end(), identity, compose());
+      affine expected = std::accumulate(functions.begin(), functions.end(), identity, compose());
+
+      assert(result.a == expected.a);
+      assert(result.b == expected.b);
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<>()));
+  test(agency::par.on(partitioning_executor<>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
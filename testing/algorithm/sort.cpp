@@ -0,0 +1,117 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+template<class ExecutionPolicy, class T, class Compare>
+void test_sort(ExecutionPolicy policy, std::vector<T> data, Compare comp)
+{
+  std::vector<T> expected = data;
+  std::sort(expected.begin(), expected.end(), comp);
+
+  agency::sort(policy, data.begin(), data.end(), comp);
+
+  assert(data == expected);
+}
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  std::default_random_engine rng;
+
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    {
+      // sort ints, which are radix sorted when there are enough of them
+      std::vector<int> data(n);
+      std::uniform_int_distribution<int> dist(-1000000, 1000000);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      std::vector<int> expected = data;
+      std::sort(expected.begin(), expected.end());
+
+      agency::sort(policy, data.begin(), data.end());
+
+      assert(data == expected);
+    }
+
+    {
+      // sort ints with a comparison other than std::less, which are merge sorted
+      std::vector<int> data(n);
+      std::uniform_int_distribution<int> dist(0, 100);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      test_sort(policy, data, std::greater<int>());
+    }
+
+    {
+      // sort unsigned integers whose high bytes are all equal
+      std::vector<unsigned long long> data(n);
+      std::uniform_int_distribution<unsigned long long> dist(0, 1000);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      test_sort(policy, data, std::less<unsigned long long>());
+    }
+
+    {
+      // sort signed chars
+      std::vector<signed char> data(n);
+      std::uniform_int_distribution<int> dist(-128, 127);
+      std::generate(data.begin(), data.end(), [&]{ return static_cast<signed char>(dist(rng)); });
+
+      test_sort(policy, data, std::less<signed char>());
+    }
+
+    {
+      // sort doubles of either sign
+      std::vector<double> data(n);
+      std::uniform_real_distribution<double> dist(-1e6, 1e6);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      test_sort(policy, data, std::less<double>());
+    }
+
+    {
+      // sort floats of either sign
+      std::vector<float> data(n);
+      std::uniform_real_distribution<float> dist(-1.f, 1.f);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      test_sort(policy, data, std::less<float>());
+    }
+
+    {
+      // sort strings, which are not trivially copyable
+      std::vector<std::string> data(n);
+      std::uniform_int_distribution<int> dist(0, 1000000);
+      std::generate(data.begin(), data.end(), [&]{ return std::to_string(dist(rng)) + " is a string which is too long to be stored inline"; });
+
+      test_sort(policy, data, std::less<std::string>());
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<7>()));
+  test(agency::par.on(partitioning_executor<7>()));
+  test(agency::seq.on(partitioning_executor<3>()));
+  test(agency::par.on(partitioning_executor<3>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+struct record
+{
+  int key;
+  std::string value;
+};
+
+struct compare_keys
+{
+  bool operator()(const record& a, const record& b) const
+  {
+    return a.key < b.key;
+  }
+};
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  std::default_random_engine rng;
+
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    {
+      // stable_sort records with few distinct keys
+      std::vector<record> data(n);
+      std::uniform_int_distribution<int> dist(0, 10);
+      for(size_t i = 0; i < n; ++i)
+      {
+        data[i] = record{dist(rng), std::to_string(i)};
+      }
+
+      std::vector<record> expected = data;
+      std::stable_sort(expected.begin(), expected.end(), compare_keys());
+
+      agency::stable_sort(policy, data.begin(), data.end(), compare_keys());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(data[i].key == expected[i].key);
+        assert(data[i].value == expected[i].value);
+      }
+    }
+
+    {
+      // stable_sort ints
+      std::vector<int> data(n);
+      std::uniform_int_distribution<int> dist(-1000, 1000);
+      std::generate(data.begin(), data.end(), [&]{ return dist(rng); });
+
+      std::vector<int> expected = data;
+      std::stable_sort(expected.begin(), expected.end());
+
+      agency::stable_sort(policy, data.begin(), data.end());
+
+      assert(data == expected);
+    }
+
+    {
+      // stable_sort doubles, among which -0 & +0 are equivalent and must retain their relative order
+      std::vector<double> data(n);
+      std::uniform_int_distribution<int> dist(0, 3);
+      std::generate(data.begin(), data.end(), [&]
+      {
+        int x = dist(rng);
+        return x == 0 ? -0. : x == 1 ? 0. : x == 2 ? -1. : 1.;
+      });
+
+      std::vector<double> expected = data;
+      std::stable_sort(expected.begin(), expected.end());
+
+      agency::stable_sort(policy, data.begin(), data.end());
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(data[i] == expected[i]);
+        assert(std::signbit(data[i]) == std::signbit(expected[i]));
+      }
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<7>()));
+  test(agency::par.on(partitioning_executor<7>()));
+  test(agency::seq.on(partitioning_executor<3>()));
+  test(agency::par.on(partitioning_executor<3>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
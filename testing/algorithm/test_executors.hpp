@@ -0,0 +1,31 @@
+#pragma once
+
+#include <agency/execution/executor/sequenced_executor.hpp>
+#include <cstddef>
+
+// asks for several partitions, so that the parallel algorithms divide their input even on a machine with a single core
+// an odd number of partitions is merged in an odd number of levels by sort(), and an even number in an even number of levels
+template<std::size_t num_partitions = 7>
+struct partitioning_executor : agency::sequenced_executor
+{
+  std::size_t unit_shape() const
+  {
+    return num_partitions;
+  }
+};
+
+
+// composes affine functions x -> a * x + b, which is associative but not commutative
+struct affine
+{
+  unsigned int a, b;
+};
+
+struct compose
+{
+  affine operator()(const affine& f, const affine& g) const
+  {
+    // apply f, then g
+    return affine{g.a * f.a, g.a * f.b + g.b};
+  }
+};
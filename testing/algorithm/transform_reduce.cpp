@@ -0,0 +1,71 @@
+#include <agency/agency.hpp>
+#include <agency/algorithm.hpp>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "test_executors.hpp"
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  for(size_t n : {0, 1, 100, 4096, 100000})
+  {
+    std::vector<long long> x(n), y(n);
+    std::iota(x.begin(), x.end(), 0);
+    std::iota(y.begin(), y.end(), 1);
+
+    {
+      // unary transform_reduce
+      long long result = agency::transform_reduce(policy, x.begin(), x.end(), 13ll, std::plus<long long>(), [](long long xi)
+      {
+        return xi * xi;
+      });
+
+      long long expected = 13;
+      for(size_t i = 0; i < n; ++i)
+      {
+        expected += x[i] * x[i];
+      }
+
+      assert(result == expected);
+    }
+
+    {
+      // binary transform_reduce
+      long long result = agency::transform_reduce(policy, x.begin(), x.end(), y.begin(), 0ll, std::plus<long long>(), [](long long xi, long long yi)
+      {
+        return xi * yi;
+      });
+
+      long long expected = std::inner_product(x.begin(), x.end(), y.begin(), 0ll);
+
+      assert(result == expected);
+    }
+
+    {
+      // inner product
+      long long result = agency::transform_reduce(policy, x.begin(), x.end(), y.begin(), 0ll);
+      long long expected = std::inner_product(x.begin(), x.end(), y.begin(), 0ll);
+
+      assert(result == expected);
+    }
+  }
+}
+
+
+int main()
+{
+  test(agency::seq);
+  test(agency::con);
+  test(agency::par);
+  test(agency::seq.on(partitioning_executor<>()));
+  test(agency::par.on(partitioning_executor<>()));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,90 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/span.hpp>
+#include <cassert>
+#include <vector>
+
+template<class ExecutionPolicy>
+void test()
+{
+  using execution_policy_type = ExecutionPolicy;
+
+  {
+    // bulk_invoke into a vector with no parameters
+
+    execution_policy_type policy;
+
+    std::vector<int> results(10, 0);
+
+    std::vector<int>& result = agency::bulk_invoke(agency::into(results), policy(10),
+      [](typename execution_policy_type::execution_agent_type& self)
+    {
+      return static_cast<int>(self.index());
+    });
+
+    assert(&result == &results);
+
+    for(int i = 0; i < 10; ++i)
+    {
+      assert(results[i] == i);
+    }
+  }
+
+  {
+    // bulk_invoke into a vector with one parameter & one shared parameter, repeatedly
+
+    execution_policy_type policy;
+
+    std::vector<int> results(10, 0);
+
+    int val = 13;
+
+    for(int iteration = 0; iteration < 3; ++iteration)
+    {
+      agency::bulk_invoke(agency::into(results), policy(10),
+        [](typename execution_policy_type::execution_agent_type& self, int val, int& shared_val)
+      {
+        return val + shared_val + static_cast<int>(self.index());
+      },
+      val,
+      agency::share(iteration));
+
+      for(int i = 0; i < 10; ++i)
+      {
+        assert(results[i] == val + iteration + i);
+      }
+    }
+  }
+
+  {
+    // bulk_invoke into a span of a larger array
+
+    execution_policy_type policy;
+
+    std::vector<int> array(20, 0);
+    agency::experimental::span<int> results(array.data() + 10, 10);
+
+    agency::bulk_invoke(agency::into(results), policy(10),
+      [](typename execution_policy_type::execution_agent_type& self)
+    {
+      return static_cast<int>(self.index()) + 1;
+    });
+
+    for(int i = 0; i < 10; ++i)
+    {
+      assert(array[i] == 0);
+      assert(array[i + 10] == i + 1);
+    }
+  }
+}
+
+int main()
+{
+  test<agency::sequenced_execution_policy>();
+  test<agency::concurrent_execution_policy>();
+  test<agency::parallel_execution_policy>();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,99 @@
+#include <agency/agency.hpp>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+
+
+void test_shared_memory_hint()
+{
+  using namespace agency;
+
+  size_t n = 8;
+  size_t num_elements = 4096;
+
+  auto policy = con(n).with_shared_memory(num_elements * sizeof(int) + sizeof(double));
+
+  static_assert(std::is_same<decltype(policy), concurrent_execution_policy>::value, "with_shared_memory() should return concurrent_execution_policy");
+  assert(policy.param().domain().size() == n);
+  assert(policy.param().shared_memory_size() == num_elements * sizeof(int) + sizeof(double));
+
+  std::atomic<int> counter{0};
+
+  bulk_invoke(policy, [&](concurrent_agent& self)
+  {
+    // the group's storage was reserved before it began executing
+    size_t num_chunks = self.memory_resource().num_chunks();
+    assert(num_chunks == 1);
+
+    shared<double> x(self, 13);
+    shared_vector<int> vec(self, num_elements, 7);
+
+    // neither object required any additional storage
+    assert(self.memory_resource().num_chunks() == num_chunks);
+
+    vec[self.index()] = static_cast<int>(self.index());
+    self.wait();
+
+    for(size_t i = 0; i < self.group_size(); ++i)
+    {
+      assert(vec[i] == static_cast<int>(i));
+    }
+
+    assert(x.value() == 13);
+
+    ++counter;
+
+    self.wait();
+  });
+
+  assert(counter == static_cast<int>(n));
+}
+
+
+void test_without_hint()
+{
+  using namespace agency;
+
+  assert(con(8).param().shared_memory_size() == 0);
+
+  bulk_invoke(con(8), [](concurrent_agent& self)
+  {
+    // no storage is reserved without a hint
+    assert(self.memory_resource().num_chunks() == 0);
+  });
+}
+
+
+void test_2d()
+{
+  using namespace agency;
+
+  auto policy = con2d({0,0}, {2,3}).with_shared_memory(1024 * sizeof(float));
+
+  assert(policy.param().domain().size() == 6);
+
+  bulk_invoke(policy, [](concurrent_agent_2d& self)
+  {
+    size_t num_chunks = self.memory_resource().num_chunks();
+
+    shared_vector<float> vec(self, size_t(1024), 1.f);
+
+    assert(self.memory_resource().num_chunks() == num_chunks);
+    assert(vec[self.rank()] == 1.f);
+
+    self.wait();
+  });
+}
+
+
+int main()
+{
+  test_shared_memory_hint();
+  test_without_hint();
+  test_2d();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
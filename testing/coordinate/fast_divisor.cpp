@@ -0,0 +1,158 @@
+#include <agency/agency.hpp>
+#include <agency/detail/fast_divisor.hpp>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template<class Integer>
+void test_divide(Integer n, Integer d)
+{
+  agency::detail::fast_divisor<Integer> fast_d(d);
+
+  assert(n / fast_d == n / d);
+  assert(n % fast_d == n % d);
+}
+
+
+void test_exhaustive()
+{
+  // every small numerator by every small divisor
+  for(std::uint32_t d = 1; d < 1024; ++d)
+  {
+    agency::detail::fast_divisor<std::uint32_t> fast_d(d);
+
+    for(std::uint32_t n = 0; n < 65536; ++n)
+    {
+      assert(n / fast_d == n / d);
+    }
+  }
+}
+
+
+template<class Integer>
+void test_extremes()
+{
+  Integer max = std::numeric_limits<Integer>::max();
+
+  std::vector<Integer> values = {1, 2, 3, 5, 7, 641, 6700417, Integer(max / 2), Integer(max / 2 + 1), Integer(max - 1), max};
+
+  // add the powers of two & their neighbors
+  for(int i = 1; i < std::numeric_limits<Integer>::digits; ++i)
+  {
+    Integer p = Integer(1) << i;
+
+    values.push_back(p - 1);
+    values.push_back(p);
+    values.push_back(p + 1);
+  }
+
+  for(Integer d : values)
+  {
+    test_divide<Integer>(0, d);
+
+    for(Integer n : values)
+    {
+      test_divide(n, d);
+    }
+  }
+}
+
+
+template<class Integer>
+void test_random()
+{
+  std::mt19937_64 rng(13);
+
+  for(int i = 0; i < 100000; ++i)
+  {
+    Integer n = static_cast<Integer>(rng()) & std::numeric_limits<Integer>::max();
+
+    // vary the magnitude of the divisor
+    Integer d = (static_cast<Integer>(rng()) & std::numeric_limits<Integer>::max()) >> (rng() % std::numeric_limits<Integer>::digits);
+
+    if(d == 0) d = 1;
+
+    test_divide(n, d);
+  }
+}
+
+
+void test_index_cast()
+{
+  using namespace agency;
+
+  // lifting a rank into an index divides by the elements of the shape of the index
+  {
+    int2 shape{7,13};
+    auto fast_shape = detail::make_fast_shape(shape);
+
+    for(int rank = 0; rank < shape[0] * shape[1]; ++rank)
+    {
+      int2 expected = detail::index_cast<int2>(rank, shape[0] * shape[1], shape);
+      int2 result   = detail::index_cast<int2>(rank, shape[0] * shape[1], fast_shape);
+
+      assert(result == expected);
+    }
+  }
+
+  {
+    size3 shape{3,5,11};
+    auto fast_shape = detail::make_fast_shape(shape);
+
+    size_t n = shape[0] * shape[1] * shape[2];
+
+    for(size_t rank = 0; rank < n; ++rank)
+    {
+      size3 expected = detail::index_cast<size3>(rank, n, shape);
+      size3 result   = detail::index_cast<size3>(rank, n, fast_shape);
+
+      assert(result == expected);
+    }
+  }
+}
+
+
+void test_bulk_invoke()
+{
+  using namespace agency;
+
+  // a two-dimensional policy executed by a flat executor lifts each agent's rank into its index
+  size_t m = 5, n = 7;
+
+  std::vector<int> visited(m * n, 0);
+
+  bulk_invoke(par2d({0,0}, {m,n}), [&](parallel_agent_2d& self)
+  {
+    size_t i = self.index()[0];
+    size_t j = self.index()[1];
+
+    visited[i * n + j] += 1;
+  });
+
+  assert(visited == std::vector<int>(m * n, 1));
+}
+
+
+int main()
+{
+  test_exhaustive();
+
+  test_extremes<std::uint32_t>();
+  test_extremes<std::uint64_t>();
+  test_extremes<int>();
+  test_extremes<std::int64_t>();
+
+  test_random<std::uint32_t>();
+  test_random<std::uint64_t>();
+  test_random<std::int64_t>();
+
+  test_index_cast();
+  test_bulk_invoke();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,78 @@
+#include <agency/agency.hpp>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+void test_iteration()
+{
+  using namespace agency;
+
+  lattice<int2> domain(int2{1,2}, int2{4,7});
+
+  // iteration visits each point in lexicographic order
+  std::vector<int2> expected;
+  for(int i = 1; i < 4; ++i)
+  {
+    for(int j = 2; j < 7; ++j)
+    {
+      expected.push_back(int2{i,j});
+    }
+  }
+
+  std::vector<int2> visited(domain.begin(), domain.end());
+  assert(visited == expected);
+
+  assert(domain.end() - domain.begin() == static_cast<std::ptrdiff_t>(domain.size()));
+}
+
+
+void test_random_access()
+{
+  using namespace agency;
+
+  lattice<int3> domain(int3{1,0,2}, int3{4,5,9});
+
+  std::vector<int3> expected(domain.begin(), domain.end());
+  std::ptrdiff_t n = expected.size();
+
+  auto begin = domain.begin();
+  auto end = domain.end();
+
+  for(std::ptrdiff_t i = 0; i < n; ++i)
+  {
+    for(std::ptrdiff_t j = 0; j <= n; ++j)
+    {
+      // advancing across any number of dimensions carries into the higher dimensions
+      auto iter = begin + i;
+      assert(*iter == expected[i]);
+      assert(begin[i] == expected[i]);
+
+      iter += j - i;
+      assert(iter - begin == j);
+
+      if(j < n)
+      {
+        assert(*iter == expected[j]);
+      }
+      else
+      {
+        assert(iter == end);
+      }
+    }
+
+    // retreating from the end borrows from the higher dimensions
+    assert(*(end - (n - i)) == expected[i]);
+  }
+}
+
+
+int main()
+{
+  test_iteration();
+  test_random_access();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
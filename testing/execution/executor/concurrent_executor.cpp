@@ -2,10 +2,16 @@
 #include <type_traits>
 #include <vector>
 #include <cassert>
+#include <thread>
+#include <stdexcept>
+#include <atomic>
+#include <future>
 
 #include <agency/execution/executor/concurrent_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/customization_points.hpp>
+#include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/unit.hpp>
 
 int main()
 {
@@ -26,8 +32,11 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, concurrent_executor>::value,
     "concurrent_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, concurrent_executor, int>::value,
-    "concurrent_executor should have std::future future");
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, concurrent_executor, int>::value,
+    "concurrent_executor should have agency::future future");
+
+  static_assert(std::is_convertible<executor_future_t<concurrent_executor,int>, std::future<int>>::value,
+    "concurrent_executor's future should be convertible to std::future");
 
   static_assert(executor_execution_depth<concurrent_executor>::value == 1,
     "concurrent_executor should have execution_depth == 1");
@@ -53,6 +62,224 @@ int main()
   
   assert(std::vector<int>(10, 7 + 13) == result);
 
+  {
+    // agents synchronize with each other, so they must execute concurrently
+    detail::blocking_barrier barrier(shape);
+
+    auto fut = agency::make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [&](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        shared_arg[idx] = idx;
+
+        barrier.arrive_and_wait();
+
+        // read a neighbor's element which is only valid after the barrier
+        results[idx] = shared_arg[(idx + 1) % shared_arg.size()];
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape); }      // shared_arg
+    );
+
+    auto result = f.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == int((i + 1) % shape));
+    }
+  }
+
+  {
+    // repeated launches reuse the threads of the gang thread pool
+    auto wait_until_all_threads_are_idle = []
+    {
+      while(detail::system_gang_thread_pool().num_idle_threads() != detail::system_gang_thread_pool().size())
+      {
+        std::this_thread::yield();
+      }
+    };
+
+    wait_until_all_threads_are_idle();
+    size_t num_threads = detail::system_gang_thread_pool().size();
+
+    for(int i = 0; i < 10; ++i)
+    {
+      auto fut = agency::make_ready_future<void>(exec);
+
+      exec.bulk_then_execute(
+        [](size_t idx, std::vector<int>& results, detail::unit)
+        {
+          results[idx] = idx;
+        },
+        shape,
+        fut,
+        [=]{ return std::vector<int>(shape); },  // results
+        []{ return detail::unit{}; }             // shared_arg
+      ).wait();
+
+      wait_until_all_threads_are_idle();
+    }
+
+    assert(detail::system_gang_thread_pool().size() == num_threads);
+  }
+
+  {
+    // a chain of launches on a pending predecessor does not block any threads
+    detail::continuation_promise<int> promise;
+    auto fut = promise.get_future();
+
+    auto wait_until_all_threads_are_idle = []
+    {
+      while(detail::system_gang_thread_pool().num_idle_threads() != detail::system_gang_thread_pool().size())
+      {
+        std::this_thread::yield();
+      }
+    };
+
+    wait_until_all_threads_are_idle();
+    size_t num_threads = detail::system_gang_thread_pool().size();
+
+    auto f1 = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = past_arg + idx;
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    auto f2 = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& past_arg, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = 2 * past_arg[idx];
+      },
+      shape,
+      f1,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    // nothing has been launched yet
+    assert(detail::system_gang_thread_pool().num_idle_threads() == num_threads);
+
+    promise.set_value(7);
+
+    auto result = f2.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == int(2 * (7 + i)));
+    }
+  }
+
+  {
+    // an exceptional predecessor propagates to the result
+    detail::continuation_promise<int> promise;
+    auto fut = promise.get_future();
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = past_arg;
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    promise.set_exception(std::make_exception_ptr(std::runtime_error("predecessor")));
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+  }
+
+  {
+    // an agent's exception propagates to the result once every agent has finished
+    std::atomic<int> num_finished(0);
+
+    auto fut = agency::make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [&](size_t idx, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = idx;
+
+        ++num_finished;
+
+        if(idx % 3 == 0)
+        {
+          throw std::runtime_error("agent");
+        }
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+    assert(num_finished == int(shape));
+  }
+
+  {
+    // an exceptional std::future predecessor propagates to the result without launching any agents
+    std::promise<int> promise;
+    std::future<int> fut = promise.get_future();
+
+    std::atomic<int> num_launched(0);
+
+    auto f = exec.bulk_then_execute(
+      [&](size_t, int&, std::vector<int>&, detail::unit)
+      {
+        ++num_launched;
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    promise.set_exception(std::make_exception_ptr(std::runtime_error("predecessor")));
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+    assert(num_launched == 0);
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
@@ -0,0 +1,145 @@
+#include <agency/agency.hpp>
+#include <agency/execution/executor/experimental/morton_executor.hpp>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+void test_morton_code()
+{
+  using namespace agency;
+
+  // the bits of the coordinates alternate, beginning with the last coordinate in the least significant bit
+  assert(detail::morton_encode(size2{0,1}) == 1);
+  assert(detail::morton_encode(size2{1,0}) == 2);
+  assert(detail::morton_encode(size2{3,3}) == 15);
+  assert(detail::morton_encode(size3{1,0,0}) == 4);
+  assert(detail::morton_encode(size3{0,2,1}) == 17);
+
+  for(size_t i = 0; i < 300; i += 7)
+  {
+    for(size_t j = 0; j < 300; j += 3)
+    {
+      assert(detail::morton_decode<size2>(detail::morton_encode(size2{i,j})) == size2(i,j));
+
+      size3 p{i, j, (i * j) % 1000};
+      assert(detail::morton_decode<size3>(detail::morton_encode(p)) == p);
+    }
+  }
+
+  // codes of the extreme coordinates
+  assert(detail::morton_decode<size2>(detail::morton_encode(size2{0xffffffff,0})) == size2(0xffffffff,0));
+  assert(detail::morton_decode<size3>(detail::morton_encode(size3{0,0x1fffff,0})) == size3(0,0x1fffff,0));
+}
+
+
+template<size_t rank>
+void test_tiling(agency::detail::default_shape_t<rank> shape, size_t tile_log2)
+{
+  using namespace agency;
+
+  experimental::detail::morton_tiling<rank> tiling(shape, tile_log2);
+
+  size_t n = detail::index_space_size(shape);
+
+  // each rank maps to a distinct point of the shape
+  std::vector<int> visited(n, 0);
+
+  for(size_t r = 0; r < n; ++r)
+  {
+    auto idx = tiling(r);
+
+    assert(detail::is_bounded_by(idx, shape));
+
+    visited[detail::index_lexicographical_rank(idx, shape)] += 1;
+  }
+
+  assert(std::count(visited.begin(), visited.end(), 1) == static_cast<std::ptrdiff_t>(n));
+}
+
+
+void test_tiles()
+{
+  using namespace agency;
+
+  // when the shape is covered by whole tiles, the first tile's worth of ranks covers the first tile in Morton order
+  experimental::detail::morton_tiling<2> tiling(size2{64,96}, 3);
+
+  for(size_t r = 0; r < 64; ++r)
+  {
+    assert(tiling(r) == detail::morton_decode<size2>(r));
+  }
+
+  // the next tile is adjacent along the last dimension
+  assert(tiling(64) == size2(0,8));
+}
+
+
+template<class ExecutionPolicy>
+void test_bulk_invoke(ExecutionPolicy policy)
+{
+  using namespace agency;
+
+  size_t m = 37, n = 50;
+
+  std::vector<int> visited(m * n, 0);
+
+  bulk_invoke(experimental::morton_order(policy({0,0}, {m,n}), 2), [&](typename ExecutionPolicy::execution_agent_type& self)
+  {
+    size_t i = self.index()[0];
+    size_t j = self.index()[1];
+
+    visited[i * n + j] += 1;
+  });
+
+  assert(std::count(visited.begin(), visited.end(), 1) == static_cast<std::ptrdiff_t>(m * n));
+}
+
+
+void test_bulk_invoke_3d()
+{
+  using namespace agency;
+
+  size3 shape{9,10,17};
+
+  // there is no three-dimensional policy, so make one
+  using agent_type = detail::basic_execution_agent<parallel_execution_tag, size3>;
+  using policy_type = basic_execution_policy<agent_type, parallel_executor, void>;
+
+  policy_type policy(agent_type::param_type(size3{0,0,0}, shape));
+
+  std::vector<int> visited(detail::index_space_size(shape), 0);
+
+  bulk_invoke(experimental::morton_order(policy), [&](agent_type& self)
+  {
+    visited[detail::index_lexicographical_rank(self.index(), shape)] += 1;
+  });
+
+  assert(std::count(visited.begin(), visited.end(), 1) == static_cast<std::ptrdiff_t>(visited.size()));
+}
+
+
+int main()
+{
+  test_morton_code();
+
+  test_tiling<2>({64,64}, 3);
+  test_tiling<2>({37,50}, 3);
+  test_tiling<2>({5,3}, 5);
+  test_tiling<2>({1,100}, 2);
+  test_tiling<3>({16,8,8}, 2);
+  test_tiling<3>({9,10,17}, 2);
+  test_tiling<3>({2,3,1}, 3);
+
+  test_tiles();
+
+  test_bulk_invoke(agency::seq2d);
+  test_bulk_invoke(agency::par2d);
+
+  test_bulk_invoke_3d();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include <cassert>
+
+#include <agency/execution/executor/numa_executor.hpp>
+#include <agency/execution/executor/flattened_executor.hpp>
+#include <agency/execution/executor/customization_points.hpp>
+
+
+void test_parse_cpu_list()
+{
+  using agency::detail::parse_cpu_list;
+
+  assert(parse_cpu_list("0") == std::vector<size_t>({0}));
+  assert(parse_cpu_list("0-3") == std::vector<size_t>({0,1,2,3}));
+  assert(parse_cpu_list("0-1,4,6-7\n") == std::vector<size_t>({0,1,4,6,7}));
+  assert(parse_cpu_list("").empty());
+}
+
+
+void test_numa_thread_pools()
+{
+  using namespace agency::detail;
+
+  auto nodes = numa_node_cpus();
+  const auto& pools = numa_thread_pools();
+
+  assert(!nodes.empty());
+  assert(pools.size() == nodes.size());
+
+  for(size_t node = 0; node < nodes.size(); ++node)
+  {
+    assert(pools[node]->size() == nodes[node].size());
+    assert(pools[node]->cpus() == nodes[node]);
+  }
+}
+
+
+void test_numa_executor()
+{
+  using namespace agency;
+
+  using executor_type = numa_executor;
+
+  static_assert(is_bulk_continuation_executor<executor_type>::value,
+    "numa_executor should be a bulk continuation executor");
+
+  static_assert(detail::is_detected_exact<scoped_execution_tag<concurrent_execution_tag,parallel_execution_tag>, executor_execution_category_t, executor_type>::value,
+    "numa_executor should have scoped_execution_tag<concurrent_execution_tag,parallel_execution_tag> execution_category");
+
+  static_assert(detail::is_detected_exact<detail::tuple<size_t,size_t>, executor_shape_t, executor_type>::value,
+    "numa_executor should have detail::tuple<size_t,size_t> shape_type");
+
+  executor_type exec;
+
+  assert(exec.num_nodes() == detail::numa_thread_pools().size());
+
+  using shape_type = executor_shape_t<executor_type>;
+  using index_type = executor_index_t<executor_type>;
+  using result_type = executor_container_t<executor_type, int>;
+
+  {
+    // bulk_then_execute() spreads outer indices across the nodes
+
+    size_t num_outer = 2 * exec.num_nodes() + 1;
+    shape_type shape(num_outer, 10);
+    auto predecessor_fut = make_ready_future<int>(exec, 7);
+
+    auto f = exec.bulk_then_execute(
+      [=](index_type idx, int& predecessor, result_type& results, std::vector<int>& outer_shared_arg, std::vector<int>& inner_shared_arg)
+      {
+        auto outer_idx = detail::get<0>(idx);
+        auto inner_idx = detail::get<1>(idx);
+        results[idx] = predecessor + outer_shared_arg[outer_idx] + inner_shared_arg[inner_idx];
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return result_type(shape); },                          // results
+      [=]{ return std::vector<int>(detail::get<0>(shape), 13); }, // outer_shared_arg
+      [=]{ return std::vector<int>(detail::get<1>(shape), 42); }  // inner_shared_arg
+    );
+
+    auto result = f.get();
+
+    assert(result_type(shape, 7 + 13 + 42) == result);
+  }
+
+  {
+    // a flattened numa_executor executes one-dimensional launches
+    flattened_executor<executor_type> flat_exec(exec);
+
+    size_t shape = 1000;
+
+    auto result = agency::bulk_sync_execute(flat_exec,
+      [](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx] + idx;
+      },
+      shape,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == int(13 + i));
+    }
+  }
+}
+
+
+int main()
+{
+  test_parse_cpu_list();
+  test_numa_thread_pools();
+  test_numa_executor();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
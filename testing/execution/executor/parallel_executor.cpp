@@ -1,6 +1,9 @@
 #include <iostream>
 #include <type_traits>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #include <agency/execution/executor/parallel_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
@@ -25,8 +28,11 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, parallel_executor>::value,
     "parallel_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, parallel_executor, int>::value,
-    "parallel_executor should have std::future future");
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, parallel_executor, int>::value,
+    "parallel_executor should have agency::future future");
+
+  static_assert(std::is_convertible<executor_future_t<parallel_executor,int>, std::future<int>>::value,
+    "parallel_executor's future should be convertible to std::future");
 
   static_assert(executor_execution_depth<parallel_executor>::value == 1,
     "parallel_executor should have execution_depth == 1");
@@ -52,6 +58,89 @@ int main()
   
   assert(std::vector<int>(10, 7 + 13) == result);
 
+  {
+    // load-balanced schedules
+    detail::thread_pool_schedule schedules[] = {detail::dynamic_schedule(), detail::dynamic_schedule(3), detail::guided_schedule(), detail::guided_schedule(3)};
+
+    for(auto schedule : schedules)
+    {
+      parallel_executor exec(schedule);
+
+      auto fut = agency::make_ready_future<int>(exec, 7);
+
+      size_t shape = 1001;
+
+      auto f = exec.bulk_then_execute(
+        [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+        {
+          results[idx] = past_arg + shared_arg[idx];
+        },
+        shape,
+        fut,
+        [=]{ return std::vector<int>(shape); },     // results
+        [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+      );
+
+      auto result = f.get();
+
+      assert(std::vector<int>(shape, 7 + 13) == result);
+    }
+  }
+
+  {
+    // a dynamic schedule's grain counts agents: each chunk of grain consecutive agents executes on a single thread
+    size_t grain = 16;
+    detail::thread_pool pool(4);
+    parallel_executor exec(pool, detail::dynamic_schedule(grain));
+
+    size_t shape = 1000;
+
+    auto result = agency::bulk_sync_execute(exec,
+      [](size_t idx, std::vector<std::thread::id>& results, detail::unit)
+      {
+        results[idx] = std::this_thread::get_id();
+      },
+      shape,
+      [=]{ return std::vector<std::thread::id>(shape); }, // results
+      []{ return detail::unit{}; }                        // shared_arg
+    );
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == result[i - i % grain]);
+    }
+
+    // agent grain begins the second chunk, so another thread executes it while agent 0 waits
+    // had the grain counted blocks of agents, agent grain would belong to agent 0's chunk
+    std::atomic<bool> second_chunk_began(false);
+    std::atomic<bool> first_chunk_saw_second_chunk(false);
+
+    agency::bulk_sync_execute(exec,
+      [&](size_t idx, detail::unit, detail::unit)
+      {
+        if(idx == grain)
+        {
+          second_chunk_began = true;
+        }
+        else if(idx == 0)
+        {
+          auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+          while(!second_chunk_began && std::chrono::steady_clock::now() < deadline)
+          {
+            std::this_thread::yield();
+          }
+
+          first_chunk_saw_second_chunk = second_chunk_began.load();
+        }
+      },
+      shape,
+      []{ return detail::unit{}; }, // results
+      []{ return detail::unit{}; }  // shared_arg
+    );
+
+    assert(first_chunk_saw_second_chunk);
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
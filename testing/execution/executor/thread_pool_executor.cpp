@@ -1,39 +1,28 @@
 #include <iostream>
 #include <type_traits>
 #include <vector>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 // XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
 #include <agency/execution/executor/parallel_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/customization_points.hpp>
 
-int main()
+
+void test(agency::detail::thread_pool_schedule schedule)
 {
   using namespace agency;
 
-  static_assert(is_bulk_continuation_executor<detail::thread_pool_executor>::value,
-    "thread_pool_executor should be a bulk continuation executor");
-
-  static_assert(is_bulk_executor<detail::thread_pool_executor>::value,
-    "thread_pool_executor should be a bulk executor");
-
-  static_assert(detail::is_detected_exact<parallel_execution_tag, executor_execution_category_t, detail::thread_pool_executor>::value,
-    "thread_pool_executor should have parallel_execution_tag execution_category");
-
-  static_assert(detail::is_detected_exact<size_t, executor_shape_t, detail::thread_pool_executor>::value,
-    "thread_pool_executor should have size_t shape_type");
-
-  static_assert(detail::is_detected_exact<size_t, executor_index_t, detail::thread_pool_executor>::value,
-    "thread_pool_executor should have size_t index_type");
-
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
-    "thread_pool_executor should have std::future future");
-
-  static_assert(executor_execution_depth<detail::thread_pool_executor>::value == 1,
-    "thread_pool_executor should have execution_depth == 1");
-
-  detail::thread_pool_executor exec;
-
+  detail::thread_pool_executor exec(schedule);
 
   {
     // bulk_sync_execute()
@@ -100,6 +89,345 @@ int main()
     assert(std::vector<int>(10, 13) == result);
   }
 
+
+  {
+    // bulk_sync_execute() with a shape which is not a multiple of the grain
+    size_t shape = 1001;
+
+    auto result = exec.bulk_sync_execute(
+      [](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx] + idx;
+      },
+      shape,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    std::vector<int> expected(shape);
+    for(size_t i = 0; i < shape; ++i)
+    {
+      expected[i] = 13 + i;
+    }
+
+    assert(expected == result);
+  }
+
+
+  {
+    // bulk_then_execute() with an empty shape
+    auto predecessor_fut = agency::make_ready_future<int>(exec, 7);
+
+    auto f = exec.bulk_then_execute(
+      [](size_t, int&, std::vector<int>&, detail::unit)
+      {
+        assert(false);
+      },
+      0,
+      predecessor_fut,
+      []{ return std::vector<int>(3, 13); },  // results
+      []{ return detail::unit{}; }            // shared_arg
+    );
+
+    assert(std::vector<int>(3, 13) == f.get());
+  }
+
+
+  {
+    // an exception thrown by a factory propagates to the result without launching any tasks
+    auto predecessor_fut = agency::make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [](size_t, std::vector<int>&, detail::unit)
+      {
+        assert(false);
+      },
+      10,
+      predecessor_fut,
+      []() -> std::vector<int> { throw std::runtime_error("result factory"); },  // results
+      []{ return detail::unit{}; }                                               // shared_arg
+    );
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+  }
+
+
+  {
+    // bulk_then_execute() with a pending predecessor occupies none of the pool's threads
+    detail::continuation_promise<int> promise;
+    auto predecessor_fut = promise.get_future();
+
+    size_t shape = 4 * detail::system_thread_pool().size();
+
+    auto f1 = exec.bulk_then_execute(
+      [](size_t idx, int& predecessor, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = predecessor + idx;
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    auto f2 = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& predecessor, std::vector<int>& results, detail::unit)
+      {
+        results[idx] = 2 * predecessor[idx];
+      },
+      shape,
+      f1,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    // if the launches above had blocked the pool's threads, this would never complete
+    agency::detail::latch marker(1);
+    detail::system_thread_pool().submit([&]
+    {
+      marker.count_down(1);
+    });
+    marker.wait();
+
+    promise.set_value(7);
+
+    auto result = f2.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == int(2 * (7 + i)));
+    }
+  }
+}
+
+
+void test_user_owned_pool()
+{
+  using namespace agency;
+
+  // find a cpu this process may run on
+  size_t cpu = 0;
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if(sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0)
+  {
+    while(cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &allowed)) ++cpu;
+  }
+#endif
+
+  // these outlive the pool, whose threads may still be using them when the test finishes
+  std::mutex mutex;
+  agency::detail::latch started(3);
+  agency::detail::latch release(1);
+
+  // a pool of three threads, all bound to the same cpu
+  detail::thread_pool pool(3, detail::thread_pool_mode::shared_queue, std::vector<size_t>{cpu});
+
+  assert(pool.size() == 3);
+  assert(pool.cpus() == std::vector<size_t>{cpu});
+
+  detail::thread_pool_executor exec(pool);
+
+  assert(&exec.pool() == &pool);
+  assert(exec.unit_shape() == 3);
+  assert(&detail::thread_pool_executor().pool() == &detail::system_thread_pool());
+
+  {
+    // bulk_sync_execute() executes on the pool's threads
+    size_t shape = 10;
+
+    auto result = exec.bulk_sync_execute(
+      [=](size_t idx, std::vector<int>& results, detail::unit)
+      {
+#if defined(__linux__)
+        results[idx] = sched_getcpu();
+#else
+        results[idx] = cpu;
+#endif
+      },
+      shape,
+      [=]{ return std::vector<int>(shape); },  // results
+      []{ return detail::unit{}; }             // shared_arg
+    );
+
+    assert(std::vector<int>(shape, int(cpu)) == result);
+  }
+
+  {
+    // bulk_then_execute() executes on the pool's threads
+
+    // occupy each of the pool's threads at once to learn their ids
+    std::set<std::thread::id> pool_thread_ids;
+    for(size_t i = 0; i < pool.size(); ++i)
+    {
+      pool.submit([&]
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          pool_thread_ids.insert(std::this_thread::get_id());
+        }
+
+        started.count_down(1);
+        release.wait();
+      });
+    }
+
+    started.wait();
+    release.count_down(1);
+
+    assert(pool_thread_ids.size() == pool.size());
+
+    size_t shape = 10;
+    auto predecessor_fut = agency::make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, std::vector<std::thread::id>& results, detail::unit)
+      {
+        results[idx] = std::this_thread::get_id();
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<std::thread::id>(shape); }, // results
+      []{ return detail::unit{}; }                        // shared_arg
+    );
+
+    for(auto id : f.get())
+    {
+      assert(pool_thread_ids.count(id) == 1);
+    }
+  }
+}
+
+
+void test_nested_launches(agency::detail::thread_pool_mode mode)
+{
+  using namespace agency;
+
+  // a single thread must execute both the outer & inner launches
+  detail::thread_pool pool(1, mode);
+  detail::thread_pool_executor exec(pool);
+
+  size_t outer_shape = 4;
+  size_t inner_shape = 10;
+
+  auto result = exec.bulk_sync_execute(
+    [=,&exec,&pool](size_t outer_idx, std::vector<int>& results, detail::unit)
+    {
+      assert(pool.is_worker_thread());
+
+      // the inner launch is enqueued rather than executed inline,
+      // and this worker executes it while it waits
+      auto inner_result = exec.bulk_sync_execute(
+        [=,&pool](size_t inner_idx, std::vector<int>& inner_results, detail::unit)
+        {
+          assert(pool.is_worker_thread());
+          inner_results[inner_idx] = outer_idx * inner_idx;
+        },
+        inner_shape,
+        [=]{ return std::vector<int>(inner_shape); }, // results
+        []{ return detail::unit{}; }                  // shared_arg
+      );
+
+      // a nested bulk_then_execute() launch may be waited on as well
+      auto predecessor_fut = agency::make_ready_future<void>(exec);
+      auto inner_fut = exec.bulk_then_execute(
+        [](size_t inner_idx, std::vector<int>& inner_results, detail::unit)
+        {
+          inner_results[inner_idx] += 1;
+        },
+        inner_shape,
+        predecessor_fut,
+        [&]{ return std::move(inner_result); },  // results
+        []{ return detail::unit{}; }             // shared_arg
+      );
+
+      inner_result = inner_fut.get();
+
+      // as may a nested async()
+      assert(pool.async([=]{ return outer_idx; }).get() == outer_idx);
+
+      int sum = 0;
+      for(int x : inner_result) sum += x;
+
+      results[outer_idx] = sum;
+    },
+    outer_shape,
+    [=]{ return std::vector<int>(outer_shape); }, // results
+    []{ return detail::unit{}; }                  // shared_arg
+  );
+
+  for(size_t i = 0; i < outer_shape; ++i)
+  {
+    assert(result[i] == int(i * inner_shape * (inner_shape - 1) / 2 + inner_shape));
+  }
+
+  assert(!pool.is_worker_thread());
+
+  {
+    // a worker which waits for a future fulfilled by another thread parks rather than spinning indefinitely
+    detail::continuation_promise<int> promise;
+    auto fut = promise.get_future().share();
+
+    auto waited = pool.async([=]{ return fut.get(); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    promise.set_value(7);
+
+    assert(waited.get() == 7);
+  }
+}
+
+
+int main()
+{
+  using namespace agency;
+
+  static_assert(is_bulk_continuation_executor<detail::thread_pool_executor>::value,
+    "thread_pool_executor should be a bulk continuation executor");
+
+  static_assert(is_bulk_executor<detail::thread_pool_executor>::value,
+    "thread_pool_executor should be a bulk executor");
+
+  static_assert(detail::is_detected_exact<parallel_execution_tag, executor_execution_category_t, detail::thread_pool_executor>::value,
+    "thread_pool_executor should have parallel_execution_tag execution_category");
+
+  static_assert(detail::is_detected_exact<size_t, executor_shape_t, detail::thread_pool_executor>::value,
+    "thread_pool_executor should have size_t shape_type");
+
+  static_assert(detail::is_detected_exact<size_t, executor_index_t, detail::thread_pool_executor>::value,
+    "thread_pool_executor should have size_t index_type");
+
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
+    "thread_pool_executor should have agency::future future");
+
+  static_assert(std::is_convertible<executor_future_t<detail::thread_pool_executor,int>, std::future<int>>::value,
+    "thread_pool_executor's future should be convertible to std::future");
+
+  static_assert(executor_execution_depth<detail::thread_pool_executor>::value == 1,
+    "thread_pool_executor should have execution_depth == 1");
+
+  test(detail::static_schedule());
+  test(detail::dynamic_schedule());
+  test(detail::dynamic_schedule(7));
+  test(detail::guided_schedule());
+  test(detail::guided_schedule(7));
+
+  test_user_owned_pool();
+
+  test_nested_launches(detail::thread_pool_mode::shared_queue);
+  test_nested_launches(detail::thread_pool_mode::work_stealing);
+
   std::cout << "OK" << std::endl;
 
   return 0;
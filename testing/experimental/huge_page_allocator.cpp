@@ -0,0 +1,102 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/memory/huge_page_allocator.hpp>
+#include <agency/experimental/vector.hpp>
+#include <agency/experimental/ndarray.hpp>
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+
+void test_allocate()
+{
+  using namespace agency::experimental;
+
+  huge_page_allocator<int> alloc;
+
+  {
+    // small allocations are not mapped
+    int* ptr = alloc.allocate(10);
+    assert(ptr != nullptr);
+    alloc.deallocate(ptr, 10);
+  }
+
+  {
+    // large allocations begin on a huge page boundary
+    size_t n = (size_t(3) << 20) / sizeof(int) + 7;
+
+    int* ptr = alloc.allocate(n);
+    assert(reinterpret_cast<std::uintptr_t>(ptr) % (size_t(2) << 20) == 0);
+
+    ptr[0] = 13;
+    ptr[n-1] = 7;
+    assert(ptr[0] == 13 && ptr[n-1] == 7);
+
+    alloc.deallocate(ptr, n);
+  }
+}
+
+
+void test_vector()
+{
+  using namespace agency::experimental;
+
+  using vector_type = vector<int, huge_page_allocator<int>>;
+
+  {
+    // small vectors are constructed sequentially
+    vector_type v(10, 13);
+    assert(std::count(v.begin(), v.end(), 13) == 10);
+  }
+
+  {
+    // large vectors are first touched in parallel
+    size_t n = size_t(1) << 22;
+    vector_type v(n, 13);
+    assert(static_cast<size_t>(std::count(v.begin(), v.end(), 13)) == n);
+
+    v[n-1] = 7;
+
+    vector_type copy = v;
+    assert(copy == v);
+
+    // value-initialized elements
+    vector_type zeros(n);
+    assert(static_cast<size_t>(std::count(zeros.begin(), zeros.end(), 0)) == n);
+  }
+
+  {
+    // with an explicit executor
+    agency::parallel_executor exec;
+    huge_page_allocator<int> alloc(exec);
+
+    size_t n = size_t(1) << 20;
+    vector_type v(n, 13, alloc);
+    assert(static_cast<size_t>(std::count(v.begin(), v.end(), 13)) == n);
+  }
+}
+
+
+void test_ndarray()
+{
+  using namespace agency::experimental;
+
+  size_t n = size_t(1) << 21;
+
+  basic_ndarray<float, size_t, huge_page_allocator<float>> array(n, 1.f);
+
+  assert(static_cast<size_t>(std::count(array.begin(), array.end(), 1.f)) == n);
+}
+
+
+int main()
+{
+  test_allocate();
+  test_vector();
+  test_ndarray();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -232,9 +232,198 @@ void test()
   }
 }
 
+// checks every position of flattened against expected_values,
+// reaching each position by incrementing, decrementing, and jumping from both ends
+template<class FlattenView>
+void test_traversal(const FlattenView& flattened, const std::vector<int>& expected_values)
+{
+  size_t n = expected_values.size();
+
+  assert(flattened.size() == n);
+  assert(static_cast<size_t>(flattened.end() - flattened.begin()) == n);
+
+  {
+    // test operator[]
+    for(size_t i = 0; i < n; ++i)
+    {
+      assert(flattened[i] == expected_values[i]);
+    }
+  }
+
+  {
+    // test increment
+    size_t i = 0;
+    for(auto iter = flattened.begin(); iter != flattened.end(); ++iter, ++i)
+    {
+      assert(*iter == expected_values[i]);
+    }
+
+    assert(i == n);
+  }
+
+  {
+    // test decrement
+    size_t i = n;
+    for(auto iter = flattened.end(); iter != flattened.begin();)
+    {
+      --iter;
+      --i;
+
+      assert(*iter == expected_values[i]);
+    }
+
+    assert(i == 0);
+  }
+
+  {
+    // test plus & minus between every pair of positions
+    for(size_t i = 0; i <= n; ++i)
+    {
+      auto from_begin = flattened.begin() + i;
+      auto from_end = flattened.end() - (n - i);
+
+      assert(from_begin == from_end);
+      assert(static_cast<size_t>(from_begin - flattened.begin()) == i);
+
+      for(size_t j = 0; j <= n; ++j)
+      {
+        auto iter = from_begin;
+
+        if(j >= i)
+        {
+          iter += j - i;
+        }
+        else
+        {
+          iter -= i - j;
+        }
+
+        assert(static_cast<size_t>(iter - flattened.begin()) == j);
+
+        if(j < n)
+        {
+          assert(*iter == expected_values[j]);
+        }
+      }
+    }
+  }
+
+  {
+    // test relational operators
+    auto first = flattened.begin();
+    auto last = flattened.end();
+
+    assert(first <= last);
+    assert(last >= first);
+    assert(n == 0 || first < last);
+    assert(n == 0 || last > first);
+    assert(!(first < first));
+  }
+}
+
+
+void test_segment_offsets()
+{
+  using namespace agency::experimental;
+
+  // segments of various sizes, including empty segments at either end and in the middle
+  std::vector<std::vector<int>> v;
+  v.emplace_back(std::vector<int>());
+  v.emplace_back(std::vector<int>(3));
+  v.emplace_back(std::vector<int>());
+  v.emplace_back(std::vector<int>());
+  v.emplace_back(std::vector<int>(1));
+  v.emplace_back(std::vector<int>(4));
+  v.emplace_back(std::vector<int>());
+
+  int init = 0;
+  for(auto& segment : v)
+  {
+    std::iota(segment.begin(), segment.end(), init);
+    init += segment.size();
+  }
+
+  std::vector<int> expected_values(init);
+  std::iota(expected_values.begin(), expected_values.end(), 0);
+
+  // the offset of each segment's first element
+  std::vector<size_t> segment_offsets(1, 0);
+  for(auto& segment : v)
+  {
+    segment_offsets.push_back(segment_offsets.back() + segment.size());
+  }
+
+  {
+    // test a flatten_view without a table of segment offsets
+    auto flattened = flatten(v);
+
+    assert(!flattened.has_segment_offsets());
+
+    test_traversal(flattened, expected_values);
+  }
+
+  {
+    // test a flatten_view with a table of segment offsets
+    auto flattened = flatten(v, segment_offsets);
+
+    assert(flattened.has_segment_offsets());
+
+    test_traversal(flattened, expected_values);
+  }
+
+  {
+    // test converting copy construction preserves the table of segment offsets
+    flatten_view<const std::vector<std::vector<int>>> flattened = flatten(v, segment_offsets);
+
+    assert(flattened.has_segment_offsets());
+
+    test_traversal(flattened, expected_values);
+  }
+
+  {
+    // test the segment cursor of an iterator
+    auto flattened = flatten(v, segment_offsets);
+
+    auto iter = flattened.begin();
+    assert(iter.segment_index() == 1);
+    assert(iter.segment_position() == 0);
+
+    iter += 3;
+    assert(iter.segment_index() == 4);
+    assert(iter.segment_position() == 0);
+
+    ++iter;
+    assert(iter.segment_index() == 5);
+    assert(iter.segment_position() == 0);
+
+    iter += 3;
+    assert(iter.segment_index() == 5);
+    assert(iter.segment_position() == 3);
+
+    ++iter;
+    assert(iter == flattened.end());
+    assert(iter.segment_index() == v.size());
+    assert(iter.segment_position() == 0);
+
+    --iter;
+    assert(iter.segment_index() == 5);
+    assert(iter.segment_position() == 3);
+  }
+
+  {
+    // test flatten_views of only empty segments
+    std::vector<std::vector<int>> empty(3);
+    std::vector<size_t> empty_offsets(4, 0);
+
+    test_traversal(flatten(empty), std::vector<int>());
+    test_traversal(flatten(empty, empty_offsets), std::vector<int>());
+  }
+}
+
 int main()
 {
   test();
+  test_segment_offsets();
 
   std::cout << "OK" << std::endl;
 
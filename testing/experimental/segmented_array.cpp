@@ -80,6 +80,30 @@ void test()
     assert(copy.size() == segment_size * allocators.size());
     assert(std::equal(copy.begin(), copy.end(), expected_values.begin()));
   }
+
+  {
+    // test random access
+
+    size_t segment_size = 5;
+
+    std::vector<allocator<int>> allocators(10);
+
+    size_t num_elements = segment_size * (allocators.size() - 1) + (segment_size - 1);
+
+    segmented_array<int> array(num_elements, 0, allocators);
+
+    for(size_t i = 0; i < num_elements; ++i)
+    {
+      array[i] = static_cast<int>(i);
+    }
+
+    for(size_t i = 0; i < num_elements; ++i)
+    {
+      assert(array[i] == static_cast<int>(i));
+      assert(*(array.begin() + i) == static_cast<int>(i));
+      assert(*(array.end() - (num_elements - i)) == static_cast<int>(i));
+    }
+  }
 }
 
 int main()
@@ -0,0 +1,335 @@
+#include <iostream>
+#include <cassert>
+#include <ratio>
+#include <string>
+#include <stdexcept>
+#include <agency/experimental/vector.hpp>
+#include <agency/experimental/memory/huge_page_allocator.hpp>
+
+
+// owns a heap allocated int, so it is not trivially copyable, but it may be relocated by memcpy
+struct owning_int
+{
+  static int& num_copies_and_moves()
+  {
+    static int result = 0;
+    return result;
+  }
+
+  int* ptr;
+
+  owning_int(int value) : ptr(new int(value)) {}
+
+  owning_int(const owning_int& other) : ptr(new int(*other.ptr))
+  {
+    ++num_copies_and_moves();
+  }
+
+  owning_int(owning_int&& other) : ptr(other.ptr)
+  {
+    other.ptr = nullptr;
+    ++num_copies_and_moves();
+  }
+
+  ~owning_int()
+  {
+    delete ptr;
+  }
+};
+
+namespace agency
+{
+namespace experimental
+{
+
+template<>
+struct is_trivially_relocatable<owning_int> : std::true_type {};
+
+} // end experimental
+} // end agency
+
+
+// counts live objects to check that relocated elements are destroyed exactly once
+struct counted
+{
+  static int& num_live()
+  {
+    static int result = 0;
+    return result;
+  }
+
+  int value;
+
+  counted(int v) : value(v) { ++num_live(); }
+  counted(const counted& other) : value(other.value) { ++num_live(); }
+  ~counted() { --num_live(); }
+};
+
+
+// a string whose move and copy constructors may throw
+// a constructor throws once the number of remaining moves or copies reaches zero
+struct throwing_string
+{
+  static int& moves_until_throw()
+  {
+    static int result = -1;
+    return result;
+  }
+
+  static int& copies_until_throw()
+  {
+    static int result = -1;
+    return result;
+  }
+
+  std::string value;
+
+  throwing_string(const char* v) : value(v) {}
+
+  throwing_string(const throwing_string& other) : value(other.value)
+  {
+    if(copies_until_throw() >= 0 && copies_until_throw()-- == 0)
+    {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  throwing_string(throwing_string&& other) : value(std::move(other.value))
+  {
+    if(moves_until_throw() >= 0 && moves_until_throw()-- == 0)
+    {
+      throw std::runtime_error("move");
+    }
+  }
+};
+
+
+// grows by a factor of 3/2
+template<class T>
+struct three_halves_allocator : agency::experimental::allocator<T>
+{
+  using growth_factor = std::ratio<3,2>;
+
+  template<class U>
+  struct rebind
+  {
+    using other = three_halves_allocator<U>;
+  };
+
+  three_halves_allocator() = default;
+
+  template<class U>
+  three_halves_allocator(const three_halves_allocator<U>&) {}
+};
+
+
+// allocates a large buffer up front and grows allocations within it
+template<class T>
+struct expanding_allocator : agency::experimental::allocator<T>
+{
+  static const size_t buffer_size = 1 << 16;
+
+  template<class U>
+  struct rebind
+  {
+    using other = expanding_allocator<U>;
+  };
+
+  expanding_allocator() = default;
+
+  template<class U>
+  expanding_allocator(const expanding_allocator<U>&) {}
+
+  T* allocate(size_t)
+  {
+    return agency::experimental::allocator<T>::allocate(buffer_size);
+  }
+
+  bool try_expand(T*, size_t, size_t new_n)
+  {
+    return new_n <= buffer_size;
+  }
+};
+
+
+void test_trivially_relocatable()
+{
+  using namespace agency::experimental;
+
+  vector<owning_int> v;
+
+  for(int i = 0; i < 1024; ++i)
+  {
+    v.emplace_back(i);
+  }
+
+  assert(v.size() == v.capacity());
+
+  // insert at the front of a full vector to relocate elements around the new one
+  v.emplace(v.begin(), -1);
+
+  assert(v.size() == 1025);
+  assert(*v[0].ptr == -1);
+
+  for(int i = 0; i < 1024; ++i)
+  {
+    assert(*v[i+1].ptr == i);
+  }
+
+  v.reserve(4096);
+  assert(*v.back().ptr == 1023);
+
+  // no element was copied or moved as the vector grew
+  assert(owning_int::num_copies_and_moves() == 0);
+}
+
+
+void test_non_relocatable()
+{
+  using namespace agency::experimental;
+
+  {
+    vector<counted> v;
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      v.push_back(counted(i));
+      assert(counted::num_live() == static_cast<int>(v.size()));
+    }
+
+    v.reserve(4000);
+    assert(counted::num_live() == 1000);
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      assert(v[i].value == i);
+    }
+  }
+
+  assert(counted::num_live() == 0);
+}
+
+
+void test_throwing_move()
+{
+  using namespace agency::experimental;
+
+  const char* strings[] = {"zero", "one", "two", "three", "four"};
+
+  vector<throwing_string> v(strings, strings + 5);
+
+  // the third move throws, so relocation must copy rather than move
+  throwing_string::moves_until_throw() = 2;
+
+  v.reserve(100);
+  assert(v.capacity() >= 100);
+
+  for(int i = 0; i < 5; ++i)
+  {
+    assert(v[i].value == strings[i]);
+  }
+
+  // the third copy throws, so reserve() fails and leaves the vector untouched
+  size_t old_capacity = v.capacity();
+  throwing_string::copies_until_throw() = 2;
+
+  try
+  {
+    v.reserve(200);
+    assert(false);
+  }
+  catch(std::runtime_error&)
+  {
+  }
+
+  assert(v.capacity() == old_capacity);
+  assert(v.size() == 5);
+
+  for(int i = 0; i < 5; ++i)
+  {
+    assert(v[i].value == strings[i]);
+  }
+
+  throwing_string::moves_until_throw() = -1;
+  throwing_string::copies_until_throw() = -1;
+}
+
+
+void test_growth_factor()
+{
+  using namespace agency::experimental;
+
+  vector<int, three_halves_allocator<int>> v(100, 13);
+  assert(v.capacity() == 100);
+
+  v.push_back(7);
+  assert(v.capacity() == 150);
+
+  vector<int> w(100, 13);
+  w.push_back(7);
+  assert(w.capacity() == 200);
+}
+
+
+void test_expand_in_place()
+{
+  using namespace agency::experimental;
+
+  vector<int, expanding_allocator<int>> v(1, 0);
+  int* data = v.data();
+
+  for(int i = 1; i < 10000; ++i)
+  {
+    v.push_back(i);
+  }
+
+  // the storage never moved
+  assert(v.data() == data);
+
+  for(int i = 0; i < 10000; ++i)
+  {
+    assert(v[i] == i);
+  }
+}
+
+
+void test_huge_page_allocator()
+{
+  using namespace agency::experimental;
+
+  // growth beyond a huge page may remap the storage in place
+  vector<int, huge_page_allocator<int>> v(size_t(1) << 20, 13);
+
+  v.reserve(size_t(1) << 22);
+  assert(v.capacity() >= size_t(1) << 22);
+  assert(v.size() == size_t(1) << 20);
+
+  for(size_t i = 0; i < size_t(1) << 20; ++i)
+  {
+    assert(v[i] == 13);
+  }
+
+  while(v.size() < (size_t(1) << 23))
+  {
+    v.push_back(7);
+  }
+
+  assert(v[0] == 13);
+  assert(v.back() == 7);
+}
+
+
+int main()
+{
+  test_trivially_relocatable();
+  test_non_relocatable();
+  test_throwing_move();
+  test_growth_factor();
+  test_expand_in_place();
+  test_huge_page_allocator();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
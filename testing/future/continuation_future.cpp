@@ -0,0 +1,385 @@
+#include <cassert>
+#include <agency/future/detail/continuation_future.hpp>
+#include <agency/future/future_traits.hpp>
+#include <agency/future.hpp>
+#include <stdexcept>
+#include <thread>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <cstdlib>
+#include <new>
+
+
+// counts calls to the global operator new
+std::atomic<int> num_allocations(0);
+
+void* operator new(std::size_t n)
+{
+  ++num_allocations;
+
+  void* result = std::malloc(n);
+  if(!result) throw std::bad_alloc();
+
+  return result;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+
+int main()
+{
+  using namespace agency;
+  using detail::continuation_future;
+  using detail::shared_continuation_future;
+  using detail::continuation_promise;
+
+  static_assert(agency::is_future<continuation_future<int>>::value, "continuation_future<int> is not a future");
+  static_assert(agency::is_future<shared_continuation_future<int>>::value, "shared_continuation_future<int> is not a future");
+
+  {
+    // make_ready int
+    continuation_future<int> f0 = continuation_future<int>::make_ready(13);
+    assert(f0.valid());
+    assert(f0.is_ready());
+    assert(f0.get() == 13);
+    assert(!f0.valid());
+  }
+
+  {
+    // make_ready void
+    continuation_future<void> f0 = continuation_future<void>::make_ready();
+    assert(f0.valid());
+    f0.get();
+    assert(!f0.valid());
+  }
+
+  {
+    // then int -> int on a ready future
+    auto f1 = continuation_future<int>::make_ready(7);
+
+    auto f2 = f1.then([](int& x)
+    {
+      return x + 13;
+    });
+
+    assert(!f1.valid());
+    assert(f2.is_ready());
+    assert(f2.get() == 7 + 13);
+  }
+
+  {
+    // then on a pending future is executed by the thread which fulfills the promise
+    continuation_promise<int> p;
+    auto f1 = p.get_future();
+
+    std::thread::id continuation_thread;
+
+    auto f2 = f1.then([&](int& x)
+    {
+      continuation_thread = std::this_thread::get_id();
+      return x + 13;
+    });
+
+    auto f3 = f2.then([](int& x)
+    {
+      // int -> void
+      assert(x == 7 + 13);
+    });
+
+    auto f4 = f3.then([]
+    {
+      // void -> int
+      return 42;
+    });
+
+    assert(!f4.is_ready());
+
+    std::thread::id fulfilling_thread;
+    std::thread t([&]
+    {
+      fulfilling_thread = std::this_thread::get_id();
+      p.set_value(7);
+    });
+
+    assert(f4.get() == 42);
+    t.join();
+
+    assert(continuation_thread == fulfilling_thread);
+  }
+
+  {
+    // exceptions propagate through then
+    continuation_promise<int> p;
+
+    auto f = p.get_future().then([](int& x)
+    {
+      return x;
+    });
+
+    p.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+  }
+
+  {
+    // a broken promise breaks its future
+    continuation_future<int> f;
+
+    {
+      continuation_promise<int> p;
+      f = p.get_future();
+    }
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::future_error& e)
+    {
+      caught_exception = (e.code() == std::future_errc::broken_promise);
+    }
+
+    assert(caught_exception);
+  }
+
+  {
+    // share & multiple continuations
+    continuation_promise<int> p;
+    shared_continuation_future<int> f1 = p.get_future().share();
+    shared_continuation_future<int> f2 = f1;
+
+    auto f3 = f1.then([](int& x) { return x + 1; });
+    auto f4 = f2.then([](int& x) { return x + 2; });
+
+    p.set_value(7);
+
+    assert(f3.get() == 8);
+    assert(f4.get() == 9);
+    assert(f1.get() == 7);
+    assert(f2.get() == 7);
+  }
+
+  {
+    // future_traits::then & detail::monadic_then
+    auto f1 = continuation_future<int>::make_ready(7);
+    auto f2 = future_traits<continuation_future<int>>::then(f1, [](int& x) { return x + 1; });
+    auto f3 = detail::monadic_then(f2, std::launch::async, [](int& x) { return x + 1; });
+
+    assert(f3.get() == 9);
+  }
+
+  {
+    // detail::then passes the ready future to the continuation
+    auto f1 = continuation_future<int>::make_ready(7);
+    auto f2 = detail::then(f1, [](continuation_future<int>& f)
+    {
+      return f.get() + 1;
+    });
+
+    assert(f2.get() == 8);
+  }
+
+  {
+    // cast
+    auto f1 = continuation_future<int>::make_ready(7);
+    auto f2 = future_traits<continuation_future<int>>::cast<unsigned int>(f1);
+
+    static_assert(std::is_same<decltype(f2), continuation_future<unsigned int>>::value, "cast should return continuation_future<unsigned int>");
+    assert(f2.get() == 7u);
+  }
+
+  {
+    // futures which are ready at creation allocate nothing, nor do their continuations
+    int num_allocations_before = num_allocations;
+
+    auto f1 = continuation_future<int>::make_ready(7);
+    auto f2 = f1.then([](int& x) { return x + 1; });
+    auto f3 = f2.then([](int&) {});
+    auto f4 = f3.then([] { return 13; });
+    auto f5 = detail::then(f4, [](continuation_future<int>& f) { return f.get() + 1; });
+
+    assert(f5.get() == 14);
+    assert(num_allocations == num_allocations_before);
+  }
+
+  {
+    // an exception thrown by a continuation of a ready future propagates
+    auto f = continuation_future<int>::make_ready(7).then([](int&) -> int
+    {
+      throw std::runtime_error("error");
+    });
+
+    assert(f.is_ready());
+
+    bool caught_exception = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+  }
+
+  {
+    // sharing a ready future moves its value into a state
+    auto f1 = continuation_future<int>::make_ready(7);
+    shared_continuation_future<int> f2 = f1.share();
+    shared_continuation_future<int> f3 = continuation_future<int>::make_ready(13);
+
+    assert(!f1.valid());
+    assert(f2.get() == 7);
+    assert(f3.get() == 13);
+  }
+
+  {
+    // the states of pending futures are recycled by the thread which releases them
+    for(int i = 0; i < 2; ++i)
+    {
+      continuation_promise<int> p;
+      auto f = p.get_future();
+      p.set_value(i);
+      assert(f.get() == i);
+    }
+
+    int num_allocations_before = num_allocations;
+
+    for(int i = 0; i < 100; ++i)
+    {
+      continuation_promise<int> p;
+      auto f = p.get_future();
+      p.set_value(i);
+      assert(f.get() == i);
+    }
+
+    assert(num_allocations == num_allocations_before);
+  }
+
+  {
+    // continuations execute in the order they were attached
+    continuation_promise<void> p;
+    shared_continuation_future<void> f = p.get_future().share();
+
+    int order[4] = {};
+    int num_executed = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+      f.on_ready([&,i] { order[num_executed++] = i; });
+    }
+
+    p.set_value();
+
+    assert(num_executed == 4);
+    for(int i = 0; i < 4; ++i)
+    {
+      assert(order[i] == i);
+    }
+  }
+
+  {
+    // sharing a pending future allocates nothing
+    continuation_promise<int> p;
+    continuation_future<int> f1 = p.get_future();
+
+    int num_allocations_before = num_allocations;
+
+    shared_continuation_future<int> f2 = f1.share();
+    shared_continuation_future<int> f3 = future_traits<shared_continuation_future<int>>::share(f2);
+
+    assert(num_allocations == num_allocations_before);
+
+    p.set_value(7);
+    assert(f3.get() == 7);
+  }
+
+  {
+    // many threads wait on and attach continuations to a future while another thread fulfills it
+    for(int trial = 0; trial < 100; ++trial)
+    {
+      continuation_promise<int> p;
+      shared_continuation_future<int> f = p.get_future().share();
+
+      std::atomic<int> sum(0);
+      std::thread threads[4];
+
+      for(auto& thread : threads)
+      {
+        thread = std::thread([&]
+        {
+          f.then([&](int& x) { sum += x; });
+          sum += f.get();
+        });
+      }
+
+      std::thread fulfiller([&] { p.set_value(1); });
+
+      for(auto& thread : threads)
+      {
+        thread.join();
+      }
+
+      fulfiller.join();
+
+      assert(sum == 8);
+    }
+  }
+
+  {
+    // a future converts to a std::future which becomes ready along with it
+    std::future<int> ready = continuation_future<int>::make_ready(7);
+    assert(ready.get() == 7);
+
+    continuation_promise<int> p1;
+    std::future<int> pending = p1.get_future();
+    assert(pending.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    p1.set_value(13);
+    assert(pending.get() == 13);
+
+    continuation_promise<void> p2;
+    std::future<void> exceptional = p2.get_future();
+    p2.set_exception(std::make_exception_ptr(std::runtime_error("exceptional")));
+
+    bool caught_exception = false;
+    try
+    {
+      exceptional.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught_exception = true;
+    }
+
+    assert(caught_exception);
+
+    std::future<int> invalid = continuation_future<int>();
+    assert(!invalid.valid());
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include <agency/agency.hpp>
+#include <agency/memory/allocator/detail/allocator_traits.hpp>
+#include <agency/memory/allocator/detail/bulk_construct_n.hpp>
+#include <agency/detail/iterator/constant_iterator.hpp>
+#include <agency/experimental/vector.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+
+// counts constructions & destructions
+struct counted
+{
+  static std::atomic<int>& num_live()
+  {
+    static std::atomic<int> result(0);
+    return result;
+  }
+
+  int value;
+
+  counted() noexcept : value(13) { ++num_live(); }
+  counted(int v) noexcept : value(v) { ++num_live(); }
+  counted(const counted& other) noexcept : value(other.value) { ++num_live(); }
+  ~counted() { --num_live(); }
+};
+
+
+void test_trivial_construct_n()
+{
+  using traits = agency::detail::allocator_traits<std::allocator<int>>;
+
+  std::allocator<int> alloc;
+
+  size_t n = 1000;
+  int* ptr = alloc.allocate(n);
+
+  // value-initialization zeroes the elements
+  std::fill(ptr, ptr + n, 7);
+  auto end = traits::construct_n(alloc, ptr, n);
+  assert(agency::detail::get<0>(end) == ptr + n);
+  assert(std::count(ptr, ptr + n, 0) == static_cast<int>(n));
+
+  // copying from another array of the same type copies its bytes
+  std::vector<int> source(n);
+  std::iota(source.begin(), source.end(), 0);
+
+  const int* const_source = source.data();
+  auto ends = traits::construct_n(alloc, ptr, n, const_source);
+  assert(agency::detail::get<0>(ends) == ptr + n);
+  assert(agency::detail::get<1>(ends) == const_source + n);
+  assert(std::equal(ptr, ptr + n, source.begin()));
+
+  traits::destroy_n(alloc, ptr, n);
+  alloc.deallocate(ptr, n);
+}
+
+
+struct S
+{
+  int x;
+};
+
+// a trivial type whose value-initialization is not all-zero bytes on every ABI
+struct member_pointer
+{
+  int S::* m;
+};
+
+
+void test_member_pointer_construct_n()
+{
+  using traits = agency::detail::allocator_traits<std::allocator<member_pointer>>;
+
+  std::allocator<member_pointer> alloc;
+
+  size_t n = 10;
+  member_pointer* ptr = alloc.allocate(n);
+
+  // value-initialization yields null pointers to members
+  std::fill(ptr, ptr + n, member_pointer{&S::x});
+  traits::construct_n(alloc, ptr, n);
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    assert(ptr[i].m == nullptr);
+  }
+
+  traits::destroy_n(alloc, ptr, n);
+  alloc.deallocate(ptr, n);
+
+  // a vector of such a type is value-initialized as well
+  agency::experimental::vector<member_pointer> v(n);
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    assert(v[i].m == nullptr);
+  }
+}
+
+
+void test_bulk_construct_n()
+{
+  std::allocator<counted> alloc;
+  agency::parallel_executor exec;
+
+  // large enough to be divided into several chunks
+  size_t n = size_t(1) << 20;
+  counted* ptr = alloc.allocate(n);
+
+  auto ends = agency::detail::bulk_construct_n(exec, alloc, ptr, n, agency::detail::constant_iterator<int>(7,0));
+  assert(agency::detail::get<0>(ends) == ptr + n);
+  assert(counted::num_live() == static_cast<int>(n));
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    assert(ptr[i].value == 7);
+  }
+
+  assert(agency::detail::bulk_destroy_n(exec, alloc, ptr, n) == ptr + n);
+  assert(counted::num_live() == 0);
+
+  // small ranges are constructed by the calling thread
+  agency::detail::bulk_construct_n(exec, alloc, ptr, 10);
+  assert(counted::num_live() == 10);
+  assert(ptr[9].value == 13);
+
+  agency::detail::bulk_destroy_n(exec, alloc, ptr, 10);
+  assert(counted::num_live() == 0);
+
+  alloc.deallocate(ptr, n);
+}
+
+
+void test_bulk_invoke_results()
+{
+  using namespace agency;
+
+  size_t n = size_t(1) << 22;
+
+  // the result container is constructed in parallel on par's executor
+  auto results = bulk_invoke(par(n), [](parallel_agent& self)
+  {
+    return static_cast<int>(self.index());
+  });
+
+  assert(results.size() == n);
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    assert(results[i] == static_cast<int>(i));
+  }
+}
+
+
+int main()
+{
+  test_trivial_construct_n();
+  test_member_pointer_construct_n();
+  test_bulk_construct_n();
+  test_bulk_invoke_results();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,206 @@
+#include <agency/memory/detail/resource/cached_resource.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+// counts the blocks it has allocated which have not yet been deallocated
+struct counting_resource
+{
+  static std::atomic<int>& num_live_blocks()
+  {
+    static std::atomic<int> result(0);
+    return result;
+  }
+
+  void* allocate(size_t num_bytes)
+  {
+    ++num_live_blocks();
+    return agency::detail::malloc_resource().allocate(num_bytes);
+  }
+
+  void deallocate(void* ptr, size_t num_bytes)
+  {
+    --num_live_blocks();
+    agency::detail::malloc_resource().deallocate(ptr, num_bytes);
+  }
+
+  bool operator==(const counting_resource&) const { return true; }
+  bool operator!=(const counting_resource&) const { return false; }
+  bool operator<(const counting_resource&) const { return false; }
+};
+
+
+void test_reuse()
+{
+  agency::detail::cached_resource<counting_resource> resource;
+
+  // a freed block is reused by the next allocation of the same size class
+  void* ptr1 = resource.allocate(100);
+  resource.deallocate(ptr1, 100);
+
+  void* ptr2 = resource.allocate(120);
+  assert(ptr1 == ptr2);
+  resource.deallocate(ptr2, 120);
+
+  // blocks of a different size class are not
+  void* ptr3 = resource.allocate(1000);
+  assert(ptr3 != ptr1);
+  resource.deallocate(ptr3, 1000);
+
+  assert(counting_resource::num_live_blocks() == 2);
+
+  resource.trim();
+
+  assert(counting_resource::num_live_blocks() == 0);
+}
+
+
+void test_high_water_mark()
+{
+  agency::detail::cached_resource<counting_resource> resource;
+
+  assert(resource.high_water_mark() > 0);
+
+  std::vector<void*> blocks;
+  for(int i = 0; i < 1000; ++i)
+  {
+    blocks.push_back(resource.allocate(64));
+  }
+
+  for(void* ptr : blocks)
+  {
+    resource.deallocate(ptr, 64);
+  }
+
+  // full magazines were flushed to the depot
+  assert(resource.cached_bytes() > 0);
+  assert(resource.cached_bytes() <= 1000 * 64);
+
+  // lowering the high water mark trims the depot
+  resource.set_high_water_mark(0);
+  assert(resource.cached_bytes() == 0);
+
+  // only the calling thread's magazine still holds blocks
+  assert(counting_resource::num_live_blocks() > 0);
+  assert(counting_resource::num_live_blocks() < 1000);
+
+  blocks.clear();
+  for(int i = 0; i < 1000; ++i)
+  {
+    blocks.push_back(resource.allocate(64));
+  }
+
+  for(void* ptr : blocks)
+  {
+    resource.deallocate(ptr, 64);
+  }
+
+  // the depot may no longer cache any blocks
+  assert(resource.cached_bytes() == 0);
+
+  resource.trim();
+
+  assert(counting_resource::num_live_blocks() == 0);
+}
+
+
+void test_large_allocations()
+{
+  agency::detail::cached_resource<counting_resource> resource;
+
+  // allocations too large to be cached go directly to the upstream resource
+  size_t num_bytes = (size_t(1) << 30) + 1;
+
+  void* ptr = resource.allocate(num_bytes);
+  assert(counting_resource::num_live_blocks() == 1);
+
+  resource.deallocate(ptr, num_bytes);
+  assert(counting_resource::num_live_blocks() == 0);
+}
+
+
+void test_concurrency()
+{
+  agency::detail::cached_resource<counting_resource> resource;
+
+  size_t num_threads = 8;
+  size_t num_blocks = 1000;
+
+  // each thread allocates blocks which the next thread deallocates
+  std::vector<std::vector<void*>> blocks(num_threads);
+
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&,i]
+    {
+      for(size_t j = 0; j < num_blocks; ++j)
+      {
+        size_t num_bytes = 1 + (j % 512);
+
+        void* ptr = resource.allocate(num_bytes);
+        *reinterpret_cast<char*>(ptr) = char(i);
+        blocks[i].push_back(ptr);
+      }
+    });
+  }
+
+  for(auto& t : threads) t.join();
+  threads.clear();
+
+  for(size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&,i]
+    {
+      const std::vector<void*>& victims = blocks[(i + 1) % num_threads];
+
+      for(size_t j = 0; j < victims.size(); ++j)
+      {
+        assert(*reinterpret_cast<char*>(victims[j]) == char((i + 1) % num_threads));
+        resource.deallocate(victims[j], 1 + (j % 512));
+      }
+    });
+  }
+
+  // exiting threads return their magazines to the depot
+  for(auto& t : threads) t.join();
+
+  resource.trim();
+
+  assert(counting_resource::num_live_blocks() == 0);
+}
+
+
+void test_globally_cached_resource()
+{
+  agency::detail::globally_cached_resource<counting_resource> resource;
+
+  void* ptr1 = resource.allocate(100);
+  resource.deallocate(ptr1, 100);
+
+  // another globally_cached_resource of an equal resource shares the cache
+  agency::detail::globally_cached_resource<counting_resource> other;
+
+  void* ptr2 = other.allocate(100);
+  assert(ptr1 == ptr2);
+  other.deallocate(ptr2, 100);
+}
+
+
+int main()
+{
+  test_reuse();
+  test_high_water_mark();
+  test_large_allocations();
+  test_concurrency();
+  test_globally_cached_resource();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
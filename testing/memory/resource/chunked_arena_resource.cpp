@@ -0,0 +1,143 @@
+#include <agency/agency.hpp>
+#include <agency/memory/detail/resource/chunked_arena_resource.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+
+
+// counts the blocks it has allocated which have not yet been deallocated
+struct counting_resource
+{
+  static int& num_live_blocks()
+  {
+    static int result = 0;
+    return result;
+  }
+
+  void* allocate(size_t num_bytes)
+  {
+    ++num_live_blocks();
+    return agency::detail::malloc_resource().allocate(num_bytes);
+  }
+
+  void deallocate(void* ptr, size_t num_bytes)
+  {
+    --num_live_blocks();
+    agency::detail::malloc_resource().deallocate(ptr, num_bytes);
+  }
+
+  bool operator==(const counting_resource&) const { return true; }
+  bool operator!=(const counting_resource&) const { return false; }
+};
+
+
+void test_growth()
+{
+  {
+    agency::detail::chunked_arena_resource<64, counting_resource> resource;
+
+    // allocations which fit inside the initial buffer do not touch the upstream resource
+    void* ptr1 = resource.allocate(32);
+    void* ptr2 = resource.allocate(32);
+    assert(reinterpret_cast<std::uintptr_t>(ptr1) % alignof(std::max_align_t) == 0);
+    assert(reinterpret_cast<std::uintptr_t>(ptr2) % alignof(std::max_align_t) == 0);
+    assert(resource.num_chunks() == 0);
+    assert(counting_resource::num_live_blocks() == 0);
+
+    // exhausting the initial buffer chains a chunk
+    void* ptr3 = resource.allocate(32);
+    assert(reinterpret_cast<std::uintptr_t>(ptr3) % alignof(std::max_align_t) == 0);
+    assert(resource.num_chunks() == 1);
+
+    // an allocation larger than the next chunk gets a chunk of its own
+    void* ptr4 = resource.allocate(10000);
+    assert(resource.num_chunks() == 2);
+
+    // the most recent allocation is reclaimed
+    resource.deallocate(ptr4, 10000);
+    void* ptr5 = resource.allocate(10000);
+    assert(ptr4 == ptr5);
+    assert(resource.num_chunks() == 2);
+
+    // release returns every chunk at once and starts over from the initial buffer
+    resource.release();
+    assert(resource.num_chunks() == 0);
+    assert(counting_resource::num_live_blocks() == 0);
+    assert(resource.allocate(32) == ptr1);
+
+    resource.allocate(1000);
+    assert(counting_resource::num_live_blocks() == 1);
+  }
+
+  // the destructor releases the remaining chunks
+  assert(counting_resource::num_live_blocks() == 0);
+}
+
+
+void test_shared_vector()
+{
+  using namespace agency;
+
+  size_t n = 16;
+
+  for(int launch = 0; launch < 3; ++launch)
+  {
+    // shared_vectors much larger than the group's initial buffer
+    bulk_invoke(con(n), [=](concurrent_agent& self)
+    {
+      shared_vector<int> small(self, size_t(4), 13);
+      shared_vector<int> large(self, size_t(4096), 7);
+
+      large[self.index()] = static_cast<int>(self.index());
+      self.wait();
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assert(large[i] == static_cast<int>(i));
+      }
+
+      assert(large[n] == 7);
+      assert(large[large.size() - 1] == 7);
+      assert(small[0] == 13);
+      self.wait();
+    });
+  }
+}
+
+
+void test_large_broadcast()
+{
+  using namespace agency;
+
+  using big_type = std::array<int, 64>;
+
+  bulk_invoke(con(8), [](concurrent_agent& self)
+  {
+    using namespace agency::experimental;
+
+    big_type value;
+    value.fill(13);
+
+    big_type result = self.broadcast(self.index() == 3 ? make_optional(value) : nullopt);
+
+    for(int x : result)
+    {
+      assert(x == 13);
+    }
+  });
+}
+
+
+int main()
+{
+  test_growth();
+  test_shared_vector();
+  test_large_broadcast();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,205 @@
+#include <agency/agency.hpp>
+#include <agency/memory/detail/resource/instrumented_resource.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/arena_resource.hpp>
+#include <agency/memory/detail/resource/tiered_resource.hpp>
+#include <agency/memory/detail/resource/chunked_arena_resource.hpp>
+#include <agency/memory/detail/resource/cached_resource.hpp>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+void test_counts()
+{
+  using namespace agency::detail;
+
+  resource_counters counters;
+  instrumented_resource<malloc_resource> resource(counters);
+
+  void* ptr1 = resource.allocate(1);
+  void* ptr2 = resource.allocate(100);
+  void* ptr3 = resource.allocate(100);
+
+  resource_statistics stats = resource.statistics();
+  assert(stats.num_allocations == 3);
+  assert(stats.num_deallocations == 0);
+  assert(stats.bytes_allocated == 201);
+  assert(stats.bytes_live() == 201);
+  assert(stats.peak_bytes_live == 201);
+
+  // 1 byte falls in bin 0, 100 bytes in bin 7, whose allocations are 65 through 128 bytes
+  assert(stats.size_histogram[0] == 1);
+  assert(stats.size_histogram[7] == 2);
+  assert(resource_statistics::size_bin_upper_bound(7) == 128);
+
+  resource.deallocate(ptr3, 100);
+  resource.deallocate(ptr2, 100);
+  resource.deallocate(ptr1, 1);
+
+  stats = resource.statistics();
+  assert(stats.num_deallocations == 3);
+  assert(stats.bytes_deallocated == 201);
+  assert(stats.bytes_live() == 0);
+  assert(stats.peak_bytes_live == 201);
+
+  // copies share their counters
+  instrumented_resource<malloc_resource> copy = resource;
+  copy.deallocate(copy.allocate(1 << 20), 1 << 20);
+
+  stats = resource.statistics();
+  assert(stats.num_allocations == 4);
+  assert(stats.peak_bytes_live == (1 << 20));
+}
+
+
+void test_threads()
+{
+  using namespace agency::detail;
+
+  resource_counters counters;
+
+  size_t num_threads = 4;
+  size_t num_allocations_per_thread = 1000;
+
+  std::vector<std::thread> threads;
+  for(size_t t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&]
+    {
+      instrumented_resource<malloc_resource> resource(counters);
+
+      for(size_t i = 0; i < num_allocations_per_thread; ++i)
+      {
+        resource.deallocate(resource.allocate(i), i);
+      }
+    });
+  }
+
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // the counters of threads which have exited are retained
+  resource_statistics stats = counters.snapshot();
+  assert(stats.num_allocations == num_threads * num_allocations_per_thread);
+  assert(stats.num_deallocations == num_threads * num_allocations_per_thread);
+  assert(stats.bytes_live() == 0);
+
+  std::uint64_t histogram_total = 0;
+  for(auto count : stats.size_histogram)
+  {
+    histogram_total += count;
+  }
+
+  assert(histogram_total == stats.num_allocations);
+}
+
+
+void test_tiered_resource_spills()
+{
+  using namespace agency::detail;
+
+  tiered_resource<instrumented_resource<arena_resource<256>>, malloc_resource> resource;
+
+  // the first allocation fits in the arena, the second spills to malloc
+  void* ptr1 = resource.allocate(200);
+  void* ptr2 = resource.allocate(200);
+
+  resource.deallocate(ptr2, 200);
+  resource.deallocate(ptr1, 200);
+
+  resource_statistics stats = instrumented_resource<arena_resource<256>>::global_statistics();
+  assert(stats.num_allocations == 1);
+  assert(stats.num_failed_allocations == 1);
+  assert(stats.num_deallocations == 1);
+}
+
+
+void test_arena_spills()
+{
+  using namespace agency::detail;
+
+  using upstream_resource_type = instrumented_resource<malloc_resource>;
+
+  {
+    chunked_arena_resource<64, upstream_resource_type> arena;
+
+    arena.allocate(32);
+    assert(upstream_resource_type::global_statistics().num_allocations == 0);
+
+    // the arena spills to its upstream resource when the initial buffer is exhausted
+    arena.allocate(64);
+    assert(upstream_resource_type::global_statistics().num_allocations == 1);
+  }
+
+  assert(upstream_resource_type::global_statistics().bytes_live() == 0);
+}
+
+
+void test_cache_retention()
+{
+  using namespace agency::detail;
+
+  resource_counters counters;
+  instrumented_resource<malloc_resource> upstream(counters);
+
+  cached_resource<instrumented_resource<malloc_resource>> cache(upstream);
+
+  void* ptr = cache.allocate(1000);
+  cache.deallocate(ptr, 1000);
+
+  // the block is retained by the cache
+  assert(counters.snapshot().bytes_live() == 1024);
+
+  cache.trim();
+  assert(counters.snapshot().bytes_live() == 0);
+}
+
+
+using instrumented_concurrent_resource = agency::detail::instrumented_resource<agency::default_concurrent_resource>;
+
+using instrumented_concurrent_agent = agency::detail::basic_concurrent_agent<size_t, instrumented_concurrent_resource>;
+
+using instrumented_concurrent_execution_policy = agency::basic_execution_policy<
+  instrumented_concurrent_agent,
+  agency::concurrent_executor
+>;
+
+
+void test_concurrent_agent()
+{
+  using namespace agency;
+
+  size_t n = 4;
+
+  bulk_invoke(instrumented_concurrent_execution_policy()(n), [](instrumented_concurrent_agent& self)
+  {
+    shared_vector<int, instrumented_concurrent_agent> vec(self, self.group_size(), 13);
+
+    assert(vec[self.index()] == 13);
+  });
+
+  detail::resource_statistics stats = instrumented_concurrent_resource::global_statistics();
+  assert(stats.num_allocations == 1);
+  assert(stats.num_deallocations == 1);
+  assert(stats.bytes_allocated == n * sizeof(int));
+}
+
+
+int main()
+{
+  test_counts();
+  test_threads();
+  test_tiered_resource_spills();
+  test_arena_spills();
+  test_cache_retention();
+  test_concurrent_agent();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,148 @@
+#include <agency/agency.hpp>
+#include <agency/detail/concurrency/barrier.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+template<class Barrier>
+void arrive_and_wait(Barrier& barrier, size_t)
+{
+  barrier.arrive_and_wait();
+}
+
+void arrive_and_wait(agency::detail::dissemination_barrier& barrier, size_t rank)
+{
+  barrier.arrive_and_wait(rank);
+}
+
+
+// returns the number of barrier phases per second completed by num_threads threads
+template<class Barrier>
+double phases_per_second(size_t num_threads, size_t num_phases)
+{
+  Barrier barrier(num_threads);
+
+  // each thread checks that every other thread has finished the previous phase
+  std::vector<std::atomic<size_t>> progress(num_threads);
+  for(auto& p : progress) p = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> threads;
+  for(size_t rank = 0; rank < num_threads; ++rank)
+  {
+    threads.emplace_back([&,rank]
+    {
+      for(size_t phase = 1; phase <= num_phases; ++phase)
+      {
+        progress[rank].store(phase, std::memory_order_relaxed);
+
+        arrive_and_wait(barrier, rank);
+
+        assert(progress[(rank + 1) % num_threads].load(std::memory_order_relaxed) >= phase);
+      }
+    });
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return num_phases / elapsed.count();
+}
+
+
+using dissemination_concurrent_agent = agency::detail::basic_concurrent_agent<
+  size_t,
+  agency::default_concurrent_resource,
+  agency::detail::dissemination_barrier
+>;
+
+using dissemination_concurrent_execution_policy = agency::basic_execution_policy<
+  dissemination_concurrent_agent,
+  agency::concurrent_executor
+>;
+
+
+int concurrent_sum(const std::vector<int>& data)
+{
+  using namespace agency;
+
+  return bulk_invoke(dissemination_concurrent_execution_policy()(data.size()), [&](dissemination_concurrent_agent& self) -> single_result<int>
+  {
+    shared_vector<int, dissemination_concurrent_agent> scratch(self, data);
+
+    auto i = self.index();
+    auto n = scratch.size();
+
+    while(n > 1)
+    {
+      if(i < n/2)
+      {
+        scratch[i] += scratch[n - i - 1];
+      }
+
+      self.wait();
+
+      n -= n/2;
+    }
+
+    if(i == 0)
+    {
+      return scratch[0];
+    }
+
+    return std::ignore;
+  });
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  // the dissemination barrier may be selected through the agent's type
+  for(int n : {1, 2, 3, 10, 64})
+  {
+    std::vector<int> data(n, 1);
+    assert(concurrent_sum(data) == n);
+  }
+
+  size_t num_phases = 2000;
+  size_t hw_concurrency = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "barrier phases per second:" << std::endl;
+  std::cout << "  threads  blocking       spinning       dissemination" << std::endl;
+
+  for(size_t num_threads = 2; num_threads <= 128; num_threads *= 2)
+  {
+    double blocking = phases_per_second<blocking_barrier>(num_threads, num_phases);
+    double dissemination = phases_per_second<dissemination_barrier>(num_threads, num_phases);
+
+    std::cout << "  " << num_threads << "\t   " << blocking << "\t  ";
+
+    // spinning_barrier never yields, so it cannot make progress in reasonable time when oversubscribed
+    if(num_threads <= hw_concurrency)
+    {
+      std::cout << phases_per_second<spinning_barrier>(num_threads, num_phases);
+    }
+    else
+    {
+      std::cout << "(skipped)";
+    }
+
+    std::cout << "\t " << dissemination << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,80 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/memory/huge_page_allocator.hpp>
+#include <agency/experimental/vector.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+// streams through x & y with a par(n) sweep
+// returns the sustained bandwidth in GB/s
+template<class Vector>
+double saxpy(size_t n, size_t num_trials)
+{
+  float a = 2.f;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // the vectors' pages are first touched as they are constructed
+  Vector x(n, 1.f);
+  Vector y(n, 2.f);
+
+  std::chrono::duration<double> construction = std::chrono::high_resolution_clock::now() - start;
+
+  float* x_ptr = x.data();
+  float* y_ptr = y.data();
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for(size_t trial = 0; trial < num_trials; ++trial)
+  {
+    agency::bulk_invoke(agency::par(n), [=](agency::parallel_agent& self)
+    {
+      size_t i = self.index();
+      y_ptr[i] = a * x_ptr[i] + y_ptr[i];
+    });
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  // each trial adds a * 1 to y
+  assert(y[0] == 2.f + num_trials * a);
+  assert(y[n-1] == 2.f + num_trials * a);
+
+  std::cout << "  construction: " << construction.count() << " s" << std::endl;
+
+  // each trial reads x & y and writes y
+  return 3. * sizeof(float) * n * num_trials / elapsed.count() / 1e9;
+}
+
+
+int main(int argc, char** argv)
+{
+  // the number of GiB to allocate for x & y together
+  // pass a larger number to stream through several GiB
+  double num_gib = 1;
+  if(argc > 1)
+  {
+    num_gib = std::atof(argv[1]);
+  }
+
+  size_t n = static_cast<size_t>(num_gib * (size_t(1) << 30) / (2 * sizeof(float)));
+  size_t num_trials = 5;
+
+  std::cout << "saxpy over " << n << " elements" << std::endl;
+
+  std::cout << "std::allocator:" << std::endl;
+  double baseline = saxpy<std::vector<float>>(n, num_trials);
+  std::cout << "  bandwidth: " << baseline << " GB/s" << std::endl;
+
+  std::cout << "huge_page_allocator:" << std::endl;
+  double huge_pages = saxpy<agency::experimental::vector<float, agency::experimental::huge_page_allocator<float>>>(n, num_trials);
+  std::cout << "  bandwidth: " << huge_pages << " GB/s" << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
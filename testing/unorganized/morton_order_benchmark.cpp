@@ -0,0 +1,137 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/ndarray.hpp>
+#include <agency/execution/executor/experimental/morton_executor.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+
+
+using grid = agency::experimental::ndarray<double,2>;
+
+
+// out = the average of each interior point of in & its four neighbors
+struct stencil
+{
+  grid& in;
+  grid& out;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    size_t i = self.index()[0];
+    size_t j = self.index()[1];
+
+    agency::size2 shape = in.shape();
+
+    if(0 < i && i + 1 < shape[0] && 0 < j && j + 1 < shape[1])
+    {
+      out[{i,j}] = 0.2 * (in[{i,j}] + in[{i-1,j}] + in[{i+1,j}] + in[{i,j-1}] + in[{i,j+1}]);
+    }
+    else
+    {
+      out[{i,j}] = in[{i,j}];
+    }
+  }
+};
+
+
+// out = the transpose of in
+// each agent moves one element, so the blocking of the transpose is the order in which the agents are created
+struct transpose
+{
+  grid& in;
+  grid& out;
+
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    size_t i = self.index()[0];
+    size_t j = self.index()[1];
+
+    out[{j,i}] = in[{i,j}];
+  }
+};
+
+
+template<class ExecutionPolicy, class Function>
+double time_invocations(ExecutionPolicy policy, size_t num_trials, Function f)
+{
+  // warm up
+  agency::bulk_invoke(policy, f);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(size_t i = 0; i < num_trials; ++i)
+  {
+    agency::bulk_invoke(policy, f);
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_trials;
+}
+
+
+void fill(grid& a)
+{
+  size_t n = a.size();
+  for(size_t i = 0; i < n; ++i)
+  {
+    a.data()[i] = static_cast<double>((i * 7919) % 1000);
+  }
+}
+
+
+bool equal(const grid& a, const grid& b)
+{
+  return std::equal(a.data(), a.data() + a.size(), b.data());
+}
+
+
+// compares the throughput of agents created in lexicographic order by par2d with agents created in Morton order by morton_order(par2d)
+// and reports them in millions of points per second
+int main(int argc, char** argv)
+{
+  // the length of the sides of the grid
+  // pass a larger number (e.g. 8192) to exceed the size of the last level cache
+  size_t n = 2048;
+  if(argc > 1)
+  {
+    n = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  size_t num_trials = 10;
+
+  agency::size2 shape{n,n};
+
+  auto lexicographic = agency::par2d(agency::size2{0,0}, shape);
+  auto morton = agency::experimental::morton_order(lexicographic);
+
+  grid in(shape), lexicographic_out(shape), morton_out(shape);
+  fill(in);
+
+  double lexicographic_stencil = time_invocations(lexicographic, num_trials, stencil{in, lexicographic_out});
+  double morton_stencil        = time_invocations(morton, num_trials, stencil{in, morton_out});
+  assert(equal(lexicographic_out, morton_out));
+
+  double lexicographic_transpose = time_invocations(lexicographic, num_trials, transpose{in, lexicographic_out});
+  double morton_transpose        = time_invocations(morton, num_trials, transpose{in, morton_out});
+  assert(equal(lexicographic_out, morton_out));
+
+  double points = static_cast<double>(n * n);
+
+  std::cout << n << " x " << n << " 5-point stencil:" << std::endl;
+  std::cout << "  lexicographic: " << points / lexicographic_stencil / 1e6 << " Mpoints/s" << std::endl;
+  std::cout << "  morton:        " << points / morton_stencil / 1e6 << " Mpoints/s" << std::endl;
+
+  std::cout << n << " x " << n << " transpose:" << std::endl;
+  std::cout << "  lexicographic: " << points / lexicographic_transpose / 1e6 << " Mpoints/s" << std::endl;
+  std::cout << "  morton:        " << points / morton_transpose / 1e6 << " Mpoints/s" << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,92 @@
+#include <agency/agency.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+template<class Function>
+double time_invocation(size_t num_trials, Function f)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(size_t trial = 0; trial < num_trials; ++trial)
+  {
+    f();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_trials;
+}
+
+
+// compares agency::reduce() & agency::inclusive_scan() with their serial counterparts in the standard library
+// and reports their throughputs in billions of elements per second
+void benchmark(size_t n)
+{
+  size_t num_trials = std::max<size_t>(1, (size_t(1) << 26) / n);
+
+  std::vector<long long> x(n);
+  std::iota(x.begin(), x.end(), 0);
+
+  std::vector<long long> y(n);
+
+  long long expected_sum = 0;
+  double std_reduce = time_invocation(num_trials, [&]
+  {
+    expected_sum = std::accumulate(x.begin(), x.end(), 0ll);
+  });
+
+  long long sum = 0;
+  double agency_reduce = time_invocation(num_trials, [&]
+  {
+    sum = agency::reduce(agency::par, x.begin(), x.end(), 0ll);
+  });
+
+  assert(sum == expected_sum);
+
+  double std_scan = time_invocation(num_trials, [&]
+  {
+    std::partial_sum(x.begin(), x.end(), y.begin());
+  });
+
+  std::vector<long long> expected_scan = y;
+
+  double agency_scan = time_invocation(num_trials, [&]
+  {
+    agency::inclusive_scan(agency::par, x.begin(), x.end(), y.begin());
+  });
+
+  assert(y == expected_scan);
+
+  std::cout << n << " elements:" << std::endl;
+  std::cout << "  std::accumulate:        " << n / std_reduce / 1e9 << " Gelements/s" << std::endl;
+  std::cout << "  agency::reduce:         " << n / agency_reduce / 1e9 << " Gelements/s" << std::endl;
+  std::cout << "  std::partial_sum:       " << n / std_scan / 1e9 << " Gelements/s" << std::endl;
+  std::cout << "  agency::inclusive_scan: " << n / agency_scan / 1e9 << " Gelements/s" << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+  // the largest number of elements to benchmark
+  // pass a larger number (e.g. 1073741824) to sweep up to 1G elements
+  size_t max_n = size_t(1) << 24;
+  if(argc > 1)
+  {
+    max_n = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  for(size_t n = 1 << 10; n <= max_n; n *= 8)
+  {
+    benchmark(n);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
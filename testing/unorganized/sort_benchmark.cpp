@@ -0,0 +1,103 @@
+#include <agency/agency.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+struct record
+{
+  unsigned long long key;
+  double payload[3];
+};
+
+struct compare_keys
+{
+  bool operator()(const record& a, const record& b) const
+  {
+    return a.key < b.key;
+  }
+};
+
+
+template<class T, class Generator, class Sort>
+double time_sort(size_t n, Generator generate, Sort sort)
+{
+  std::vector<T> data(n);
+  std::generate(data.begin(), data.end(), generate);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  sort(data);
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count();
+}
+
+
+// compares agency::sort() & agency::stable_sort() with their serial counterparts in the standard library
+// and reports their throughputs in millions of elements per second
+template<class T, class Generator, class Compare>
+void benchmark(const char* name, size_t n, Generator generate, Compare comp)
+{
+  double std_sort = time_sort<T>(n, generate, [&](std::vector<T>& data)
+  {
+    std::sort(data.begin(), data.end(), comp);
+    assert(std::is_sorted(data.begin(), data.end(), comp));
+  });
+
+  double agency_sort = time_sort<T>(n, generate, [&](std::vector<T>& data)
+  {
+    agency::sort(agency::par, data.begin(), data.end(), comp);
+    assert(std::is_sorted(data.begin(), data.end(), comp));
+  });
+
+  double std_stable_sort = time_sort<T>(n, generate, [&](std::vector<T>& data)
+  {
+    std::stable_sort(data.begin(), data.end(), comp);
+    assert(std::is_sorted(data.begin(), data.end(), comp));
+  });
+
+  double agency_stable_sort = time_sort<T>(n, generate, [&](std::vector<T>& data)
+  {
+    agency::stable_sort(agency::par, data.begin(), data.end(), comp);
+    assert(std::is_sorted(data.begin(), data.end(), comp));
+  });
+
+  std::cout << n << " " << name << ":" << std::endl;
+  std::cout << "  std::sort:           " << n / std_sort / 1e6 << " Melements/s" << std::endl;
+  std::cout << "  agency::sort:        " << n / agency_sort / 1e6 << " Melements/s" << std::endl;
+  std::cout << "  std::stable_sort:    " << n / std_stable_sort / 1e6 << " Melements/s" << std::endl;
+  std::cout << "  agency::stable_sort: " << n / agency_stable_sort / 1e6 << " Melements/s" << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+  // the number of elements to sort
+  // pass a larger number (e.g. 50000000) to sort batches of the size found in practice
+  size_t n = size_t(1) << 22;
+  if(argc > 1)
+  {
+    n = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  std::default_random_engine rng;
+
+  // ints & doubles are radix sorted
+  benchmark<int>("ints", n, [&]{ return static_cast<int>(rng()); }, std::less<int>());
+
+  std::uniform_real_distribution<double> dist(-1, 1);
+  benchmark<double>("doubles", n, [&]{ return dist(rng); }, std::less<double>());
+
+  // records are merge sorted
+  benchmark<record>("records", n, [&]{ return record{rng(), {0, 1, 2}}; }, compare_keys());
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
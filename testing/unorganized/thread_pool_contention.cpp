@@ -0,0 +1,127 @@
+// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/detail/concurrency/latch.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <iostream>
+
+
+// many threads outside of the pool submit tiny tasks at once
+double external_submission(agency::detail::thread_pool_mode mode, size_t num_submitters, size_t tasks_per_submitter)
+{
+  agency::detail::thread_pool pool(std::max(1u, std::thread::hardware_concurrency()), mode);
+
+  std::atomic<size_t> counter(0);
+  agency::detail::latch work_remaining(num_submitters * tasks_per_submitter);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> submitters;
+  for(size_t i = 0; i < num_submitters; ++i)
+  {
+    submitters.emplace_back([&]
+    {
+      for(size_t j = 0; j < tasks_per_submitter; ++j)
+      {
+        pool.submit([&]
+        {
+          counter.fetch_add(1, std::memory_order_relaxed);
+          work_remaining.count_down(1);
+        });
+      }
+    });
+  }
+
+  for(auto& t : submitters)
+  {
+    t.join();
+  }
+
+  work_remaining.wait();
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  assert(counter == num_submitters * tasks_per_submitter);
+
+  return elapsed.count();
+}
+
+
+template<class Latch>
+void fan_out(agency::detail::thread_pool& pool, size_t depth, std::atomic<size_t>& counter, Latch& leaves_remaining)
+{
+  if(depth == 0)
+  {
+    counter.fetch_add(1, std::memory_order_relaxed);
+    leaves_remaining.count_down(1);
+  }
+  else
+  {
+    for(int child = 0; child < 2; ++child)
+    {
+      pool.submit([&pool, depth, &counter, &leaves_remaining]
+      {
+        fan_out(pool, depth - 1, counter, leaves_remaining);
+      });
+    }
+  }
+}
+
+
+// tasks executing inside the pool recursively submit more tasks
+double nested_submission(agency::detail::thread_pool_mode mode, size_t depth)
+{
+  agency::detail::thread_pool pool(std::max(1u, std::thread::hardware_concurrency()), mode);
+
+  size_t num_leaves = size_t(1) << depth;
+
+  std::atomic<size_t> counter(0);
+  agency::detail::latch leaves_remaining(num_leaves);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  pool.submit([&]
+  {
+    fan_out(pool, depth, counter, leaves_remaining);
+  });
+
+  leaves_remaining.wait();
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  assert(counter == num_leaves);
+
+  return elapsed.count();
+}
+
+
+int main()
+{
+  using agency::detail::thread_pool_mode;
+
+  size_t num_submitters = 4;
+  size_t tasks_per_submitter = 1 << 16;
+  size_t depth = 16;
+
+  double shared_external   = external_submission(thread_pool_mode::shared_queue,  num_submitters, tasks_per_submitter);
+  double stealing_external = external_submission(thread_pool_mode::work_stealing, num_submitters, tasks_per_submitter);
+
+  std::cout << "external submission, " << num_submitters << " submitters x " << tasks_per_submitter << " tasks:" << std::endl;
+  std::cout << "  shared_queue:  " << shared_external   << " s" << std::endl;
+  std::cout << "  work_stealing: " << stealing_external << " s" << std::endl;
+
+  double shared_nested   = nested_submission(thread_pool_mode::shared_queue,  depth);
+  double stealing_nested = nested_submission(thread_pool_mode::work_stealing, depth);
+
+  std::cout << "nested submission, binary tree of depth " << depth << ":" << std::endl;
+  std::cout << "  shared_queue:  " << shared_nested   << " s" << std::endl;
+  std::cout << "  work_stealing: " << stealing_nested << " s" << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
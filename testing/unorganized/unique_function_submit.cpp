@@ -0,0 +1,125 @@
+// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/detail/concurrency/latch.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <cassert>
+#include <iostream>
+
+
+// captures an index and a couple of references, like a typical bulk task
+struct small_task
+{
+  size_t idx;
+  std::atomic<size_t>* counter;
+  agency::detail::latch* work_remaining;
+
+  void operator()() const
+  {
+    counter->fetch_add(idx, std::memory_order_relaxed);
+    work_remaining->count_down(1);
+  }
+};
+
+
+// captures more state than fits in unique_function's inline buffer
+struct large_task : small_task
+{
+  char payload[128];
+
+  large_task(const small_task& t)
+    : small_task(t)
+  {
+    payload[0] = 0;
+  }
+};
+
+
+// constructs, moves, invokes & destroys n unique_functions
+// this is the life cycle of a task which passes through a thread_pool's queue
+template<class UniqueFunction, class Task, class... Alloc>
+double function_life_cycle(size_t n, Alloc... alloc)
+{
+  std::atomic<size_t> counter(0);
+  agency::detail::latch work_remaining(n);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    UniqueFunction f(alloc..., Task(small_task{i, &counter, &work_remaining}));
+    UniqueFunction g = std::move(f);
+    g();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  assert(counter == n * (n - 1) / 2);
+
+  return elapsed.count();
+}
+
+
+// submits n tasks to a thread_pool and waits for them to execute
+template<class Task>
+double submit_and_execute(size_t n)
+{
+  agency::detail::thread_pool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+  std::atomic<size_t> counter(0);
+  agency::detail::latch work_remaining(n);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    pool.submit(Task(small_task{i, &counter, &work_remaining}));
+  }
+
+  work_remaining.wait();
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  assert(counter == n * (n - 1) / 2);
+
+  return elapsed.count();
+}
+
+
+int main()
+{
+  using agency::detail::unique_function;
+
+  size_t n = 1 << 20;
+
+  // the previous implementation of unique_function allocated every callable with the system allocator
+  // we measure it with an inline buffer of zero bytes and std::allocator
+  std::allocator_arg_t a = std::allocator_arg;
+  std::allocator<small_task> system_alloc;
+
+  double small_heap   = function_life_cycle<unique_function<void(), 0>, small_task>(n, a, system_alloc);
+  double small_inline = function_life_cycle<unique_function<void()>, small_task>(n);
+  double large_heap   = function_life_cycle<unique_function<void(), 0>, large_task>(n, a, system_alloc);
+  double large_pooled = function_life_cycle<unique_function<void()>, large_task>(n);
+
+  std::cout << "construct, move, invoke & destroy " << n << " unique_functions:" << std::endl;
+  std::cout << "  small capture, system allocator: " << small_heap   << " s" << std::endl;
+  std::cout << "  small capture, inline:           " << small_inline << " s" << std::endl;
+  std::cout << "  large capture, system allocator: " << large_heap   << " s" << std::endl;
+  std::cout << "  large capture, pooled:           " << large_pooled << " s" << std::endl;
+
+  double small_submit = submit_and_execute<small_task>(n);
+  double large_submit = submit_and_execute<large_task>(n);
+
+  std::cout << "thread_pool submit & execute " << n << " tasks:" << std::endl;
+  std::cout << "  small capture: " << small_submit << " s (" << n / small_submit << " tasks/s)" << std::endl;
+  std::cout << "  large capture: " << large_submit << " s (" << n / large_submit << " tasks/s)" << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+